@@ -0,0 +1,407 @@
+#include "BenchCommon.h"
+
+#ifndef _WIN32
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <new>
+
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#endif
+
+namespace bench {
+
+#ifdef _WIN32
+
+int RunBatch(const Args&) {
+    std::fprintf(stderr, "batch mode needs fork() and is only available on POSIX systems\n");
+    return 2;
+}
+
+#else
+
+namespace {
+
+// Shared with the workers through one anonymous MAP_SHARED mapping created before
+// fork: a header with the work-queue cursor, then one result slot per frame, then
+// maxPoints points per frame. Workers claim `chunk` frames at a time and only write
+// the slots of frames they claimed, so the store is ordered by frame index.
+struct BatchHeader {
+    std::atomic<int64_t> nextFrame;
+    int64_t frameCount;
+    int32_t chunk;
+    int32_t maxPoints;
+};
+
+struct BatchSlot {
+    int32_t done;       // set last; the parent reads slots after the workers exit
+    int32_t status;
+    int32_t total;
+    int32_t written;
+    int32_t worker;
+    int32_t width;
+    int32_t height;
+    int32_t reserved0;
+    uint64_t latencyNs;
+};
+
+static_assert(std::atomic<int64_t>::is_always_lock_free, "the queue cursor must be address-free across processes");
+
+class SharedStore {
+public:
+    SharedStore(int64_t frameCount, int32_t chunk, int32_t maxPoints) {
+        bytes_ = sizeof(BatchHeader)
+            + static_cast<size_t>(frameCount) * sizeof(BatchSlot)
+            + static_cast<size_t>(frameCount) * static_cast<size_t>(maxPoints) * sizeof(ChromaPoint);
+        void* base = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) {
+            base_ = nullptr;
+            return;
+        }
+        base_ = static_cast<uint8_t*>(base);
+        header_ = new (base_) BatchHeader{};
+        header_->nextFrame.store(0);
+        header_->frameCount = frameCount;
+        header_->chunk = chunk;
+        header_->maxPoints = maxPoints;
+        slots_ = reinterpret_cast<BatchSlot*>(base_ + sizeof(BatchHeader));
+        points_ = reinterpret_cast<ChromaPoint*>(base_ + sizeof(BatchHeader) + static_cast<size_t>(frameCount) * sizeof(BatchSlot));
+    }
+
+    ~SharedStore() {
+        if (base_ != nullptr) {
+            munmap(base_, bytes_);
+        }
+    }
+
+    SharedStore(const SharedStore&) = delete;
+    SharedStore& operator=(const SharedStore&) = delete;
+
+    bool Ok() const { return base_ != nullptr; }
+    size_t Bytes() const { return bytes_; }
+    BatchHeader& Header() { return *header_; }
+    BatchSlot& Slot(int64_t frame) { return slots_[frame]; }
+    ChromaPoint* Points(int64_t frame) { return points_ + frame * header_->maxPoints; }
+
+private:
+    size_t bytes_ = 0;
+    uint8_t* base_ = nullptr;
+    BatchHeader* header_ = nullptr;
+    BatchSlot* slots_ = nullptr;
+    ChromaPoint* points_ = nullptr;
+};
+
+// Frame i: synthetic frames first (720p/1080p alternating, as in the corpus mode),
+// then the recorded PPM files in name order. Frames are produced by index in the
+// process that detects them, so no pixels cross the shared mapping.
+struct FrameSource {
+    int synthetic = 0;
+    int targets = 12;
+    int clutter = 40;
+    std::vector<std::filesystem::path> recorded;
+
+    int64_t Count() const {
+        return static_cast<int64_t>(synthetic) + static_cast<int64_t>(recorded.size());
+    }
+
+    bool Load(int64_t index, Frame& out) const {
+        if (index < synthetic) {
+            const bool large = (index % 2) != 0;
+            out = MakeSyntheticFrame(large ? 1920 : 1280, large ? 1080 : 720, targets, clutter, static_cast<uint32_t>(7919 * (index + 1)));
+            return true;
+        }
+        return LoadPpm(recorded[static_cast<size_t>(index - synthetic)], out);
+    }
+};
+
+// CPUs of each socket (physical package), from sysfs; one group with every CPU this
+// process may run on when the topology is unavailable.
+std::vector<std::vector<int>> CpusPerSocket() {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return {};
+    }
+    std::map<int, std::vector<int>> sockets;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &allowed)) {
+            continue;
+        }
+        int package = 0;
+        std::ifstream in("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/physical_package_id");
+        if (!(in >> package)) {
+            package = 0;
+        }
+        sockets[package].push_back(cpu);
+    }
+    std::vector<std::vector<int>> out;
+    for (auto& entry : sockets) {
+        out.push_back(std::move(entry.second));
+    }
+    return out;
+}
+
+bool PinToCpus(const std::vector<int>& cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const int cpu : cpus) {
+        CPU_SET(cpu, &set);
+    }
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+// Worker process body: a non-adaptive stream (its own workspace, warmed by the first
+// frame) locates every claimed frame with the active config inherited from the parent.
+int RunWorker(int worker, const FrameSource& source, SharedStore& store) {
+    wchar_t error[256] = {};
+    ChromaStream* stream = nullptr;
+    int32_t status = Chroma_CreateStream(&stream, 0, error, 256);
+    if (status != CHROMA_STATUS_OK) {
+        PrintError("Chroma_CreateStream", status, error);
+        return 1;
+    }
+
+    BatchHeader& header = store.Header();
+    const int64_t count = header.frameCount;
+    int exitCode = 0;
+    Frame frame;
+    for (;;) {
+        const int64_t begin = header.nextFrame.fetch_add(header.chunk);
+        if (begin >= count) {
+            break;
+        }
+        const int64_t end = std::min(count, begin + header.chunk);
+        for (int64_t i = begin; i < end; ++i) {
+            BatchSlot& slot = store.Slot(i);
+            slot.worker = worker;
+            if (!source.Load(i, frame)) {
+                std::fprintf(stderr, "worker %d: cannot load frame %lld\n", worker, static_cast<long long>(i));
+                slot.status = CHROMA_STATUS_INVALID_ARGUMENT;
+                slot.done = 1;
+                exitCode = 1;
+                continue;
+            }
+            const Clock::time_point t0 = Clock::now();
+            status = Chroma_LocateStreamBGRAW(stream, frame.bgra.data(), frame.width, frame.height, frame.Stride(),
+                store.Points(i), header.maxPoints, &slot.total, &slot.written, error, 256);
+            slot.latencyNs = NanosSince(t0);
+            slot.status = status;
+            slot.width = frame.width;
+            slot.height = frame.height;
+            if (status != CHROMA_STATUS_OK && status != CHROMA_STATUS_BUFFER_TOO_SMALL) {
+                PrintError("Chroma_LocateStreamBGRAW", status, error);
+                exitCode = 1;
+            }
+            slot.done = 1;
+        }
+    }
+    Chroma_DestroyStream(stream);
+    return exitCode;
+}
+
+}
+
+int RunBatch(const Args& args) {
+    const std::vector<std::vector<int>> topology = CpusPerSocket();
+    const int workers = std::max(1, args.GetInt("--workers", static_cast<int>(std::max<size_t>(1, topology.size()))));
+    const int chunk = std::max(1, args.GetInt("--chunk", 8));
+    const int maxPoints = std::clamp(args.GetInt("--max-points", 64), 1, 4096);
+    const std::string pin = args.Get("--pin", "socket");
+    const std::string profileName = args.Get("--config", "default");
+    const std::string corpusDir = args.Get("--corpus", "");
+    const std::string csvPath = args.Get("--csv", "");
+    const bool verify = args.Has("--verify");
+    if (pin != "socket" && pin != "none") {
+        std::fprintf(stderr, "--pin expects socket or none\n");
+        return 2;
+    }
+
+    wchar_t error[256] = {};
+    ChromaConfigV1 defaults{};
+    defaults.structSize = static_cast<int32_t>(sizeof(defaults));
+    int32_t status = Chroma_GetDefaultConfig(&defaults, error, 256);
+    if (status != CHROMA_STATUS_OK) {
+        PrintError("Chroma_GetDefaultConfig", status, error);
+        return 1;
+    }
+    CorpusProfile profile;
+    if (!BuildProfile(profileName, defaults, profile)) {
+        std::fprintf(stderr, "unknown profile '%s' (expected default, clutter, context)\n", profileName.c_str());
+        return 2;
+    }
+
+    FrameSource source;
+    source.synthetic = std::max(0, args.GetInt("--frames", 240));
+    source.targets = profile.targets;
+    source.clutter = profile.clutter;
+    if (!corpusDir.empty()) {
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(corpusDir, ec)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".ppm") {
+                source.recorded.push_back(entry.path());
+            }
+        }
+        if (ec) {
+            std::fprintf(stderr, "cannot read corpus directory %s\n", corpusDir.c_str());
+            return 1;
+        }
+        std::sort(source.recorded.begin(), source.recorded.end());
+    }
+    const int64_t frameCount = source.Count();
+    if (frameCount == 0) {
+        std::fprintf(stderr, "no frames to run\n");
+        return 2;
+    }
+
+    // The active config is set before fork and inherited. No detection runs in this
+    // process until the workers have exited, so no OpenCV thread pool is forked.
+    status = Chroma_SetActiveConfig(&profile.config, error, 256);
+    if (status != CHROMA_STATUS_OK) {
+        PrintError("Chroma_SetActiveConfig", status, error);
+        return 1;
+    }
+
+    SharedStore store(frameCount, chunk, maxPoints);
+    if (!store.Ok()) {
+        std::fprintf(stderr, "cannot map %lld frame slots: %s\n", static_cast<long long>(frameCount), std::strerror(errno));
+        return 1;
+    }
+
+    const std::vector<std::vector<int>> sockets = (pin == "socket") ? topology : std::vector<std::vector<int>>{};
+    std::printf("batch: %lld frame(s), %d worker(s), chunk %d, %zu socket(s)%s, %.1f MB shared\n",
+        static_cast<long long>(frameCount), workers, chunk, std::max<size_t>(1, sockets.size()),
+        sockets.empty() ? ", unpinned" : "", BytesToMb(store.Bytes()));
+    std::fflush(stdout);
+
+    const Clock::time_point start = Clock::now();
+    std::vector<pid_t> children;
+    for (int w = 0; w < workers; ++w) {
+        const pid_t pid = fork();
+        if (pid < 0) {
+            std::fprintf(stderr, "fork failed: %s\n", std::strerror(errno));
+            break;
+        }
+        if (pid == 0) {
+            // Workers are spread round-robin over the sockets and may run on any CPU of theirs.
+            if (!sockets.empty() && !PinToCpus(sockets[static_cast<size_t>(w) % sockets.size()])) {
+                std::fprintf(stderr, "worker %d: cannot set CPU affinity\n", w);
+            }
+            std::fflush(stdout);
+            _exit(RunWorker(w, source, store));
+        }
+        children.push_back(pid);
+    }
+
+    int exitCode = children.size() == static_cast<size_t>(workers) ? 0 : 1;
+    for (const pid_t pid : children) {
+        int wstatus = 0;
+        while (waitpid(pid, &wstatus, 0) < 0 && errno == EINTR) {
+        }
+        if (!WIFEXITED(wstatus) || WEXITSTATUS(wstatus) != 0) {
+            std::fprintf(stderr, "worker pid %d %s %d\n", static_cast<int>(pid),
+                WIFSIGNALED(wstatus) ? "killed by signal" : "exited with", WIFSIGNALED(wstatus) ? WTERMSIG(wstatus) : WEXITSTATUS(wstatus));
+            exitCode = 1;
+        }
+    }
+    const double wallSeconds = static_cast<double>(NanosSince(start)) / 1e9;
+
+    // Merge in frame order.
+    FILE* csv = nullptr;
+    if (!csvPath.empty()) {
+        csv = std::fopen(csvPath.c_str(), "w");
+        if (csv == nullptr) {
+            std::fprintf(stderr, "cannot open %s\n", csvPath.c_str());
+            return 1;
+        }
+        std::fprintf(csv, "frame,width,height,worker,latency_us,total,points\n");
+    }
+    std::vector<uint64_t> perWorker(static_cast<size_t>(workers), 0);
+    std::vector<uint64_t> latencies;
+    latencies.reserve(static_cast<size_t>(frameCount));
+    uint64_t checksum = 1469598103934665603ULL;
+    uint64_t detections = 0;
+    int64_t missing = 0;
+    for (int64_t i = 0; i < frameCount; ++i) {
+        const BatchSlot& slot = store.Slot(i);
+        if (slot.done == 0 || (slot.status != CHROMA_STATUS_OK && slot.status != CHROMA_STATUS_BUFFER_TOO_SMALL)) {
+            missing += 1;
+            continue;
+        }
+        const ChromaPoint* points = store.Points(i);
+        checksum = HashPoints(checksum, points, slot.written);
+        detections += static_cast<uint64_t>(slot.total);
+        latencies.push_back(slot.latencyNs);
+        perWorker[static_cast<size_t>(slot.worker)] += 1;
+        if (csv != nullptr) {
+            std::fprintf(csv, "%lld,%d,%d,%d,%.1f,%d,", static_cast<long long>(i), slot.width, slot.height, slot.worker, NsToUs(slot.latencyNs), slot.total);
+            for (int32_t p = 0; p < slot.written; ++p) {
+                std::fprintf(csv, "%s%d:%d", p == 0 ? "" : ";", points[p].x, points[p].y);
+            }
+            std::fprintf(csv, "\n");
+        }
+    }
+    if (csv != nullptr) {
+        std::fclose(csv);
+    }
+    if (missing > 0) {
+        std::fprintf(stderr, "%lld frame(s) without a result\n", static_cast<long long>(missing));
+        exitCode = 1;
+    }
+
+    const double p50 = static_cast<double>(Percentile(latencies, 0.50)) / 1e6;
+    const double p99 = static_cast<double>(Percentile(latencies, 0.99)) / 1e6;
+    std::printf("wall %.3f s, %.1f frames/s, p50 %.3f ms, p99 %.3f ms, detections %llu, checksum %016llx\n",
+        wallSeconds, static_cast<double>(latencies.size()) / std::max(1e-9, wallSeconds), p50, p99,
+        static_cast<unsigned long long>(detections), static_cast<unsigned long long>(checksum));
+    for (int w = 0; w < workers; ++w) {
+        std::printf("  worker %2d: %llu frame(s)\n", w, static_cast<unsigned long long>(perWorker[static_cast<size_t>(w)]));
+    }
+
+    if (verify) {
+        // Reference: the same frames through one stream in this process.
+        ChromaStream* stream = nullptr;
+        status = Chroma_CreateStream(&stream, 0, error, 256);
+        if (status != CHROMA_STATUS_OK) {
+            PrintError("Chroma_CreateStream", status, error);
+            return 1;
+        }
+        std::vector<ChromaPoint> points(static_cast<size_t>(maxPoints));
+        int64_t mismatches = 0;
+        Frame frame;
+        for (int64_t i = 0; i < frameCount; ++i) {
+            int32_t total = 0;
+            int32_t written = 0;
+            status = source.Load(i, frame)
+                ? Chroma_LocateStreamBGRAW(stream, frame.bgra.data(), frame.width, frame.height, frame.Stride(),
+                    points.data(), maxPoints, &total, &written, error, 256)
+                : CHROMA_STATUS_INVALID_ARGUMENT;
+            const BatchSlot& slot = store.Slot(i);
+            const bool same = slot.done != 0 && slot.status == status && slot.total == total && slot.written == written
+                && std::equal(points.begin(), points.begin() + written, store.Points(i), [](const ChromaPoint& a, const ChromaPoint& b) {
+                    return a.x == b.x && a.y == b.y;
+                });
+            if (!same) {
+                if (mismatches < 10) {
+                    std::fprintf(stderr, "frame %lld differs from the single-process run\n", static_cast<long long>(i));
+                }
+                mismatches += 1;
+            }
+        }
+        Chroma_DestroyStream(stream);
+        std::printf("verify: %lld of %lld frame(s) differ from a single-process run\n",
+            static_cast<long long>(mismatches), static_cast<long long>(frameCount));
+        if (mismatches > 0) {
+            exitCode = 1;
+        }
+    }
+
+    Chroma_ResetConfigToDefault(error, 256);
+    return exitCode;
+}
+
+#endif
+
+}
@@ -0,0 +1,353 @@
+#pragma once
+
+#include "../chroma-core/ChromaApi.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace bench {
+
+using Clock = std::chrono::steady_clock;
+
+inline uint64_t NanosSince(const Clock::time_point since) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - since).count());
+}
+
+// Minimal "--key value" argument lookup.
+class Args {
+public:
+    Args(int argc, char** argv) : args_(argv, argv + argc) {}
+
+    std::string Get(const std::string& key, const std::string& fallback) const {
+        for (size_t i = 0; i + 1 < args_.size(); ++i) {
+            if (args_[i] == key) {
+                return args_[i + 1];
+            }
+        }
+        return fallback;
+    }
+
+    int GetInt(const std::string& key, int fallback) const {
+        const std::string v = Get(key, "");
+        return v.empty() ? fallback : std::atoi(v.c_str());
+    }
+
+    double GetDouble(const std::string& key, double fallback) const {
+        const std::string v = Get(key, "");
+        return v.empty() ? fallback : std::atof(v.c_str());
+    }
+
+    bool Has(const std::string& key) const {
+        return std::find(args_.begin(), args_.end(), key) != args_.end();
+    }
+
+private:
+    std::vector<std::string> args_;
+};
+
+struct Bgr {
+    uint8_t b;
+    uint8_t g;
+    uint8_t r;
+};
+
+// OpenCV HSV convention: h in [0,179], s/v in [0,255].
+inline Bgr HsvToBgr(int h, int s, int v) {
+    const double hd = (static_cast<double>(h) * 2.0) / 60.0;
+    const double sd = static_cast<double>(s) / 255.0;
+    const double vd = static_cast<double>(v) / 255.0;
+    const double c = vd * sd;
+    const double x = c * (1.0 - std::fabs(std::fmod(hd, 2.0) - 1.0));
+    const double m = vd - c;
+    double r = 0.0;
+    double g = 0.0;
+    double b = 0.0;
+    switch (static_cast<int>(hd) % 6) {
+    case 0: r = c; g = x; break;
+    case 1: r = x; g = c; break;
+    case 2: g = c; b = x; break;
+    case 3: g = x; b = c; break;
+    case 4: r = x; b = c; break;
+    default: r = c; b = x; break;
+    }
+    auto to8 = [m](double u) { return static_cast<uint8_t>(std::lround(std::clamp((u + m) * 255.0, 0.0, 255.0))); };
+    return { to8(b), to8(g), to8(r) };
+}
+
+struct Frame {
+    int32_t width = 0;
+    int32_t height = 0;
+    std::vector<uint8_t> bgra;
+
+    int32_t Stride() const {
+        return width * 4;
+    }
+};
+
+inline void FillDisc(Frame& f, int cx, int cy, int radius, Bgr color) {
+    const int r2 = radius * radius;
+    for (int y = std::max(0, cy - radius); y <= std::min(f.height - 1, cy + radius); ++y) {
+        for (int x = std::max(0, cx - radius); x <= std::min(f.width - 1, cx + radius); ++x) {
+            const int dx = x - cx;
+            const int dy = y - cy;
+            if (dx * dx + dy * dy <= r2) {
+                uint8_t* p = &f.bgra[(static_cast<size_t>(y) * static_cast<size_t>(f.width) + static_cast<size_t>(x)) * 4];
+                p[0] = color.b;
+                p[1] = color.g;
+                p[2] = color.r;
+                p[3] = 255;
+            }
+        }
+    }
+}
+
+// Synthetic scene for the default config: bright neutral background (passes the
+// context support rule), `targets` discs in the default center color and
+// `clutter` random-hue discs of random size.
+inline Frame MakeSyntheticFrame(int32_t width, int32_t height, int targets, int clutter, uint32_t seed) {
+    Frame f;
+    f.width = width;
+    f.height = height;
+    f.bgra.assign(static_cast<size_t>(width) * static_cast<size_t>(height) * 4, 0);
+    for (size_t i = 0; i < f.bgra.size(); i += 4) {
+        f.bgra[i + 0] = 170;
+        f.bgra[i + 1] = 170;
+        f.bgra[i + 2] = 170;
+        f.bgra[i + 3] = 255;
+    }
+
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> xs(0, std::max(0, width - 1));
+    std::uniform_int_distribution<int> ys(0, std::max(0, height - 1));
+    std::uniform_int_distribution<int> hues(0, 179);
+    std::uniform_int_distribution<int> radii(2, 24);
+
+    for (int i = 0; i < clutter; ++i) {
+        FillDisc(f, xs(rng), ys(rng), radii(rng), HsvToBgr(hues(rng), 200, 200));
+    }
+    const Bgr target = HsvToBgr(24, 90, 200);
+    for (int i = 0; i < targets; ++i) {
+        FillDisc(f, xs(rng), ys(rng), 9, target);
+    }
+    return f;
+}
+
+// Chroma_LocateBitmapWithDebugBGRAW with `debugPixels` as the debug image buffer. A null
+// buffer only reports bytesRequired (status OK); a short one fails with
+// BUFFER_TOO_SMALL. Either way the buffer is grown, so later calls include the copy.
+inline int32_t LocateWithDebugGrowing(
+    const Frame& frame,
+    ChromaPoint* points,
+    int32_t capacity,
+    int32_t* total,
+    int32_t* written,
+    std::vector<uint8_t>& debugPixels,
+    wchar_t* error,
+    int32_t errorChars) {
+    ChromaDebugImageV1 debug{};
+    debug.structSize = static_cast<int32_t>(sizeof(debug));
+    debug.bgraPixels = debugPixels.empty() ? nullptr : debugPixels.data();
+    debug.bgraCapacityBytes = static_cast<int32_t>(debugPixels.size());
+    int32_t status = Chroma_LocateBitmapWithDebugBGRAW(
+        frame.bgra.data(), frame.width, frame.height, frame.Stride(),
+        points, capacity, total, written, &debug, error, errorChars);
+    if ((status == CHROMA_STATUS_OK || status == CHROMA_STATUS_BUFFER_TOO_SMALL)
+        && debug.bytesRequired > static_cast<int32_t>(debugPixels.size())) {
+        debugPixels.resize(static_cast<size_t>(debug.bytesRequired));
+        status = CHROMA_STATUS_OK;
+    }
+    return status;
+}
+
+inline uint64_t Percentile(std::vector<uint64_t>& samples, double p) {
+    if (samples.empty()) {
+        return 0;
+    }
+    const size_t idx = std::min(samples.size() - 1, static_cast<size_t>(p * static_cast<double>(samples.size() - 1) + 0.5));
+    std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(idx), samples.end());
+    return samples[idx];
+}
+
+// Parses "a,b,c" into exactly `count` non-negative weights with a positive sum.
+inline bool ParseWeights(const std::string& text, int* weights, size_t count) {
+    std::vector<int> parsed;
+    size_t pos = 0;
+    while (pos <= text.size()) {
+        const size_t comma = text.find(',', pos);
+        const std::string part = text.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+        if (part.empty()) {
+            return false;
+        }
+        parsed.push_back(std::max(0, std::atoi(part.c_str())));
+        if (comma == std::string::npos) {
+            break;
+        }
+        pos = comma + 1;
+    }
+    int sum = 0;
+    for (const int w : parsed) {
+        sum += w;
+    }
+    if (parsed.size() != count || sum <= 0) {
+        return false;
+    }
+    std::copy(parsed.begin(), parsed.end(), weights);
+    return true;
+}
+
+// Resident set size of this process in bytes (0 when unavailable).
+inline uint64_t CurrentRssBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<uint64_t>(counters.WorkingSetSize);
+    }
+    return 0;
+#else
+    FILE* f = std::fopen("/proc/self/statm", "r");
+    if (f == nullptr) {
+        return 0;
+    }
+    unsigned long long sizePages = 0;
+    unsigned long long residentPages = 0;
+    const int n = std::fscanf(f, "%llu %llu", &sizePages, &residentPages);
+    std::fclose(f);
+    if (n != 2) {
+        return 0;
+    }
+    return static_cast<uint64_t>(residentPages) * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+inline double BytesToMb(uint64_t bytes) {
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+inline double NsToUs(uint64_t ns) {
+    return static_cast<double>(ns) / 1000.0;
+}
+
+inline void PrintError(const char* what, int32_t status, const wchar_t* error) {
+    std::fprintf(stderr, "%s failed (status %d): %ls\n", what, status, error);
+}
+
+// Named detection profiles used by the corpus run. Each profile pairs a config with
+// the synthetic scenes it is meant for.
+struct CorpusProfile {
+    std::string name;
+    ChromaConfigV1 config{};
+    int targets = 12;
+    int clutter = 40;
+};
+
+inline bool BuildProfile(const std::string& name, const ChromaConfigV1& defaults, CorpusProfile& out) {
+    out = {};
+    out.name = name;
+    out.config = defaults;
+    if (name == "default") {
+        return true;
+    }
+    if (name == "clutter") {
+        // Many candidates survive the shape tests, so the per-candidate loop dominates.
+        out.targets = 24;
+        out.clutter = 400;
+        out.config.minCircularity = 0.5F;
+        out.config.minCenterFillRatio = 0.4F;
+        out.config.centerSatRange.minValue = 30;
+        out.config.centerSatRange.maxValue = 220;
+        return true;
+    }
+    if (name == "context") {
+        out.targets = 24;
+        out.clutter = 120;
+        out.config.requireContextRing = 1;
+        out.config.ringOuterRadiusPercent = 300;
+        out.config.contextMinSupportRatio = 0.5F;
+        return true;
+    }
+    return false;
+}
+
+// Binary PPM (P6, maxval 255) -> BGRA. Recorded corpora are stored this way so the
+// harness needs no image codec.
+inline bool LoadPpm(const std::filesystem::path& path, Frame& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    std::string magic;
+    int width = 0;
+    int height = 0;
+    int maxval = 0;
+    in >> magic;
+    auto skipComments = [&]() {
+        in >> std::ws;
+        while (in.peek() == '#') {
+            std::string line;
+            std::getline(in, line);
+            in >> std::ws;
+        }
+    };
+    skipComments();
+    in >> width;
+    skipComments();
+    in >> height;
+    skipComments();
+    in >> maxval;
+    in.get();
+    if (magic != "P6" || width <= 0 || height <= 0 || maxval != 255) {
+        return false;
+    }
+    std::vector<uint8_t> rgb(static_cast<size_t>(width) * static_cast<size_t>(height) * 3);
+    in.read(reinterpret_cast<char*>(rgb.data()), static_cast<std::streamsize>(rgb.size()));
+    if (!in) {
+        return false;
+    }
+    out.width = width;
+    out.height = height;
+    out.bgra.resize(static_cast<size_t>(width) * static_cast<size_t>(height) * 4);
+    for (size_t i = 0, j = 0; i < rgb.size(); i += 3, j += 4) {
+        out.bgra[j + 0] = rgb[i + 2];
+        out.bgra[j + 1] = rgb[i + 1];
+        out.bgra[j + 2] = rgb[i + 0];
+        out.bgra[j + 3] = 255;
+    }
+    return true;
+}
+
+inline uint64_t HashPoints(uint64_t hash, const ChromaPoint* points, int32_t count) {
+    constexpr uint64_t kPrime = 1099511628211ULL;
+    auto mix = [&](int32_t v) {
+        for (int b = 0; b < 4; ++b) {
+            hash ^= static_cast<uint64_t>((static_cast<uint32_t>(v) >> (b * 8)) & 0xFFU);
+            hash *= kPrime;
+        }
+    };
+    mix(count);
+    for (int32_t i = 0; i < count; ++i) {
+        mix(points[i].x);
+        mix(points[i].y);
+    }
+    return hash;
+}
+
+}
@@ -0,0 +1,80 @@
+#include "BenchCommon.h"
+
+#include <cstring>
+
+namespace bench {
+int RunContention(const Args& args);
+int RunSoak(const Args& args);
+int RunCorpus(const Args& args);
+int RunBatch(const Args& args);
+}
+
+namespace {
+
+void PrintUsage() {
+    std::printf(
+        "usage: ChromaBench <mode> [options]\n"
+        "\n"
+        "modes:\n"
+        "  contention   multithreaded C ABI load generator\n"
+        "      --threads N       highest thread count (steps 1,2,4,..,N; default: hardware threads)\n"
+        "      --seconds S       duration of each step (default 2)\n"
+        "      --width W --height H   synthetic frame size (default 1280x720)\n"
+        "      --targets N --clutter N  discs per frame (default 12 / 40)\n"
+        "      --mix a,b,c,d     weights for locate,override,debug,setconfig (default 80,10,5,5)\n"
+        "      --csv PATH        also write per-step results as CSV\n"
+        "  soak         long-running mixed load; fails on RSS growth or latency drift\n"
+        "      --minutes M       total duration (default 60)\n"
+        "      --window S        reporting window (default 60)\n"
+        "      --threads N       concurrent worker slots; workers are replaced after 200..2000 calls (default 4)\n"
+        "      --warmup-windows N  windows before the baseline window (default 2)\n"
+        "      --max-rss-growth-mb MB  allowed RSS growth over the baseline window (default 64)\n"
+        "      --max-latency-drift F   allowed locate p99 growth, as a fraction (default 0.5)\n"
+        "      --drift-windows N consecutive windows over the drift limit before failing (default 3)\n"
+        "      --mix a,b,c,d,e   weights for locate,override,debug,setconfig,trim (default 70,10,10,5,1)\n"
+        "      --keep-going      report failures but run to the end\n"
+        "      --csv PATH        also write per-window results as CSV\n"
+        "  corpus       single-threaded end-to-end run over synthetic and recorded frames\n"
+        "      --configs LIST    profiles to run: default,clutter,context (default: all)\n"
+        "      --frames N        synthetic frames per profile, 720p/1080p alternating (default 120)\n"
+        "      --corpus DIR      also run every binary PPM (P6) in DIR\n"
+        "      --repeat R        passes over the frames (default 1)\n"
+        "      --csv PATH        also write per-profile results as CSV\n"
+        "  batch        offline run sharded over forked worker processes (POSIX only)\n"
+        "      --workers N       worker processes (default: one per socket)\n"
+        "      --pin socket|none pin workers round-robin to sockets (default socket)\n"
+        "      --chunk N         frames claimed from the shared queue at a time (default 8)\n"
+        "      --config NAME     profile: default, clutter or context (default default)\n"
+        "      --frames N        synthetic frames, 720p/1080p alternating (default 240)\n"
+        "      --corpus DIR      also run every binary PPM (P6) in DIR\n"
+        "      --max-points N    centers stored per frame (default 64)\n"
+        "      --verify          rerun in one process and compare every frame\n"
+        "      --csv PATH        also write the merged per-frame results as CSV\n");
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || std::strcmp(argv[1], "--help") == 0 || std::strcmp(argv[1], "-h") == 0) {
+        PrintUsage();
+        return argc < 2 ? 2 : 0;
+    }
+
+    const bench::Args args(argc - 1, argv + 1);
+    if (std::strcmp(argv[1], "contention") == 0) {
+        return bench::RunContention(args);
+    }
+    if (std::strcmp(argv[1], "soak") == 0) {
+        return bench::RunSoak(args);
+    }
+    if (std::strcmp(argv[1], "corpus") == 0) {
+        return bench::RunCorpus(args);
+    }
+    if (std::strcmp(argv[1], "batch") == 0) {
+        return bench::RunBatch(args);
+    }
+
+    std::fprintf(stderr, "unknown mode: %s\n\n", argv[1]);
+    PrintUsage();
+    return 2;
+}
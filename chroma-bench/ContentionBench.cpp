@@ -0,0 +1,231 @@
+#include "BenchCommon.h"
+
+#include <array>
+#include <atomic>
+#include <thread>
+
+namespace bench {
+namespace {
+
+enum class Op {
+    Locate = 0,
+    LocateWithConfig = 1,
+    LocateWithDebug = 2,
+    SetActiveConfig = 3
+};
+
+constexpr size_t kOpCount = 4;
+const char* const kOpNames[kOpCount] = { "locate", "override", "debug", "setconfig" };
+
+struct ContentionOptions {
+    int maxThreads = 8;
+    double secondsPerStep = 2.0;
+    int width = 1280;
+    int height = 720;
+    int targets = 12;
+    int clutter = 40;
+    std::array<int, kOpCount> weights{ 80, 10, 5, 5 };
+    std::string csvPath;
+};
+
+struct ThreadResult {
+    std::array<std::vector<uint64_t>, kOpCount> latencyNs;
+    uint64_t failures = 0;
+};
+
+// A second, valid config that differs from the default so SetActiveConfig and
+// per-call overrides do real work (and the active config actually changes).
+ChromaConfigV1 MakeAlternateConfig(const ChromaConfigV1& base) {
+    ChromaConfigV1 alt = base;
+    alt.minCircularity = base.minCircularity * 0.9F;
+    alt.contextMinSupportRatio = base.contextMinSupportRatio * 0.9F;
+    return alt;
+}
+
+void Worker(
+    const ContentionOptions& opts,
+    const Frame& frame,
+    const ChromaConfigV1& baseConfig,
+    const ChromaConfigV1& altConfig,
+    uint32_t seed,
+    const std::atomic<bool>& start,
+    const std::atomic<bool>& stop,
+    ThreadResult& out) {
+    std::mt19937 rng(seed);
+    std::discrete_distribution<int> pick(opts.weights.begin(), opts.weights.end());
+
+    std::array<ChromaPoint, 256> points{};
+    std::vector<uint8_t> debugPixels;
+    wchar_t error[256] = {};
+
+    while (!start.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+
+    uint64_t iteration = 0;
+    while (!stop.load(std::memory_order_relaxed)) {
+        const Op op = static_cast<Op>(pick(rng));
+        int32_t total = 0;
+        int32_t written = 0;
+        int32_t status = CHROMA_STATUS_OK;
+        const Clock::time_point begin = Clock::now();
+        switch (op) {
+        case Op::Locate:
+            status = Chroma_LocateBitmapBGRAW(
+                frame.bgra.data(), frame.width, frame.height, frame.Stride(),
+                points.data(), static_cast<int32_t>(points.size()), &total, &written, error, 256);
+            break;
+        case Op::LocateWithConfig:
+            status = Chroma_LocateBitmapWithConfigBGRAW(
+                frame.bgra.data(), frame.width, frame.height, frame.Stride(), &altConfig,
+                points.data(), static_cast<int32_t>(points.size()), &total, &written, error, 256);
+            break;
+        case Op::LocateWithDebug:
+            status = LocateWithDebugGrowing(
+                frame, points.data(), static_cast<int32_t>(points.size()), &total, &written, debugPixels, error, 256);
+            break;
+        case Op::SetActiveConfig:
+            status = Chroma_SetActiveConfig((iteration & 1U) != 0 ? &altConfig : &baseConfig, error, 256);
+            break;
+        }
+        const uint64_t elapsed = NanosSince(begin);
+        ++iteration;
+        if (status != CHROMA_STATUS_OK) {
+            ++out.failures;
+            continue;
+        }
+        out.latencyNs[static_cast<size_t>(op)].push_back(elapsed);
+    }
+}
+
+}
+
+int RunContention(const Args& args) {
+    ContentionOptions opts;
+    opts.maxThreads = std::max(1, args.GetInt("--threads", static_cast<int>(std::max(1U, std::thread::hardware_concurrency()))));
+    opts.secondsPerStep = std::max(0.1, args.GetDouble("--seconds", opts.secondsPerStep));
+    opts.width = std::max(16, args.GetInt("--width", opts.width));
+    opts.height = std::max(16, args.GetInt("--height", opts.height));
+    opts.targets = std::max(0, args.GetInt("--targets", opts.targets));
+    opts.clutter = std::max(0, args.GetInt("--clutter", opts.clutter));
+    opts.csvPath = args.Get("--csv", "");
+    const std::string mix = args.Get("--mix", "");
+    if (!mix.empty() && !ParseWeights(mix, opts.weights.data(), kOpCount)) {
+        std::fprintf(stderr, "--mix expects four comma-separated weights: locate,override,debug,setconfig\n");
+        return 2;
+    }
+
+    wchar_t error[256] = {};
+    ChromaConfigV1 baseConfig{};
+    baseConfig.structSize = static_cast<int32_t>(sizeof(baseConfig));
+    int32_t status = Chroma_GetDefaultConfig(&baseConfig, error, 256);
+    if (status != CHROMA_STATUS_OK) {
+        PrintError("Chroma_GetDefaultConfig", status, error);
+        return 1;
+    }
+    const ChromaConfigV1 altConfig = MakeAlternateConfig(baseConfig);
+
+    const Frame frame = MakeSyntheticFrame(opts.width, opts.height, opts.targets, opts.clutter, 1234U);
+    status = Chroma_Warmup(opts.width, opts.height, CHROMA_PIXEL_FORMAT_BGRA8, opts.maxThreads, error, 256);
+    if (status != CHROMA_STATUS_OK) {
+        PrintError("Chroma_Warmup", status, error);
+        return 1;
+    }
+
+    FILE* csv = nullptr;
+    if (!opts.csvPath.empty()) {
+        csv = std::fopen(opts.csvPath.c_str(), "w");
+        if (csv == nullptr) {
+            std::fprintf(stderr, "cannot open %s\n", opts.csvPath.c_str());
+            return 1;
+        }
+        std::fprintf(csv, "threads,op,count,ops_per_sec,p50_us,p99_us,p999_us,max_us,lock_acquisitions,lock_contended,lock_wait_ms,lock_hold_ms\n");
+    }
+
+    std::printf("contention: %dx%d, %d targets, %d clutter, %.1fs per step, mix locate/override/debug/setconfig = %d/%d/%d/%d\n",
+        opts.width, opts.height, opts.targets, opts.clutter, opts.secondsPerStep,
+        opts.weights[0], opts.weights[1], opts.weights[2], opts.weights[3]);
+
+    double baselineLocatePerSec = 0.0;
+    for (int threads = 1; threads <= opts.maxThreads; threads = (threads == opts.maxThreads) ? threads + 1 : std::min(opts.maxThreads, threads * 2)) {
+        Chroma_SetActiveConfig(&baseConfig, error, 256);
+        Chroma_ResetRuntimeStats();
+
+        std::atomic<bool> start{ false };
+        std::atomic<bool> stop{ false };
+        std::vector<ThreadResult> results(static_cast<size_t>(threads));
+        std::vector<std::thread> pool;
+        pool.reserve(static_cast<size_t>(threads));
+        for (int t = 0; t < threads; ++t) {
+            pool.emplace_back(Worker, std::cref(opts), std::cref(frame), std::cref(baseConfig), std::cref(altConfig),
+                static_cast<uint32_t>(1000 + t), std::cref(start), std::cref(stop), std::ref(results[static_cast<size_t>(t)]));
+        }
+        const Clock::time_point begin = Clock::now();
+        start.store(true, std::memory_order_release);
+        std::this_thread::sleep_for(std::chrono::duration<double>(opts.secondsPerStep));
+        stop.store(true, std::memory_order_relaxed);
+        for (std::thread& th : pool) {
+            th.join();
+        }
+        const double elapsedSec = static_cast<double>(NanosSince(begin)) / 1e9;
+
+        ChromaRuntimeStatsV1 runtime{};
+        runtime.structSize = static_cast<int32_t>(sizeof(runtime));
+        Chroma_GetRuntimeStats(&runtime, error, 256);
+
+        uint64_t failures = 0;
+        std::printf("\n[%d thread%s] %.2fs\n", threads, threads == 1 ? "" : "s", elapsedSec);
+        std::printf("  %-10s %10s %12s %10s %10s %10s %10s\n", "op", "count", "ops/s", "p50 us", "p99 us", "p99.9 us", "max us");
+        for (size_t op = 0; op < kOpCount; ++op) {
+            std::vector<uint64_t> merged;
+            for (ThreadResult& r : results) {
+                merged.insert(merged.end(), r.latencyNs[op].begin(), r.latencyNs[op].end());
+            }
+            if (merged.empty()) {
+                continue;
+            }
+            const double perSec = static_cast<double>(merged.size()) / elapsedSec;
+            const uint64_t maxNs = *std::max_element(merged.begin(), merged.end());
+            const uint64_t p50 = Percentile(merged, 0.50);
+            const uint64_t p99 = Percentile(merged, 0.99);
+            const uint64_t p999 = Percentile(merged, 0.999);
+            std::printf("  %-10s %10zu %12.1f %10.1f %10.1f %10.1f %10.1f\n",
+                kOpNames[op], merged.size(), perSec, NsToUs(p50), NsToUs(p99), NsToUs(p999), NsToUs(maxNs));
+            if (op == static_cast<size_t>(Op::Locate)) {
+                if (threads == 1) {
+                    baselineLocatePerSec = perSec;
+                } else if (baselineLocatePerSec > 0.0) {
+                    std::printf("  %-10s scaling %.2fx over 1 thread (ideal %dx)\n", "", perSec / baselineLocatePerSec, threads);
+                }
+            }
+            if (csv != nullptr) {
+                std::fprintf(csv, "%d,%s,%zu,%.3f,%.3f,%.3f,%.3f,%.3f,%llu,%llu,%.3f,%.3f\n",
+                    threads, kOpNames[op], merged.size(), perSec, NsToUs(p50), NsToUs(p99), NsToUs(p999), NsToUs(maxNs),
+                    static_cast<unsigned long long>(runtime.configLockAcquisitions),
+                    static_cast<unsigned long long>(runtime.configLockContended),
+                    static_cast<double>(runtime.configLockWaitNs) / 1e6,
+                    static_cast<double>(runtime.configLockHoldNs) / 1e6);
+            }
+        }
+        for (const ThreadResult& r : results) {
+            failures += r.failures;
+        }
+        const double contendedPct = runtime.configLockAcquisitions == 0 ? 0.0
+            : 100.0 * static_cast<double>(runtime.configLockContended) / static_cast<double>(runtime.configLockAcquisitions);
+        std::printf("  config lock: %llu acquisitions, %.2f%% contended, wait %.3f ms total, hold %.3f ms total\n",
+            static_cast<unsigned long long>(runtime.configLockAcquisitions), contendedPct,
+            static_cast<double>(runtime.configLockWaitNs) / 1e6,
+            static_cast<double>(runtime.configLockHoldNs) / 1e6);
+        if (failures != 0) {
+            std::printf("  failures: %llu\n", static_cast<unsigned long long>(failures));
+        }
+    }
+
+    Chroma_ResetConfigToDefault(error, 256);
+    if (csv != nullptr) {
+        std::fclose(csv);
+    }
+    return 0;
+}
+
+}
@@ -0,0 +1,164 @@
+#include "BenchCommon.h"
+
+#include <array>
+#include <filesystem>
+
+namespace bench {
+namespace {
+
+// Bottom-up copy of `frame`, for the negative-stride entry path.
+std::vector<uint8_t> FlipRows(const Frame& frame) {
+    std::vector<uint8_t> flipped(frame.bgra.size());
+    const size_t stride = static_cast<size_t>(frame.Stride());
+    for (int32_t y = 0; y < frame.height; ++y) {
+        std::copy_n(&frame.bgra[static_cast<size_t>(y) * stride], stride, &flipped[static_cast<size_t>(frame.height - 1 - y) * stride]);
+    }
+    return flipped;
+}
+
+}
+
+int RunCorpus(const Args& args) {
+    const int syntheticFrames = std::max(0, args.GetInt("--frames", 120));
+    const int repeat = std::max(1, args.GetInt("--repeat", 1));
+    const std::string corpusDir = args.Get("--corpus", "");
+    const std::string csvPath = args.Get("--csv", "");
+    const std::string profileList = args.Get("--configs", "default,clutter,context");
+
+    wchar_t error[256] = {};
+    ChromaConfigV1 defaults{};
+    defaults.structSize = static_cast<int32_t>(sizeof(defaults));
+    int32_t status = Chroma_GetDefaultConfig(&defaults, error, 256);
+    if (status != CHROMA_STATUS_OK) {
+        PrintError("Chroma_GetDefaultConfig", status, error);
+        return 1;
+    }
+
+    std::vector<CorpusProfile> profiles;
+    size_t pos = 0;
+    while (pos <= profileList.size()) {
+        const size_t comma = profileList.find(',', pos);
+        const std::string name = profileList.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+        CorpusProfile profile;
+        if (!BuildProfile(name, defaults, profile)) {
+            std::fprintf(stderr, "unknown profile '%s' (expected default, clutter, context)\n", name.c_str());
+            return 2;
+        }
+        profiles.push_back(profile);
+        if (comma == std::string::npos) {
+            break;
+        }
+        pos = comma + 1;
+    }
+
+    std::vector<Frame> recorded;
+    if (!corpusDir.empty()) {
+        std::error_code ec;
+        std::vector<std::filesystem::path> files;
+        for (const auto& entry : std::filesystem::directory_iterator(corpusDir, ec)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".ppm") {
+                files.push_back(entry.path());
+            }
+        }
+        if (ec) {
+            std::fprintf(stderr, "cannot read corpus directory %s\n", corpusDir.c_str());
+            return 1;
+        }
+        std::sort(files.begin(), files.end());
+        for (const auto& file : files) {
+            Frame frame;
+            if (!LoadPpm(file, frame)) {
+                std::fprintf(stderr, "skipping %s (not a binary 8-bit PPM)\n", file.string().c_str());
+                continue;
+            }
+            recorded.push_back(std::move(frame));
+        }
+        std::printf("corpus: %zu recorded frame(s) from %s\n", recorded.size(), corpusDir.c_str());
+    }
+
+    FILE* csv = nullptr;
+    if (!csvPath.empty()) {
+        csv = std::fopen(csvPath.c_str(), "w");
+        if (csv == nullptr) {
+            std::fprintf(stderr, "cannot open %s\n", csvPath.c_str());
+            return 1;
+        }
+        std::fprintf(csv, "profile,frames,mean_ms,p50_ms,p99_ms,detections,checksum\n");
+    }
+
+    std::printf("%-10s %8s %10s %10s %10s %11s %18s\n", "profile", "frames", "mean ms", "p50 ms", "p99 ms", "detections", "checksum");
+    std::array<ChromaPoint, 512> points{};
+    int exitCode = 0;
+    for (const CorpusProfile& profile : profiles) {
+        // Synthetic scenes alternate between 720p and 1080p and are regenerated per profile.
+        std::vector<Frame> frames;
+        for (int i = 0; i < syntheticFrames; ++i) {
+            const bool large = (i % 2) != 0;
+            frames.push_back(MakeSyntheticFrame(large ? 1920 : 1280, large ? 1080 : 720, profile.targets, profile.clutter, static_cast<uint32_t>(7919 * (i + 1))));
+        }
+        frames.insert(frames.end(), recorded.begin(), recorded.end());
+
+        status = Chroma_SetActiveConfig(&profile.config, error, 256);
+        if (status != CHROMA_STATUS_OK) {
+            PrintError("Chroma_SetActiveConfig", status, error);
+            exitCode = 1;
+            continue;
+        }
+
+        std::vector<uint64_t> latencies;
+        uint64_t checksum = 1469598103934665603ULL;
+        uint64_t detections = 0;
+        uint64_t totalNs = 0;
+        for (int r = 0; r < repeat; ++r) {
+            for (size_t i = 0; i < frames.size(); ++i) {
+                const Frame& frame = frames[i];
+                int32_t total = 0;
+                int32_t written = 0;
+                // Cover the three common entry paths: active config, per-call override
+                // (config validation + marshaling), and bottom-up buffers.
+                const size_t path = i % 3;
+                const std::vector<uint8_t> flipped = (path == 2) ? FlipRows(frame) : std::vector<uint8_t>();
+                const Clock::time_point begin = Clock::now();
+                if (path == 0) {
+                    status = Chroma_LocateBitmapBGRAW(frame.bgra.data(), frame.width, frame.height, frame.Stride(),
+                        points.data(), static_cast<int32_t>(points.size()), &total, &written, error, 256);
+                } else if (path == 1) {
+                    status = Chroma_LocateBitmapWithConfigBGRAW(frame.bgra.data(), frame.width, frame.height, frame.Stride(), &profile.config,
+                        points.data(), static_cast<int32_t>(points.size()), &total, &written, error, 256);
+                } else {
+                    const uint8_t* lastRow = flipped.data() + static_cast<size_t>(frame.height - 1) * static_cast<size_t>(frame.Stride());
+                    status = Chroma_LocateBitmapBGRAW(lastRow, frame.width, frame.height, -frame.Stride(),
+                        points.data(), static_cast<int32_t>(points.size()), &total, &written, error, 256);
+                }
+                const uint64_t elapsed = NanosSince(begin);
+                if (status != CHROMA_STATUS_OK && status != CHROMA_STATUS_BUFFER_TOO_SMALL) {
+                    PrintError("locate", status, error);
+                    exitCode = 1;
+                    continue;
+                }
+                latencies.push_back(elapsed);
+                totalNs += elapsed;
+                detections += static_cast<uint64_t>(total);
+                checksum = HashPoints(checksum, points.data(), written);
+            }
+        }
+
+        const double mean = latencies.empty() ? 0.0 : static_cast<double>(totalNs) / static_cast<double>(latencies.size()) / 1e6;
+        const double p50 = static_cast<double>(Percentile(latencies, 0.50)) / 1e6;
+        const double p99 = static_cast<double>(Percentile(latencies, 0.99)) / 1e6;
+        std::printf("%-10s %8zu %10.3f %10.3f %10.3f %11llu %018llx\n", profile.name.c_str(), latencies.size(), mean, p50, p99,
+            static_cast<unsigned long long>(detections), static_cast<unsigned long long>(checksum));
+        if (csv != nullptr) {
+            std::fprintf(csv, "%s,%zu,%.4f,%.4f,%.4f,%llu,%016llx\n", profile.name.c_str(), latencies.size(), mean, p50, p99,
+                static_cast<unsigned long long>(detections), static_cast<unsigned long long>(checksum));
+        }
+    }
+
+    Chroma_ResetConfigToDefault(error, 256);
+    if (csv != nullptr) {
+        std::fclose(csv);
+    }
+    return exitCode;
+}
+
+}
@@ -0,0 +1,334 @@
+#include "BenchCommon.h"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace bench {
+namespace {
+
+enum class SoakOp {
+    Locate = 0,       // stream call when the worker owns a stream, pooled otherwise
+    Override = 1,
+    Debug = 2,
+    SetConfig = 3,
+    Trim = 4
+};
+
+constexpr size_t kSoakOpCount = 5;
+const char* const kSoakOpNames[kSoakOpCount] = { "locate", "override", "debug", "setconfig", "trim" };
+
+struct SoakOptions {
+    double minutes = 60.0;
+    double windowSeconds = 60.0;
+    int threads = 4;
+    int warmupWindows = 2;
+    int minOpsPerWorker = 200;      // thread churn: each worker exits after a random op count
+    int maxOpsPerWorker = 2000;
+    double maxRssGrowthMb = 64.0;   // over the baseline window
+    double maxLatencyDrift = 0.5;   // p99 may grow by this fraction over the baseline window
+    int driftWindows = 3;           // consecutive windows over the drift limit before failing
+    bool keepGoing = false;
+    std::array<int, kSoakOpCount> weights{ 70, 10, 10, 5, 1 };
+    std::string csvPath;
+};
+
+// Latencies are normalized to ns per megapixel so windows with a different
+// resolution mix stay comparable.
+struct WindowSamples {
+    std::array<std::vector<uint64_t>, kSoakOpCount> nsPerMpx;
+    uint64_t ops = 0;
+    uint64_t failures = 0;
+    uint64_t workersStarted = 0;
+};
+
+class SoakCollector {
+public:
+    void Add(const WindowSamples& local) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t op = 0; op < kSoakOpCount; ++op) {
+            current_.nsPerMpx[op].insert(current_.nsPerMpx[op].end(), local.nsPerMpx[op].begin(), local.nsPerMpx[op].end());
+        }
+        current_.ops += local.ops;
+        current_.failures += local.failures;
+        current_.workersStarted += local.workersStarted;
+    }
+
+    WindowSamples Take() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        WindowSamples out = std::move(current_);
+        current_ = {};
+        return out;
+    }
+
+private:
+    std::mutex mutex_;
+    WindowSamples current_;
+};
+
+struct SoakShared {
+    const SoakOptions* opts = nullptr;
+    const std::vector<Frame>* frames = nullptr;
+    const ChromaConfigV1* baseConfig = nullptr;
+    const ChromaConfigV1* altConfig = nullptr;
+    SoakCollector* collector = nullptr;
+    std::atomic<bool>* stop = nullptr;
+};
+
+void SoakWorker(const SoakShared& shared, uint32_t seed, std::atomic<bool>& finished) {
+    const SoakOptions& opts = *shared.opts;
+    std::mt19937 rng(seed);
+    std::discrete_distribution<int> pick(opts.weights.begin(), opts.weights.end());
+    std::uniform_int_distribution<int> frameIndex(0, static_cast<int>(shared.frames->size()) - 1);
+    std::uniform_int_distribution<int> lifetime(opts.minOpsPerWorker, std::max(opts.minOpsPerWorker, opts.maxOpsPerWorker));
+
+    wchar_t error[256] = {};
+    ChromaStream* stream = nullptr;
+    if ((rng() & 1U) != 0) {
+        Chroma_CreateStream(&stream, static_cast<int32_t>(rng() & 1U), error, 256);
+    }
+
+    std::array<ChromaPoint, 256> points{};
+    std::vector<uint8_t> debugPixels;
+    WindowSamples local;
+    local.workersStarted = 1;
+    const int ops = lifetime(rng);
+
+    for (int i = 0; i < ops && !shared.stop->load(std::memory_order_relaxed); ++i) {
+        const SoakOp op = static_cast<SoakOp>(pick(rng));
+        const Frame& frame = (*shared.frames)[static_cast<size_t>(frameIndex(rng))];
+        int32_t total = 0;
+        int32_t written = 0;
+        int32_t status = CHROMA_STATUS_OK;
+        const Clock::time_point begin = Clock::now();
+        switch (op) {
+        case SoakOp::Locate:
+            if (stream != nullptr) {
+                status = Chroma_LocateStreamBGRAW(stream, frame.bgra.data(), frame.width, frame.height, frame.Stride(),
+                    points.data(), static_cast<int32_t>(points.size()), &total, &written, error, 256);
+            } else {
+                status = Chroma_LocateBitmapBGRAW(frame.bgra.data(), frame.width, frame.height, frame.Stride(),
+                    points.data(), static_cast<int32_t>(points.size()), &total, &written, error, 256);
+            }
+            break;
+        case SoakOp::Override:
+            status = Chroma_LocateBitmapWithConfigBGRAW(frame.bgra.data(), frame.width, frame.height, frame.Stride(),
+                shared.altConfig, points.data(), static_cast<int32_t>(points.size()), &total, &written, error, 256);
+            break;
+        case SoakOp::Debug:
+            status = LocateWithDebugGrowing(frame, points.data(), static_cast<int32_t>(points.size()),
+                &total, &written, debugPixels, error, 256);
+            break;
+        case SoakOp::SetConfig:
+            status = Chroma_SetActiveConfig((rng() & 1U) != 0 ? shared.altConfig : shared.baseConfig, error, 256);
+            break;
+        case SoakOp::Trim:
+            status = Chroma_TrimMemory(error, 256);
+            break;
+        }
+        const uint64_t elapsed = NanosSince(begin);
+        local.ops += 1;
+        if (status != CHROMA_STATUS_OK) {
+            local.failures += 1;
+            continue;
+        }
+        const double mpx = static_cast<double>(frame.width) * static_cast<double>(frame.height) / 1e6;
+        const bool perFrame = (op == SoakOp::Locate || op == SoakOp::Override || op == SoakOp::Debug);
+        local.nsPerMpx[static_cast<size_t>(op)].push_back(perFrame ? static_cast<uint64_t>(static_cast<double>(elapsed) / mpx) : elapsed);
+
+        if ((local.ops & 63U) == 0) {
+            shared.collector->Add(local);
+            local = {};
+        }
+    }
+
+    if (stream != nullptr) {
+        Chroma_DestroyStream(stream);
+    }
+    shared.collector->Add(local);
+    finished.store(true, std::memory_order_release);
+}
+
+struct WorkerSlot {
+    std::thread thread;
+    std::unique_ptr<std::atomic<bool>> finished = std::make_unique<std::atomic<bool>>(false);
+};
+
+}
+
+int RunSoak(const Args& args) {
+    SoakOptions opts;
+    opts.minutes = std::max(0.05, args.GetDouble("--minutes", opts.minutes));
+    opts.windowSeconds = std::max(1.0, args.GetDouble("--window", opts.windowSeconds));
+    opts.threads = std::max(1, args.GetInt("--threads", opts.threads));
+    opts.warmupWindows = std::max(0, args.GetInt("--warmup-windows", opts.warmupWindows));
+    opts.maxRssGrowthMb = args.GetDouble("--max-rss-growth-mb", opts.maxRssGrowthMb);
+    opts.maxLatencyDrift = args.GetDouble("--max-latency-drift", opts.maxLatencyDrift);
+    opts.driftWindows = std::max(1, args.GetInt("--drift-windows", opts.driftWindows));
+    opts.keepGoing = args.Has("--keep-going");
+    opts.csvPath = args.Get("--csv", "");
+    const std::string mix = args.Get("--mix", "");
+    if (!mix.empty() && !ParseWeights(mix, opts.weights.data(), kSoakOpCount)) {
+        std::fprintf(stderr, "--mix expects five comma-separated weights: locate,override,debug,setconfig,trim\n");
+        return 2;
+    }
+
+    wchar_t error[256] = {};
+    ChromaConfigV1 baseConfig{};
+    baseConfig.structSize = static_cast<int32_t>(sizeof(baseConfig));
+    int32_t status = Chroma_GetDefaultConfig(&baseConfig, error, 256);
+    if (status != CHROMA_STATUS_OK) {
+        PrintError("Chroma_GetDefaultConfig", status, error);
+        return 1;
+    }
+    ChromaConfigV1 altConfig = baseConfig;
+    altConfig.minCircularity = baseConfig.minCircularity * 0.9F;
+    altConfig.requireContextRing = 0;
+
+    // Resolution mix; two scenes per size so consecutive frames differ.
+    const std::array<std::array<int32_t, 2>, 4> sizes{ { { 640, 360 }, { 1280, 720 }, { 1920, 1080 }, { 1024, 768 } } };
+    std::vector<Frame> frames;
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        for (uint32_t variant = 0; variant < 2; ++variant) {
+            frames.push_back(MakeSyntheticFrame(sizes[i][0], sizes[i][1], 8 + static_cast<int>(variant) * 8, 30 + static_cast<int>(variant) * 60,
+                static_cast<uint32_t>(100 + i * 10 + variant)));
+        }
+    }
+
+    FILE* csv = nullptr;
+    if (!opts.csvPath.empty()) {
+        csv = std::fopen(opts.csvPath.c_str(), "w");
+        if (csv == nullptr) {
+            std::fprintf(stderr, "cannot open %s\n", opts.csvPath.c_str());
+            return 1;
+        }
+        std::fprintf(csv, "window,minutes,ops,failures,workers_started,locate_p50_us_per_mpx,locate_p99_us_per_mpx,debug_p99_us_per_mpx,"
+                          "setconfig_p99_us,rss_mb,arena_in_use_mb,arena_cached_mb,arena_peak_reserved_mb,idle_workspaces,live_arenas\n");
+    }
+
+    std::printf("soak: %.1f min, %.0fs windows, %d worker slots, mix locate/override/debug/setconfig/trim = %d/%d/%d/%d/%d\n",
+        opts.minutes, opts.windowSeconds, opts.threads,
+        opts.weights[0], opts.weights[1], opts.weights[2], opts.weights[3], opts.weights[4]);
+    std::printf("limits: rss growth %.1f MB, p99 drift %.0f%% for %d windows, %d warmup window(s)\n",
+        opts.maxRssGrowthMb, opts.maxLatencyDrift * 100.0, opts.driftWindows, opts.warmupWindows);
+    std::printf("%6s %7s %9s %6s %12s %12s %12s %9s %9s %9s\n",
+        "window", "min", "ops", "fail", "loc p50", "loc p99", "dbg p99", "rss MB", "arena MB", "cache MB");
+
+    SoakCollector collector;
+    std::atomic<bool> stop{ false };
+    SoakShared shared{ &opts, &frames, &baseConfig, &altConfig, &collector, &stop };
+
+    std::vector<WorkerSlot> slots(static_cast<size_t>(opts.threads));
+    uint32_t nextSeed = 1;
+    for (WorkerSlot& slot : slots) {
+        slot.thread = std::thread(SoakWorker, std::cref(shared), nextSeed++, std::ref(*slot.finished));
+    }
+
+    const Clock::time_point start = Clock::now();
+    const auto windowLength = std::chrono::duration<double>(opts.windowSeconds);
+    const auto totalLength = std::chrono::duration<double>(opts.minutes * 60.0);
+    Clock::time_point windowEnd = start + std::chrono::duration_cast<Clock::duration>(windowLength);
+
+    int window = 0;
+    bool haveBaseline = false;
+    uint64_t baselineRss = 0;
+    uint64_t baselineLocateP99 = 0;
+    int driftStreak = 0;
+    int exitCode = 0;
+
+    while (true) {
+        // Thread churn: replace workers that reached the end of their lifetime.
+        for (WorkerSlot& slot : slots) {
+            if (slot.finished->load(std::memory_order_acquire)) {
+                slot.thread.join();
+                slot.finished->store(false, std::memory_order_relaxed);
+                slot.thread = std::thread(SoakWorker, std::cref(shared), nextSeed++, std::ref(*slot.finished));
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+        const Clock::time_point now = Clock::now();
+        if (now < windowEnd) {
+            continue;
+        }
+        windowEnd += std::chrono::duration_cast<Clock::duration>(windowLength);
+
+        WindowSamples samples = collector.Take();
+        ChromaMemoryStatsV1 memory{};
+        memory.structSize = static_cast<int32_t>(sizeof(memory));
+        Chroma_GetMemoryStats(&memory, error, 256);
+        const uint64_t rss = CurrentRssBytes();
+        const double minutes = std::chrono::duration<double>(now - start).count() / 60.0;
+
+        const uint64_t locateP50 = Percentile(samples.nsPerMpx[static_cast<size_t>(SoakOp::Locate)], 0.50);
+        const uint64_t locateP99 = Percentile(samples.nsPerMpx[static_cast<size_t>(SoakOp::Locate)], 0.99);
+        const uint64_t debugP99 = Percentile(samples.nsPerMpx[static_cast<size_t>(SoakOp::Debug)], 0.99);
+        const uint64_t setConfigP99 = Percentile(samples.nsPerMpx[static_cast<size_t>(SoakOp::SetConfig)], 0.99);
+
+        std::printf("%6d %7.1f %9llu %6llu %12.1f %12.1f %12.1f %9.1f %9.1f %9.1f\n",
+            window, minutes,
+            static_cast<unsigned long long>(samples.ops), static_cast<unsigned long long>(samples.failures),
+            NsToUs(locateP50), NsToUs(locateP99), NsToUs(debugP99),
+            BytesToMb(rss), BytesToMb(memory.bytesInUse), BytesToMb(memory.bytesCached));
+        std::fflush(stdout);
+        if (csv != nullptr) {
+            std::fprintf(csv, "%d,%.3f,%llu,%llu,%llu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%d,%d\n",
+                window, minutes,
+                static_cast<unsigned long long>(samples.ops), static_cast<unsigned long long>(samples.failures),
+                static_cast<unsigned long long>(samples.workersStarted),
+                NsToUs(locateP50), NsToUs(locateP99), NsToUs(debugP99), NsToUs(setConfigP99),
+                BytesToMb(rss), BytesToMb(memory.bytesInUse), BytesToMb(memory.bytesCached), BytesToMb(memory.peakBytesReserved),
+                memory.idleWorkspaces, memory.liveArenas);
+            std::fflush(csv);
+        }
+
+        if (window >= opts.warmupWindows) {
+            if (!haveBaseline) {
+                haveBaseline = true;
+                baselineRss = rss;
+                baselineLocateP99 = locateP99;
+            } else {
+                const char* failure = nullptr;
+                const double growthMb = rss > baselineRss ? BytesToMb(rss - baselineRss) : 0.0;
+                if (growthMb > opts.maxRssGrowthMb) {
+                    failure = "rss growth";
+                    std::printf("FAIL window %d: RSS grew %.1f MB over the baseline window (limit %.1f MB)\n",
+                        window, growthMb, opts.maxRssGrowthMb);
+                }
+                const double limit = static_cast<double>(baselineLocateP99) * (1.0 + opts.maxLatencyDrift);
+                driftStreak = (baselineLocateP99 > 0 && static_cast<double>(locateP99) > limit) ? driftStreak + 1 : 0;
+                if (driftStreak >= opts.driftWindows) {
+                    failure = "latency drift";
+                    std::printf("FAIL window %d: locate p99 %.1f us/Mpx over %.1f us/Mpx for %d windows\n",
+                        window, NsToUs(locateP99), limit / 1000.0, driftStreak);
+                }
+                if (failure != nullptr) {
+                    exitCode = 1;
+                    if (!opts.keepGoing) {
+                        break;
+                    }
+                }
+            }
+        }
+
+        ++window;
+        if (now - start >= totalLength) {
+            break;
+        }
+    }
+
+    stop.store(true, std::memory_order_relaxed);
+    for (WorkerSlot& slot : slots) {
+        slot.thread.join();
+    }
+    Chroma_ResetConfigToDefault(error, 256);
+    if (csv != nullptr) {
+        std::fclose(csv);
+    }
+    std::printf("%s\n", exitCode == 0 ? "soak passed" : "soak failed");
+    return exitCode;
+}
+
+}
@@ -6,7 +6,7 @@
 #define CHROMA_API extern "C" __declspec(dllexport)
 #define CHROMA_CALL __stdcall
 #else
-#define CHROMA_API extern "C"
+#define CHROMA_API extern "C" __attribute__((visibility("default")))
 #define CHROMA_CALL
 #endif
 
@@ -68,6 +68,68 @@ struct ChromaDebugImageV1 {
     int32_t bytesRequired;
     int32_t bytesWritten;
 };
+enum ChromaPixelFormat : int32_t {
+    CHROMA_PIXEL_FORMAT_BGRA8 = 0,
+    CHROMA_PIXEL_FORMAT_NV12 = 1,
+    CHROMA_PIXEL_FORMAT_R10G10B10A2 = 2,
+    CHROMA_PIXEL_FORMAT_RGBA16F = 3
+};
+
+// Frame description for Chroma_LocateStreamFrame. Planes are read in place and never
+// written.
+// - BGRA8: planes[0] only; the alpha byte is ignored (BGRx works). strideBytes[0] may be
+//   negative for bottom-up rows.
+// - NV12: planes[0] = Y, planes[1] = interleaved UV at half resolution. width and height
+//   must be even; both strides positive and at least width.
+// - R10G10B10A2: planes[0] only, one little-endian 32-bit word per pixel with R in bits
+//   0-9, G 10-19, B 20-29 (DXGI_FORMAT_R10G10B10A2_UNORM), same transfer as 8-bit input.
+//   strideBytes[0] positive, at least width*4 and a multiple of 4; planes[0] 4-byte
+//   aligned.
+// - RGBA16F: planes[0] only, four half floats per pixel in R, G, B, A order, linear
+//   scRGB (1.0 = SDR white; values above 1 are clipped). strideBytes[0] positive, at
+//   least width*8 and a multiple of 2; planes[0] 2-byte aligned.
+// Misaligned HDR planes or strides fail with CHROMA_STATUS_INVALID_ARGUMENT, both in
+// Chroma_LocateStreamFrame and in Chroma_PushStreamFrame.
+// HDR formats are classified from the source values: HSV is computed at float precision
+// and quantized once, and ColorMaskConfig ranges keep their 8-bit HSV scale.
+struct ChromaFrameV1 {
+    int32_t structSize;
+    int32_t pixelFormat;          // ChromaPixelFormat
+    int32_t width;
+    int32_t height;
+    const void* planes[2];
+    int32_t strideBytes[2];
+};
+
+enum ChromaHugePageMode : int32_t {
+    CHROMA_HUGE_PAGES_OFF = 0,
+    CHROMA_HUGE_PAGES_TRANSPARENT = 1,
+    CHROMA_HUGE_PAGES_EXPLICIT = 2
+};
+
+struct ChromaMemoryOptionsV1 {
+    int32_t structSize;
+    int32_t useArena;                 // 1 = pooled workspaces allocate through a size-classed arena
+    int32_t hugePageMode;             // ChromaHugePageMode, applies to frame-sized blocks
+    int32_t maxCachedMegabytesPerArena;
+};
+
+struct ChromaMemoryStatsV1 {
+    int32_t structSize;
+    int32_t idleWorkspaces;
+    int32_t liveArenas;
+    int32_t reserved0;
+    uint64_t allocations;
+    uint64_t reuseHits;
+    uint64_t systemAllocations;
+    uint64_t hugePageAllocations;
+    uint64_t hugePageFallbacks;
+    uint64_t bytesInUse;
+    uint64_t bytesCached;
+    uint64_t peakBytesInUse;          // sum of per-arena peaks
+    uint64_t peakBytesReserved;       // sum of per-arena peaks (in use + cached)
+};
+
 enum ChromaStatusCode : int32_t {
     CHROMA_STATUS_OK = 0,
     CHROMA_STATUS_INVALID_ARGUMENT = 1,
@@ -130,6 +192,82 @@ CHROMA_API int32_t CHROMA_CALL Chroma_LocateBitmapWithConfigBGRAW(
     wchar_t* outError,
     int32_t outErrorChars);
 
+// Color statistics of one accepted blob (its center-mask pixels inside the contour), in
+// the 8-bit HSV scale of the config ranges: H in [0,180), S and V in [0,255].
+#define CHROMA_BLOB_HUE_BINS 18
+struct ChromaBlobStatsV1 {
+    int32_t structSize;
+    int32_t pixelCount;
+    float meanHue;                    // circular mean
+    float meanSat;
+    float meanVal;
+    int32_t brightestX;               // pixel with the highest V, first in row order
+    int32_t brightestY;
+    int32_t brightestHue;
+    int32_t brightestSat;
+    int32_t brightestVal;
+    int32_t hueHistogram[CHROMA_BLOB_HUE_BINS];   // 10 hue units per bin
+};
+
+// Locate with per-blob color statistics, measured while the candidates are evaluated so
+// callers need no second pass over the pixels.
+// - config may be null to use the active config.
+// - outStats may be null; otherwise it has outCapacity entries, outStats[0].structSize
+//   is set by the caller, and outStats[i] describes outPoints[i].
+CHROMA_API int32_t CHROMA_CALL Chroma_LocateBitmapWithBlobStatsBGRAW(
+    const void* bgraPixels,
+    int32_t width,
+    int32_t height,
+    int32_t strideBytes,
+    const ChromaConfigV1* config,
+    ChromaPoint* outPoints,
+    ChromaBlobStatsV1* outStats,
+    int32_t outCapacity,
+    int32_t* outTotalFound,
+    int32_t* outWritten,
+    wchar_t* outError,
+    int32_t outErrorChars);
+
+// Nearest accepted target to a focus point (e.g. the cursor). Windows around the focus
+// are detected with growing size, each padded so its verdicts equal full-frame
+// detection, until no target outside the window can be closer; a target near the focus
+// is found without processing the whole frame.
+// - config may be null to use the active config.
+// - (focusX, focusY) must lie inside the frame. Ties go to the smaller y, then x.
+struct ChromaNearestResultV1 {
+    int32_t structSize;
+    int32_t found;
+    int32_t x;
+    int32_t y;
+    float distancePx;
+    int32_t rounds;                   // windows detected
+    float processedFraction;          // pixels detected over all rounds / frame pixels
+};
+
+CHROMA_API int32_t CHROMA_CALL Chroma_LocateNearestBGRAW(
+    const void* bgraPixels,
+    int32_t width,
+    int32_t height,
+    int32_t strideBytes,
+    const ChromaConfigV1* config,
+    int32_t focusX,
+    int32_t focusY,
+    ChromaNearestResultV1* outResult,
+    wchar_t* outError,
+    int32_t outErrorChars);
+
+// Locate on a ChromaFrameV1 of any ChromaPixelFormat (including the HDR formats), read
+// in place. `config` may be null to use the active config.
+CHROMA_API int32_t CHROMA_CALL Chroma_LocateFrame(
+    const ChromaFrameV1* frame,
+    const ChromaConfigV1* config,
+    ChromaPoint* outPoints,
+    int32_t outCapacity,
+    int32_t* outTotalFound,
+    int32_t* outWritten,
+    wchar_t* outError,
+    int32_t outErrorChars);
+
 // Debug-image variant:
 // - same detection outputs as Chroma_LocateBitmapBGRAW
 // - optionally writes a BGRA debug image (side-by-side overlay/mask) into outDebugImage
@@ -145,6 +283,39 @@ CHROMA_API int32_t CHROMA_CALL Chroma_LocateBitmapWithDebugBGRAW(
     ChromaDebugImageV1* outDebugImage,
     wchar_t* outError,
     int32_t outErrorChars);
+
+// Debug image shape for Chroma_LocateBitmapWithDebugOptionsBGRAW.
+// - panels: ChromaDebugPanels; BOTH places overlay and mask side by side.
+// - maxWidth/maxHeight bound the returned image (0 = unbounded); the aspect ratio is kept.
+//   Panels are rendered at the reduced size (scaled coordinates, configured label font
+//   size), so smaller outputs cost less to render and copy.
+enum ChromaDebugPanels : int32_t {
+    CHROMA_DEBUG_PANELS_OVERLAY = 1,
+    CHROMA_DEBUG_PANELS_MASK = 2,
+    CHROMA_DEBUG_PANELS_BOTH = 3
+};
+
+struct ChromaDebugOptionsV1 {
+    int32_t structSize;
+    int32_t panels;
+    int32_t maxWidth;
+    int32_t maxHeight;
+};
+
+// Same as Chroma_LocateBitmapWithDebugBGRAW; debugOptions may be null (both panels, full size).
+CHROMA_API int32_t CHROMA_CALL Chroma_LocateBitmapWithDebugOptionsBGRAW(
+    const void* bgraPixels,
+    int32_t width,
+    int32_t height,
+    int32_t strideBytes,
+    const ChromaDebugOptionsV1* debugOptions,
+    ChromaPoint* outPoints,
+    int32_t outCapacity,
+    int32_t* outTotalFound,
+    int32_t* outWritten,
+    ChromaDebugImageV1* outDebugImage,
+    wchar_t* outError,
+    int32_t outErrorChars);
 // Direct GDI bitmap input (HBITMAP).
 CHROMA_API int32_t CHROMA_CALL Chroma_LocateHBitmap(
     const void* hBitmap,
@@ -167,3 +338,556 @@ CHROMA_API int32_t CHROMA_CALL Chroma_LocateHWND(
     wchar_t* outError,
     int32_t outErrorChars);
 
+// Lifecycle helpers (process-wide).
+// - Chroma_Warmup pre-builds detection state (OpenCV dispatch, worker threads, pooled
+//   workspaces sized for the frame shape) using the active config, so the first real
+//   frame of that shape runs at steady-state latency. workspaceCount is the number of
+//   threads that will detect concurrently (0 means 1, at most 16); that many workspaces
+//   are held and sized together, so one call covers all of them.
+// - Chroma_TrimMemory releases pooled workspaces that are not currently in use.
+CHROMA_API int32_t CHROMA_CALL Chroma_Warmup(
+    int32_t width,
+    int32_t height,
+    int32_t pixelFormat,
+    int32_t workspaceCount,
+    wchar_t* outError,
+    int32_t outErrorChars);
+CHROMA_API int32_t CHROMA_CALL Chroma_TrimMemory(
+    wchar_t* outError,
+    int32_t outErrorChars);
+
+// Workspace memory control (process-wide).
+// - Chroma_SetMemoryOptions applies to workspaces created afterwards; idle pooled
+//   workspaces are dropped so the new options take effect on the next call.
+// - Chroma_GetMemoryStats aggregates arena statistics over all live workspaces.
+CHROMA_API int32_t CHROMA_CALL Chroma_GetMemoryOptions(
+    ChromaMemoryOptionsV1* outOptions,
+    wchar_t* outError,
+    int32_t outErrorChars);
+CHROMA_API int32_t CHROMA_CALL Chroma_SetMemoryOptions(
+    const ChromaMemoryOptionsV1* options,
+    wchar_t* outError,
+    int32_t outErrorChars);
+CHROMA_API int32_t CHROMA_CALL Chroma_GetMemoryStats(
+    ChromaMemoryStatsV1* outStats,
+    wchar_t* outError,
+    int32_t outErrorChars);
+
+// Per-stream detection state.
+// A stream owns its own workspace and an adaptive candidate cascade that reorders the
+// shape/context tests by observed rejection rate per unit cost. Accepted output is
+// identical to Chroma_LocateBitmapBGRAW. Calls on one stream are serialized; use one
+// stream per video source.
+typedef struct ChromaStream ChromaStream;
+
+enum ChromaCandidateTest : int32_t {
+    CHROMA_TEST_AREA = 0,
+    CHROMA_TEST_CIRCULARITY = 1,
+    CHROMA_TEST_CENTER_FILL = 2,
+    CHROMA_TEST_CONTEXT_RING = 3
+};
+
+#define CHROMA_CANDIDATE_TEST_COUNT 4
+
+struct ChromaCandidateTestStatsV1 {
+    uint64_t evaluated;
+    uint64_t rejected;
+    float rejectionRate;   // measured on exploration frames (all tests evaluated)
+    float meanCostNs;      // sampled on every 8th candidate
+};
+
+struct ChromaStreamStatsV1 {
+    int32_t structSize;
+    int32_t cascadeOrder[CHROMA_CANDIDATE_TEST_COUNT]; // ChromaCandidateTest values, first runs first
+    int32_t reserved0;
+    uint64_t frames;
+    uint64_t candidates;
+    uint64_t acceptedDetections;
+    uint64_t cascadeReorders;
+    ChromaCandidateTestStatsV1 tests[CHROMA_CANDIDATE_TEST_COUNT]; // indexed by ChromaCandidateTest
+};
+
+CHROMA_API int32_t CHROMA_CALL Chroma_CreateStream(
+    ChromaStream** outStream,
+    int32_t adaptiveCascade,
+    wchar_t* outError,
+    int32_t outErrorChars);
+CHROMA_API int32_t CHROMA_CALL Chroma_DestroyStream(
+    ChromaStream* stream);
+// Same contract as Chroma_LocateBitmapBGRAW, using the active config and the stream state.
+CHROMA_API int32_t CHROMA_CALL Chroma_LocateStreamBGRAW(
+    ChromaStream* stream,
+    const void* bgraPixels,
+    int32_t width,
+    int32_t height,
+    int32_t strideBytes,
+    ChromaPoint* outPoints,
+    int32_t outCapacity,
+    int32_t* outTotalFound,
+    int32_t* outWritten,
+    wchar_t* outError,
+    int32_t outErrorChars);
+// Same contract for a ChromaFrameV1 (any ChromaPixelFormat). NV12 frames are converted
+// into a stream-owned buffer, so a stable frame shape costs no per-call allocation.
+CHROMA_API int32_t CHROMA_CALL Chroma_LocateStreamFrame(
+    ChromaStream* stream,
+    const ChromaFrameV1* frame,
+    ChromaPoint* outPoints,
+    int32_t outCapacity,
+    int32_t* outTotalFound,
+    int32_t* outWritten,
+    wchar_t* outError,
+    int32_t outErrorChars);
+CHROMA_API int32_t CHROMA_CALL Chroma_GetStreamStats(
+    ChromaStream* stream,
+    ChromaStreamStatsV1* outStats,
+    wchar_t* outError,
+    int32_t outErrorChars);
+
+// Duplicate-tile classification for a stream (off by default). Each frame is split into
+// 16x16 tiles; every distinct tile is classified once and byte-identical tiles copy its
+// mask bits, so detections are unchanged. When a frame's hashing and copying cost more
+// than the classification they saved, the stream skips the mode for 32 frames and then
+// measures again.
+struct ChromaTileDedupStatsV1 {
+    int32_t structSize;
+    int32_t enabled;
+    int32_t lastFrameRan;             // 0 when the last frame skipped the mode
+    int32_t lastFrameTiles;
+    int32_t lastFrameDuplicateTiles;
+    float lastFrameHitRate;           // duplicate tiles / tiles
+    float lastFrameOverheadMs;        // hashing, matching and copying
+    float lastFrameSavedMs;           // estimated classification time saved
+    uint64_t framesRun;
+    uint64_t framesBypassed;          // enabled, but backing off
+    uint64_t tiles;
+    uint64_t duplicateTiles;
+    uint64_t backoffs;                // frames that turned the mode off
+};
+
+CHROMA_API int32_t CHROMA_CALL Chroma_SetStreamTileDedup(
+    ChromaStream* stream,
+    int32_t enabled,
+    wchar_t* outError,
+    int32_t outErrorChars);
+CHROMA_API int32_t CHROMA_CALL Chroma_GetStreamTileDedupStats(
+    ChromaStream* stream,
+    ChromaTileDedupStatsV1* outStats,
+    wchar_t* outError,
+    int32_t outErrorChars);
+
+// Cross-frame verdict cache for a stream (off by default). Each candidate inside the
+// area limits gets a signature from its box, area, center-mask bytes and the HSV bytes
+// of its context ring box; a candidate matching a signature from an earlier frame
+// reuses that verdict and metrics instead of being scored again, so static background
+// blobs are evaluated once. Results are unchanged. Entries not matched for 30 frames
+// are dropped; at most 4096 are kept.
+struct ChromaVerdictCacheStatsV1 {
+    int32_t structSize;
+    int32_t enabled;
+    int32_t entries;
+    int32_t lastFrameLookups;
+    int32_t lastFrameHits;
+    float lastFrameHitRate;           // hits / lookups
+    float hitRate;                    // cumulative
+    uint64_t frames;
+    uint64_t lookups;
+    uint64_t hits;
+    uint64_t inserts;
+    uint64_t evictions;
+};
+
+CHROMA_API int32_t CHROMA_CALL Chroma_SetStreamVerdictCache(
+    ChromaStream* stream,
+    int32_t enabled,
+    wchar_t* outError,
+    int32_t outErrorChars);
+CHROMA_API int32_t CHROMA_CALL Chroma_GetStreamVerdictCacheStats(
+    ChromaStream* stream,
+    ChromaVerdictCacheStatsV1* outStats,
+    wchar_t* outError,
+    int32_t outErrorChars);
+
+// Continuous mode (stream pump). The producer pushes frames with
+// Chroma_PushStreamFrame; each is copied into a stream-owned slot (slots are recycled,
+// so a stable frame shape costs no per-push allocation) and a worker thread detects
+// them in push order through the stream with the active config. When the worker falls
+// behind, the policy applies:
+// - LATEST: one waiting frame; a push replaces it and the replaced frame is dropped.
+// - FIFO: up to queueCapacity waiting frames; a push onto a full queue is dropped
+//   (*outQueued = 0).
+// - BLOCK: up to queueCapacity waiting frames; a push onto a full queue waits for room.
+// Results go to the optional callback (on the worker thread; points are valid for the
+// call only, and the callback must not stop the pump) and can be polled with
+// Chroma_GetStreamResult. Direct locate calls on the
+// stream still work and are serialized with the worker.
+enum ChromaBackpressurePolicy : int32_t {
+    CHROMA_BACKPRESSURE_LATEST = 0,
+    CHROMA_BACKPRESSURE_FIFO = 1,
+    CHROMA_BACKPRESSURE_BLOCK = 2
+};
+
+struct ChromaFrameResultV1 {
+    int32_t structSize;
+    int32_t status;                   // ChromaStatusCode of the detection
+    uint64_t frameId;                 // from Chroma_PushStreamFrame
+    uint64_t queueAgeUs;              // push to start of detection
+    uint64_t detectUs;
+    int32_t totalFound;
+    int32_t pointCount;               // points listed, at most 4096
+    const ChromaPoint* points;
+};
+
+typedef void (CHROMA_CALL* ChromaFrameResultCallback)(void* userData, const ChromaFrameResultV1* result);
+
+struct ChromaStreamPumpOptionsV1 {
+    int32_t structSize;
+    int32_t policy;                   // ChromaBackpressurePolicy
+    int32_t queueCapacity;            // FIFO / BLOCK: >= 1; ignored for LATEST
+    int32_t reserved0;
+    ChromaFrameResultCallback callback;   // may be null
+    void* userData;
+};
+
+struct ChromaStreamPumpStatsV1 {
+    int32_t structSize;
+    int32_t running;
+    int32_t policy;
+    int32_t queueDepth;               // frames waiting now
+    uint64_t framesPushed;
+    uint64_t framesProcessed;
+    uint64_t framesDropped;           // replaced (LATEST) or rejected (FIFO)
+    uint64_t producerBlocks;          // pushes that waited (BLOCK)
+    uint64_t producerWaitUs;          // total producer wait
+    uint64_t meanQueueAgeUs;
+    uint64_t maxQueueAgeUs;
+    uint64_t lastQueueAgeUs;
+    uint64_t lastDetectUs;
+};
+
+// Starting a pump on a stream that already runs one replaces it (queued frames are
+// discarded).
+CHROMA_API int32_t CHROMA_CALL Chroma_StartStreamPump(
+    ChromaStream* stream,
+    const ChromaStreamPumpOptionsV1* options,
+    wchar_t* outError,
+    int32_t outErrorChars);
+CHROMA_API int32_t CHROMA_CALL Chroma_PushStreamFrame(
+    ChromaStream* stream,
+    const ChromaFrameV1* frame,
+    uint64_t* outFrameId,
+    int32_t* outQueued,
+    wchar_t* outError,
+    int32_t outErrorChars);
+// Newest finished result; *outFrameId is 0 before the first one. The status is that of
+// the detection, or BUFFER_TOO_SMALL when outCapacity is below *outTotalFound. At most
+// 4096 points are kept per result. The result stays readable after
+// Chroma_StopStreamPump (including the frame that was in flight) until the next
+// Chroma_StartStreamPump.
+CHROMA_API int32_t CHROMA_CALL Chroma_GetStreamResult(
+    ChromaStream* stream,
+    uint64_t* outFrameId,
+    ChromaPoint* outPoints,
+    int32_t outCapacity,
+    int32_t* outTotalFound,
+    int32_t* outWritten,
+    wchar_t* outError,
+    int32_t outErrorChars);
+CHROMA_API int32_t CHROMA_CALL Chroma_GetStreamPumpStats(
+    ChromaStream* stream,
+    ChromaStreamPumpStatsV1* outStats,
+    wchar_t* outError,
+    int32_t outErrorChars);
+// Discards waiting frames, releases blocked producers and waits for the frame in
+// flight. Chroma_DestroyStream stops the pump as well.
+CHROMA_API int32_t CHROMA_CALL Chroma_StopStreamPump(
+    ChromaStream* stream,
+    wchar_t* outError,
+    int32_t outErrorChars);
+
+// Region map: frame rectangles, each detected with its own config in one pass.
+// - regions must not overlap; configs are copied and validated at creation.
+// - rectangles are clipped to each frame; pixels outside every region are ignored.
+// - a region's detections match cropping it and calling Chroma_LocateBitmapWithConfigBGRAW
+//   (contours and context rings stop at the region border), in frame coordinates.
+// - a map is immutable and may be used by concurrent calls.
+typedef struct ChromaRegionMap ChromaRegionMap;
+
+struct ChromaRegionV1 {
+    int32_t structSize;
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+    const ChromaConfigV1* config;
+};
+
+CHROMA_API int32_t CHROMA_CALL Chroma_CreateRegionMap(
+    const ChromaRegionV1* regions,
+    int32_t regionCount,
+    ChromaRegionMap** outMap,
+    wchar_t* outError,
+    int32_t outErrorChars);
+CHROMA_API int32_t CHROMA_CALL Chroma_DestroyRegionMap(
+    ChromaRegionMap* map);
+// Same contract as Chroma_LocateBitmapBGRAW; accepted centers of all regions are ranked
+// together by score. outRegionIndices (optional, outCapacity entries) receives the index
+// of the region each written point belongs to.
+CHROMA_API int32_t CHROMA_CALL Chroma_LocateRegionsBGRAW(
+    const ChromaRegionMap* map,
+    const void* bgraPixels,
+    int32_t width,
+    int32_t height,
+    int32_t strideBytes,
+    ChromaPoint* outPoints,
+    int32_t outCapacity,
+    int32_t* outTotalFound,
+    int32_t* outWritten,
+    int32_t* outRegionIndices,
+    wchar_t* outError,
+    int32_t outErrorChars);
+
+// Shadow evaluation of a candidate config (process-wide).
+// Every sampleIntervalFrames-th detection that uses the active config is copied into a
+// bounded queue (frames are dropped when queueCapacity is reached) and re-run with the
+// shadow config on a low-priority background worker. The primary call's results and
+// latency are unaffected beyond the copy of sampled frames. Accepted centers within
+// matchRadiusPx are considered the same detection. Starting resets the statistics.
+enum ChromaPipelineStage : int32_t {
+    CHROMA_STAGE_CONVERT = 0,
+    CHROMA_STAGE_CLASSIFY_CENTER = 1,
+    CHROMA_STAGE_MORPHOLOGY = 2,
+    CHROMA_STAGE_CLASSIFY_CONTEXT = 3,
+    CHROMA_STAGE_CONTOURS = 4,
+    CHROMA_STAGE_CANDIDATES = 5,
+    CHROMA_STAGE_DEBUG_RENDER = 6,
+    CHROMA_STAGE_TOTAL = 7
+};
+
+#define CHROMA_PIPELINE_STAGE_COUNT 8
+
+struct ChromaShadowOptionsV1 {
+    int32_t structSize;
+    int32_t sampleIntervalFrames;
+    int32_t queueCapacity;
+    int32_t matchRadiusPx;
+};
+
+struct ChromaShadowStatsV1 {
+    int32_t structSize;
+    int32_t running;
+    uint64_t framesSampled;
+    uint64_t framesEvaluated;
+    uint64_t framesDropped;      // sampled while the queue was full
+    uint64_t framesFailed;       // shadow detection threw
+    uint64_t framesDiverged;     // at least one added or lost detection
+    uint64_t primaryDetections;
+    uint64_t shadowDetections;
+    uint64_t addedDetections;    // accepted by shadow only
+    uint64_t lostDetections;     // accepted by primary only
+    float meanPrimaryStageMs[CHROMA_PIPELINE_STAGE_COUNT]; // indexed by ChromaPipelineStage
+    float meanShadowStageMs[CHROMA_PIPELINE_STAGE_COUNT];
+};
+
+CHROMA_API int32_t CHROMA_CALL Chroma_StartShadowConfig(
+    const ChromaConfigV1* config,
+    const ChromaShadowOptionsV1* options,
+    wchar_t* outError,
+    int32_t outErrorChars);
+// Must be called before unloading the library while a shadow config is running.
+CHROMA_API int32_t CHROMA_CALL Chroma_StopShadowConfig(
+    wchar_t* outError,
+    int32_t outErrorChars);
+CHROMA_API int32_t CHROMA_CALL Chroma_GetShadowStats(
+    ChromaShadowStatsV1* outStats,
+    wchar_t* outError,
+    int32_t outErrorChars);
+
+// Slow-frame sentinel (process-wide).
+// Any detection whose pipeline time exceeds latencyThresholdUs, or whose raw candidate
+// count exceeds candidateThreshold, is captured: the frame (PNG), the config, plan,
+// per-stage timings and counters (text) are written as chroma-slow-<unixms>-<n>.png/.txt
+// into spoolDirectory by a low-priority background thread. Captures wait in a queue of
+// queueCapacity entries; when it is full, or within minIntervalMs of the last capture,
+// the frame is skipped. The oldest captures in the directory are deleted beyond
+// maxSpoolCaptures or maxSpoolMegabytes (0 = no size limit). Frames below both
+// thresholds only pay the comparisons. Starting resets the statistics.
+struct ChromaSentinelOptionsV1 {
+    int32_t structSize;
+    int32_t latencyThresholdUs;       // <= 0 disables the latency trigger
+    int32_t candidateThreshold;       // <= 0 disables the candidate trigger
+    int32_t queueCapacity;
+    int32_t maxSpoolCaptures;
+    int32_t maxSpoolMegabytes;
+    int32_t minIntervalMs;
+    const wchar_t* spoolDirectory;    // created if missing
+};
+
+struct ChromaSentinelStatsV1 {
+    int32_t structSize;
+    int32_t running;
+    uint64_t latencyTriggers;         // detections over latencyThresholdUs
+    uint64_t candidateTriggers;       // detections over candidateThreshold
+    uint64_t framesCaptured;          // written to the spool
+    uint64_t framesSkipped;           // triggered while the queue was full or within minIntervalMs
+    uint64_t writeFailures;
+    uint64_t capturesEvicted;         // deleted to stay within the spool limits
+    uint64_t spoolCaptures;           // captures currently in spoolDirectory
+    uint64_t spoolBytes;
+};
+
+CHROMA_API int32_t CHROMA_CALL Chroma_StartSentinel(
+    const ChromaSentinelOptionsV1* options,
+    wchar_t* outError,
+    int32_t outErrorChars);
+// Writes the captures still queued, then stops. Must be called before unloading the
+// library while the sentinel is running.
+CHROMA_API int32_t CHROMA_CALL Chroma_StopSentinel(
+    wchar_t* outError,
+    int32_t outErrorChars);
+CHROMA_API int32_t CHROMA_CALL Chroma_GetSentinelStats(
+    ChromaSentinelStatsV1* outStats,
+    wchar_t* outError,
+    int32_t outErrorChars);
+
+// File-backed active config (process-wide).
+// The file holds "name = value" lines named after the ChromaConfigV1 fields, e.g.
+//   centerHueRanges = 16-32, 170-5
+//   centerSatRange = 50-125
+//   minCircularity = 0.75
+// '#' starts a comment line; fields that are not listed keep their default value.
+// Chroma_StartConfigWatch loads the file once (a parse or validation error fails the
+// call) and then reloads it whenever it changes (inotify on Linux, mtime polling every
+// pollIntervalMs elsewhere). Each reload is parsed, validated and, with a warmup size,
+// run once on a synthetic frame on the watcher thread before it replaces the active
+// config, so detection calls never wait for it. A rejected file keeps the previous
+// config; the error is reported in ChromaConfigWatchStatsV1. Chroma_SetActiveConfig
+// still works and is overwritten by the next file change.
+#define CHROMA_CONFIG_WATCH_ERROR_CHARS 256
+
+struct ChromaConfigWatchOptionsV1 {
+    int32_t structSize;
+    int32_t pollIntervalMs;           // stop latency on Linux, change-detection interval elsewhere
+    int32_t warmupWidth;              // 0 with warmupHeight = 0: no warmup detection
+    int32_t warmupHeight;
+    const wchar_t* path;
+};
+
+struct ChromaConfigWatchStatsV1 {
+    int32_t structSize;
+    int32_t running;
+    uint64_t reloads;                 // file versions applied, including the initial load
+    uint64_t rejected;                // file versions that failed to load, parse or validate
+    uint64_t lastLoadUs;              // read + parse + validate + warmup of the last applied version
+    wchar_t lastError[CHROMA_CONFIG_WATCH_ERROR_CHARS];   // empty after a successful reload
+};
+
+CHROMA_API int32_t CHROMA_CALL Chroma_StartConfigWatch(
+    const ChromaConfigWatchOptionsV1* options,
+    wchar_t* outError,
+    int32_t outErrorChars);
+// Must be called before unloading the library while a watch is running.
+CHROMA_API int32_t CHROMA_CALL Chroma_StopConfigWatch(
+    wchar_t* outError,
+    int32_t outErrorChars);
+CHROMA_API int32_t CHROMA_CALL Chroma_GetConfigWatchStats(
+    ChromaConfigWatchStatsV1* outStats,
+    wchar_t* outError,
+    int32_t outErrorChars);
+
+// Process-wide runtime counters (for load and contention testing).
+// configLock* cover every read/write of the active config.
+struct ChromaRuntimeStatsV1 {
+    int32_t structSize;
+    int32_t reserved0;
+    uint64_t configLockAcquisitions;
+    uint64_t configLockContended;   // acquisitions that had to wait
+    uint64_t configLockWaitNs;      // total wait time of contended acquisitions
+    uint64_t configLockHoldNs;      // total time the lock was held
+};
+
+CHROMA_API int32_t CHROMA_CALL Chroma_GetRuntimeStats(
+    ChromaRuntimeStatsV1* outStats,
+    wchar_t* outError,
+    int32_t outErrorChars);
+CHROMA_API int32_t CHROMA_CALL Chroma_ResetRuntimeStats();
+
+// Color coverage per grid cell, without contour or candidate extraction.
+// - config may be null to use the active config.
+// - the frame is split into gridCols x gridRows cells; cell (c, r) spans columns
+//   [c*width/gridCols, (c+1)*width/gridCols) and the same for rows. 1 <= gridCols <= width,
+//   1 <= gridRows <= height.
+// - applyMorphology: 1 = center coverage is measured after the config's open/close/dilate.
+// - outCells receives gridCols*gridRows cells, row-major; outCellCapacity must cover them.
+// - support/exclude use the context colors even when requireContextRing is 0; exclude is 0
+//   without exclude hue ranges.
+struct ChromaCoverageCell {
+    float center;     // fraction of the cell's pixels matching the center color
+    float support;    // ... the context support color
+    float exclude;    // ... the context exclude hues
+};
+
+CHROMA_API int32_t CHROMA_CALL Chroma_MeasureCoverageGrid(
+    const void* bgraPixels,
+    int32_t width,
+    int32_t height,
+    int32_t strideBytes,
+    const ChromaConfigV1* config,
+    int32_t gridCols,
+    int32_t gridRows,
+    int32_t applyMorphology,
+    ChromaCoverageCell* outCells,
+    int32_t outCellCapacity,
+    wchar_t* outError,
+    int32_t outErrorChars);
+
+// Pipeline plan for a config: the kernel chosen for each stage and why.
+// - config may be null to explain the active config.
+// - renderDebug: 1 = plan used by Chroma_LocateBitmapWithDebugBGRAW, 0 = other locate calls.
+// - outText receives NUL-terminated text, one line per stage.
+// - outRequiredChars receives the required size in wchar_t, including the terminator (optional).
+// - returns CHROMA_STATUS_BUFFER_TOO_SMALL without writing when outTextChars is too small.
+CHROMA_API int32_t CHROMA_CALL Chroma_ExplainConfig(
+    const ChromaConfigV1* config,
+    int32_t renderDebug,
+    wchar_t* outText,
+    int32_t outTextChars,
+    int32_t* outRequiredChars,
+    wchar_t* outError,
+    int32_t outErrorChars);
+
+// Predicted cost of a locate call, for admission control and cost-based scheduling.
+// The model times each pipeline stage as a coefficient times the work the compiled
+// plan implies (pixels, inRange passes, morphology iterations, classified context
+// pixels, candidates) plus a per-call overhead, and recalibrates the coefficients from
+// the stage timings of every locate call in the process.
+// - stream may be null; with a stream, candidates and context coverage follow that
+//   stream's recent frames, otherwise the recent mean over all calls.
+// - pixelFormat is a ChromaPixelFormat; config may be null to use the active config.
+// - calibrated is 0 until every term the plan uses has been measured; until then the
+//   estimate uses rough built-in priors.
+// - modelError is the recent mean of |measured - predicted| / measured, with each call
+//   predicted from its own candidate count and coverage.
+// - debug rendering is not included.
+struct ChromaCostEstimateV1 {
+    int32_t structSize;
+    int32_t calibrated;
+    float totalUs;
+    float stageUs[CHROMA_PIPELINE_STAGE_COUNT];  // indexed by ChromaPipelineStage
+    float expectedCandidates;
+    float expectedContextCoverage;               // fraction of the frame classified for rings
+    float modelError;
+    uint64_t samples;                            // calls observed since the last reset
+};
+
+CHROMA_API int32_t CHROMA_CALL Chroma_EstimateCost(
+    ChromaStream* stream,
+    int32_t width,
+    int32_t height,
+    int32_t pixelFormat,
+    const ChromaConfigV1* config,
+    ChromaCostEstimateV1* outEstimate,
+    wchar_t* outError,
+    int32_t outErrorChars);
+// Drops the calibration and returns to the built-in priors.
+CHROMA_API int32_t CHROMA_CALL Chroma_ResetCostModel();
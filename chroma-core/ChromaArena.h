@@ -0,0 +1,266 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace vision {
+
+enum class HugePageMode {
+    Off = 0,          // regular pages for every block
+    Transparent = 1,  // page-backed large blocks are advised for THP (Linux only)
+    Explicit = 2      // large blocks try MAP_HUGETLB / MEM_LARGE_PAGES, then fall back
+};
+
+struct ArenaConfig {
+    size_t minBlockBytes = 4096;              // smallest size class
+    size_t largeBlockBytes = 2U << 20;        // blocks at least this big are page-backed
+    size_t maxCachedBytes = 256U << 20;       // idle bytes kept for reuse before returning to the OS
+    HugePageMode hugePages = HugePageMode::Off;
+};
+
+struct ArenaStats {
+    uint64_t allocations = 0;         // arena-owned blocks handed out
+    uint64_t reuseHits = 0;           // served from an idle block of the same size class
+    uint64_t systemAllocations = 0;   // had to go to the OS / heap
+    uint64_t hugePageAllocations = 0; // system allocations that got huge pages
+    uint64_t hugePageFallbacks = 0;   // explicit huge page requests that fell back
+    size_t bytesInUse = 0;
+    size_t peakBytesInUse = 0;
+    size_t bytesCached = 0;
+    size_t peakBytesReserved = 0;     // in use + cached
+};
+
+// Size-classed cv::MatAllocator. Freed blocks are kept on per-class free lists and
+// handed back to later Mats of the same class, so a detector that re-creates its
+// frame-sized buffers stops page-faulting after the first frame. Small classes are
+// powers of two; large ("frame-sized") classes are rounded to 2 MiB and come
+// straight from the page allocator, optionally huge-page backed.
+//
+// Install it on the Mats that should use it (mat.allocator = &arena) before they
+// are allocated. The arena must outlive every Mat allocated from it.
+class ArenaMatAllocator : public cv::MatAllocator {
+public:
+    explicit ArenaMatAllocator(ArenaConfig config = {}) : config_(config) {
+        config_.minBlockBytes = std::max<size_t>(64, config_.minBlockBytes);
+        config_.largeBlockBytes = std::max(config_.largeBlockBytes, config_.minBlockBytes);
+    }
+
+    ~ArenaMatAllocator() override {
+        Trim();
+    }
+
+    ArenaMatAllocator(const ArenaMatAllocator&) = delete;
+    ArenaMatAllocator& operator=(const ArenaMatAllocator&) = delete;
+
+    cv::UMatData* allocate(
+        int dims,
+        const int* sizes,
+        int type,
+        void* data0,
+        size_t* step,
+        cv::AccessFlag /*flags*/,
+        cv::UMatUsageFlags /*usageFlags*/) const override {
+        size_t total = CV_ELEM_SIZE(type);
+        for (int i = dims - 1; i >= 0; --i) {
+            if (step != nullptr) {
+                if (data0 != nullptr && step[i] != CV_AUTOSTEP) {
+                    total = step[i];
+                } else {
+                    step[i] = total;
+                }
+            }
+            total *= static_cast<size_t>(sizes[i]);
+        }
+
+        cv::UMatData* u = new cv::UMatData(this);
+        if (data0 != nullptr) {
+            u->data = u->origdata = static_cast<uchar*>(data0);
+            u->flags |= cv::UMatData::USER_ALLOCATED;
+        } else {
+            u->data = u->origdata = static_cast<uchar*>(AcquireBlock(total));
+        }
+        u->size = total;
+        return u;
+    }
+
+    bool allocate(cv::UMatData* u, cv::AccessFlag /*flags*/, cv::UMatUsageFlags /*usageFlags*/) const override {
+        return u != nullptr;
+    }
+
+    void deallocate(cv::UMatData* u) const override {
+        if (u == nullptr) {
+            return;
+        }
+        if ((u->flags & cv::UMatData::USER_ALLOCATED) == 0 && u->origdata != nullptr) {
+            ReleaseBlock(u->origdata, u->size);
+            u->origdata = nullptr;
+        }
+        delete u;
+    }
+
+    // Returns every idle block to the system. Blocks still owned by Mats are untouched.
+    void Trim() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& entry : freeLists_) {
+            for (void* block : entry.second) {
+                SystemFree(block, entry.first);
+            }
+        }
+        freeLists_.clear();
+        stats_.bytesCached = 0;
+    }
+
+    ArenaStats Stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+    const ArenaConfig& Config() const {
+        return config_;
+    }
+
+private:
+    static constexpr size_t kLargeGranularity = 2U << 20;
+
+    size_t ClassSize(size_t bytes) const {
+        if (bytes >= config_.largeBlockBytes) {
+            return ((bytes + kLargeGranularity - 1) / kLargeGranularity) * kLargeGranularity;
+        }
+        size_t cls = config_.minBlockBytes;
+        while (cls < bytes) {
+            cls <<= 1;
+        }
+        return cls;
+    }
+
+    void* AcquireBlock(size_t bytes) const {
+        const size_t cls = ClassSize(std::max<size_t>(1, bytes));
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.allocations += 1;
+            auto it = freeLists_.find(cls);
+            if (it != freeLists_.end() && !it->second.empty()) {
+                void* block = it->second.back();
+                it->second.pop_back();
+                stats_.reuseHits += 1;
+                stats_.bytesCached -= cls;
+                stats_.bytesInUse += cls;
+                stats_.peakBytesInUse = std::max(stats_.peakBytesInUse, stats_.bytesInUse);
+                return block;
+            }
+        }
+
+        bool huge = false;
+        bool fellBack = false;
+        void* block = SystemAlloc(cls, huge, fellBack);
+        if (block == nullptr) {
+            // Drop idle blocks and retry once before reporting out-of-memory.
+            Trim();
+            block = SystemAlloc(cls, huge, fellBack);
+            if (block == nullptr) {
+                throw std::bad_alloc();
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.systemAllocations += 1;
+        stats_.hugePageAllocations += huge ? 1 : 0;
+        stats_.hugePageFallbacks += fellBack ? 1 : 0;
+        stats_.bytesInUse += cls;
+        stats_.peakBytesInUse = std::max(stats_.peakBytesInUse, stats_.bytesInUse);
+        stats_.peakBytesReserved = std::max(stats_.peakBytesReserved, stats_.bytesInUse + stats_.bytesCached);
+        return block;
+    }
+
+    void ReleaseBlock(void* block, size_t bytes) const {
+        const size_t cls = ClassSize(std::max<size_t>(1, bytes));
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.bytesInUse -= cls;
+            if (stats_.bytesCached + cls <= config_.maxCachedBytes) {
+                freeLists_[cls].push_back(block);
+                stats_.bytesCached += cls;
+                return;
+            }
+        }
+        SystemFree(block, cls);
+    }
+
+    void* SystemAlloc(size_t cls, bool& huge, bool& fellBack) const {
+        huge = false;
+        fellBack = false;
+        if (cls < config_.largeBlockBytes) {
+            return cv::fastMalloc(cls);
+        }
+#ifdef _WIN32
+        if (config_.hugePages == HugePageMode::Explicit) {
+            const SIZE_T largePage = GetLargePageMinimum();
+            if (largePage != 0 && cls % largePage == 0) {
+                void* p = VirtualAlloc(nullptr, cls, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+                if (p != nullptr) {
+                    huge = true;
+                    return p;
+                }
+            }
+            fellBack = true;
+        }
+        return VirtualAlloc(nullptr, cls, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+#ifdef MAP_HUGETLB
+        if (config_.hugePages == HugePageMode::Explicit) {
+            void* p = mmap(nullptr, cls, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED) {
+                huge = true;
+                return p;
+            }
+            fellBack = true;
+        }
+#endif
+        void* p = mmap(nullptr, cls, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            return nullptr;
+        }
+#ifdef MADV_HUGEPAGE
+        if (config_.hugePages == HugePageMode::Transparent && madvise(p, cls, MADV_HUGEPAGE) == 0) {
+            huge = true;
+        }
+#endif
+        return p;
+#endif
+    }
+
+    void SystemFree(void* block, size_t cls) const {
+        if (cls < config_.largeBlockBytes) {
+            cv::fastFree(block);
+            return;
+        }
+#ifdef _WIN32
+        VirtualFree(block, 0, MEM_RELEASE);
+#else
+        munmap(block, cls);
+#endif
+    }
+
+    ArenaConfig config_;
+    mutable std::mutex mutex_;
+    mutable std::map<size_t, std::vector<void*>> freeLists_;
+    mutable ArenaStats stats_;
+};
+
+}
@@ -2,12 +2,23 @@
 #include "ChromaApi.h"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <cstdio>
 #include <cwchar>
+#include <deque>
 #include <exception>
+#include <filesystem>
+#include <fstream>
 #include <limits>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 #include <cstring>
 
@@ -16,6 +27,12 @@
 #define NOMINMAX
 #endif
 #include <windows.h>
+#elif defined(__linux__)
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/inotify.h>
+#include <unistd.h>
 #endif
 
 namespace {
@@ -91,17 +108,188 @@ vision::ColorPatternConfig BuildDefaultPatternConfig() {
     return cfg;
 }
 
+// The active config and its CompileConfig plan (kernels and class LUT), compiled
+// once when the config is set. Calls on the active config only apply their hints.
+struct ActiveConfig {
+    vision::ColorPatternConfig config;
+    vision::PipelinePlan plan;
+};
+
+std::shared_ptr<const ActiveConfig> MakeActiveConfig(const vision::ColorPatternConfig& cfg) {
+    return std::make_shared<const ActiveConfig>(ActiveConfig{ cfg, vision::ColorPatternFinder::CompileConfig(cfg) });
+}
+
+// The active config is an immutable snapshot; readers take the lock only to copy the
+// pointer, and a new snapshot (plan included) is built before the lock is taken to
+// swap it in.
 std::mutex g_cfgMutex;
-vision::ColorPatternConfig g_activeConfig = BuildDefaultPatternConfig();
+std::shared_ptr<const ActiveConfig> g_activeConfig = MakeActiveConfig(BuildDefaultPatternConfig());
 
-vision::ColorPatternConfig GetActiveConfigCopy() {
-    std::lock_guard<std::mutex> lock(g_cfgMutex);
+// Config-lock instrumentation reported by Chroma_GetRuntimeStats. An uncontended
+// acquisition costs one try_lock; only contended acquisitions read the clock for
+// wait time. Hold time is measured on every acquisition.
+std::atomic<uint64_t> g_cfgLockAcquisitions{ 0 };
+std::atomic<uint64_t> g_cfgLockContended{ 0 };
+std::atomic<uint64_t> g_cfgLockWaitNs{ 0 };
+std::atomic<uint64_t> g_cfgLockHoldNs{ 0 };
+
+uint64_t ElapsedNs(const std::chrono::steady_clock::time_point since) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - since).count());
+}
+
+class ConfigLock {
+public:
+    ConfigLock() : lock_(g_cfgMutex, std::try_to_lock) {
+        g_cfgLockAcquisitions.fetch_add(1, std::memory_order_relaxed);
+        if (!lock_.owns_lock()) {
+            const auto waitStart = std::chrono::steady_clock::now();
+            lock_.lock();
+            g_cfgLockContended.fetch_add(1, std::memory_order_relaxed);
+            g_cfgLockWaitNs.fetch_add(ElapsedNs(waitStart), std::memory_order_relaxed);
+        }
+        acquired_ = std::chrono::steady_clock::now();
+    }
+
+    ~ConfigLock() {
+        g_cfgLockHoldNs.fetch_add(ElapsedNs(acquired_), std::memory_order_relaxed);
+    }
+
+    ConfigLock(const ConfigLock&) = delete;
+    ConfigLock& operator=(const ConfigLock&) = delete;
+
+private:
+    std::unique_lock<std::mutex> lock_;
+    std::chrono::steady_clock::time_point acquired_;
+};
+
+std::shared_ptr<const ActiveConfig> GetActiveConfig() {
+    ConfigLock lock;
     return g_activeConfig;
 }
 
+vision::ColorPatternConfig GetActiveConfigCopy() {
+    return GetActiveConfig()->config;
+}
+
+void SetActiveConfig(std::shared_ptr<const ActiveConfig> next) {
+    ConfigLock lock;
+    g_activeConfig.swap(next);
+}
+
 void SetActiveConfig(const vision::ColorPatternConfig& cfg) {
-    std::lock_guard<std::mutex> lock(g_cfgMutex);
-    g_activeConfig = cfg;
+    SetActiveConfig(MakeActiveConfig(cfg));
+}
+
+// Detection workspaces are pooled process-wide so repeated calls on same-sized
+// frames reuse their buffers. Workspaces are handed out exclusively and returned
+// when the call completes; the pool keeps at most kMaxPooledWorkspaces idle ones.
+constexpr size_t kMaxPooledWorkspaces = 16;
+
+std::mutex g_workspaceMutex;
+std::vector<std::unique_ptr<vision::DetectionWorkspace>> g_workspacePool;
+
+// Each pooled workspace owns its own arena; the registry only observes them for
+// Chroma_GetMemoryStats. Guarded by g_workspaceMutex.
+std::vector<std::weak_ptr<vision::ArenaMatAllocator>> g_arenaRegistry;
+ChromaMemoryOptionsV1 g_memoryOptions{
+    static_cast<int32_t>(sizeof(ChromaMemoryOptionsV1)), 1, CHROMA_HUGE_PAGES_OFF, 256 };
+
+void PruneArenaRegistryLocked() {
+    g_arenaRegistry.erase(
+        std::remove_if(g_arenaRegistry.begin(), g_arenaRegistry.end(),
+            [](const std::weak_ptr<vision::ArenaMatAllocator>& a) { return a.expired(); }),
+        g_arenaRegistry.end());
+}
+
+std::unique_ptr<vision::DetectionWorkspace> CreateWorkspace() {
+    auto workspace = std::make_unique<vision::DetectionWorkspace>();
+    std::lock_guard<std::mutex> lock(g_workspaceMutex);
+    PruneArenaRegistryLocked();
+    if (g_memoryOptions.useArena != 0) {
+        vision::ArenaConfig arenaCfg;
+        arenaCfg.hugePages = static_cast<vision::HugePageMode>(g_memoryOptions.hugePageMode);
+        arenaCfg.maxCachedBytes = static_cast<size_t>(g_memoryOptions.maxCachedMegabytesPerArena) << 20;
+        auto arena = std::make_shared<vision::ArenaMatAllocator>(arenaCfg);
+        g_arenaRegistry.push_back(arena);
+        workspace->UseArena(std::move(arena));
+    }
+    return workspace;
+}
+
+class PooledWorkspace {
+public:
+    PooledWorkspace() {
+        {
+            std::lock_guard<std::mutex> lock(g_workspaceMutex);
+            if (!g_workspacePool.empty()) {
+                workspace_ = std::move(g_workspacePool.back());
+                g_workspacePool.pop_back();
+            }
+        }
+        if (!workspace_) {
+            workspace_ = CreateWorkspace();
+        }
+    }
+
+    ~PooledWorkspace() {
+        std::lock_guard<std::mutex> lock(g_workspaceMutex);
+        if (g_workspacePool.size() < kMaxPooledWorkspaces) {
+            g_workspacePool.push_back(std::move(workspace_));
+        }
+    }
+
+    PooledWorkspace(const PooledWorkspace&) = delete;
+    PooledWorkspace& operator=(const PooledWorkspace&) = delete;
+
+    vision::DetectionWorkspace& Get() {
+        return *workspace_;
+    }
+
+private:
+    std::unique_ptr<vision::DetectionWorkspace> workspace_;
+};
+
+void TrimWorkspacePool() {
+    std::vector<std::unique_ptr<vision::DetectionWorkspace>> released;
+    {
+        std::lock_guard<std::mutex> lock(g_workspaceMutex);
+        released.swap(g_workspacePool);
+    }
+    released.clear();
+
+    std::lock_guard<std::mutex> lock(g_workspaceMutex);
+    PruneArenaRegistryLocked();
+}
+
+// Synthetic frame for warm-up: a neutral background with a grid of discs painted in
+// the center color, so contour extraction and ring scoring run as well.
+cv::Mat BuildWarmupFrame(const int width, const int height, const vision::ColorPatternConfig& cfg) {
+    cv::Mat frame(height, width, CV_8UC4, cv::Scalar(96, 96, 96, 255));
+
+    const std::vector<vision::HueRange>& hues = cfg.centerColor.hues.Ranges();
+    if (hues.empty()) {
+        return frame;
+    }
+    const vision::HueRange& h = hues.front();
+    const int hue = (h.minHue <= h.maxHue) ? (h.minHue + h.maxHue) / 2 : h.minHue;
+    const int sat = (cfg.centerColor.satRange.minValue + cfg.centerColor.satRange.maxValue) / 2;
+    const int val = (cfg.centerColor.valRange.minValue + cfg.centerColor.valRange.maxValue) / 2;
+    cv::Mat hsvPixel(1, 1, CV_8UC3, cv::Scalar(hue, sat, val));
+    cv::Mat bgrPixel;
+    cv::cvtColor(hsvPixel, bgrPixel, cv::COLOR_HSV2BGR);
+    const cv::Vec3b bgr = bgrPixel.at<cv::Vec3b>(0, 0);
+    const cv::Scalar discColor(bgr[0], bgr[1], bgr[2], 255);
+
+    const float meanArea = 0.5F * static_cast<float>(cfg.shape.minArea + cfg.shape.maxArea);
+    const int radius = std::max(2, static_cast<int>(std::lround(std::sqrt(meanArea / static_cast<float>(CV_PI)))));
+    const int spacing = radius * 8;
+    for (int y = spacing / 2; y < height; y += spacing) {
+        for (int x = spacing / 2; x < width; x += spacing) {
+            cv::circle(frame, cv::Point(x, y), radius, discColor, cv::FILLED);
+        }
+    }
+    return frame;
 }
 
 bool ValidateChannelRange(
@@ -291,9 +479,1024 @@ int32_t BuildConfigFromPointer(
     return CHROMA_STATUS_OK;
 }
 
+void LowerCurrentThreadPriority() {
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#elif defined(__linux__)
+    sched_param param{};
+    pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+#endif
+}
+
+struct ShadowTotals {
+    uint64_t framesSampled = 0;
+    uint64_t framesEvaluated = 0;
+    uint64_t framesDropped = 0;
+    uint64_t framesFailed = 0;
+    uint64_t framesDiverged = 0;
+    uint64_t primaryDetections = 0;
+    uint64_t shadowDetections = 0;
+    uint64_t addedDetections = 0;
+    uint64_t lostDetections = 0;
+    vision::PipelineTimings primaryMsSum;
+    vision::PipelineTimings shadowMsSum;
+};
+
+// Runs a candidate config on a sample of active-config frames. Sampled frames are
+// copied into a bounded queue (dropped when full) and re-detected on a low-priority
+// worker, which compares accepted centers and stage timings with the primary run.
+// The primary call only pays for the sampling check and, when sampled, the copy.
+class ShadowEvaluator {
+public:
+    ~ShadowEvaluator() {
+#ifdef _WIN32
+        // Joining from DLL_PROCESS_DETACH can deadlock on the loader lock; callers
+        // that unload the DLL must call Chroma_StopShadowConfig first.
+        if (worker_.joinable()) {
+            worker_.detach();
+        }
+#else
+        Stop();
+#endif
+    }
+
+    void Start(vision::ColorPatternConfig cfg, const int sampleInterval, const int queueCapacity, const int matchRadiusPx) {
+        std::lock_guard<std::mutex> control(controlMutex_);
+        StopLocked();
+        vision::PlanHints hints;
+        hints.renderDebug = false;
+        finder_ = std::make_unique<vision::ColorPatternFinder>(std::move(cfg), hints);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            totals_ = {};
+            stopping_ = false;
+            capacity_ = static_cast<size_t>(queueCapacity);
+            matchRadiusPx_ = matchRadiusPx;
+        }
+        sampleInterval_.store(static_cast<uint64_t>(sampleInterval));
+        frameCounter_.store(0);
+        worker_ = std::thread(&ShadowEvaluator::Run, this);
+        enabled_.store(true);
+    }
+
+    void Stop() {
+        std::lock_guard<std::mutex> control(controlMutex_);
+        StopLocked();
+    }
+
+    void Submit(const cv::Mat& scene, const vision::ColorPatternRunResult& primary) {
+        if (!enabled_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        const uint64_t n = frameCounter_.fetch_add(1, std::memory_order_relaxed);
+        if (n % std::max<uint64_t>(1, sampleInterval_.load(std::memory_order_relaxed)) != 0) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) {
+                return;
+            }
+            totals_.framesSampled += 1;
+            if (queue_.size() + copying_ >= capacity_) {
+                totals_.framesDropped += 1;
+                return;
+            }
+            // Holds the slot while the frame is cloned outside the lock.
+            ++copying_;
+        }
+
+        Job job;
+        job.scene = scene.clone();
+        job.primaryCenters = primary.acceptedCentersPx;
+        job.primaryTimings = primary.timings;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        --copying_;
+        if (stopping_) {
+            return;
+        }
+        queue_.push_back(std::move(job));
+        wake_.notify_one();
+    }
+
+    ShadowTotals Totals(bool& running) const {
+        running = enabled_.load();
+        std::lock_guard<std::mutex> lock(mutex_);
+        return totals_;
+    }
+
+private:
+    void StopLocked() {
+        enabled_.store(false);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+            queue_.clear();
+        }
+        wake_.notify_all();
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+    }
+
+    struct Job {
+        cv::Mat scene;
+        std::vector<cv::Point> primaryCenters;
+        vision::PipelineTimings primaryTimings;
+    };
+
+    void Run() {
+        LowerCurrentThreadPriority();
+        vision::DetectionWorkspace ws;
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&]() { return stopping_ || !queue_.empty(); });
+                if (stopping_) {
+                    return;
+                }
+                job = std::move(queue_.front());
+                queue_.pop_front();
+            }
+
+            vision::ColorPatternRunResult shadow;
+            bool ok = true;
+            try {
+                shadow = finder_->Find(job.scene, ws);
+            }
+            catch (...) {
+                ok = false;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!ok) {
+                totals_.framesFailed += 1;
+                continue;
+            }
+            const size_t matched = CountMatches(job.primaryCenters, shadow.acceptedCentersPx);
+            const uint64_t added = shadow.acceptedCentersPx.size() - matched;
+            const uint64_t lost = job.primaryCenters.size() - matched;
+            totals_.framesEvaluated += 1;
+            totals_.framesDiverged += (added + lost) > 0 ? 1 : 0;
+            totals_.primaryDetections += job.primaryCenters.size();
+            totals_.shadowDetections += shadow.acceptedCentersPx.size();
+            totals_.addedDetections += added;
+            totals_.lostDetections += lost;
+            for (int i = 0; i < vision::kPipelineStageCount; ++i) {
+                totals_.primaryMsSum.ms[static_cast<size_t>(i)] += job.primaryTimings.ms[static_cast<size_t>(i)];
+                totals_.shadowMsSum.ms[static_cast<size_t>(i)] += shadow.timings.ms[static_cast<size_t>(i)];
+            }
+        }
+    }
+
+    // Greedy one-to-one matching of centers within matchRadiusPx_.
+    size_t CountMatches(const std::vector<cv::Point>& primary, const std::vector<cv::Point>& shadow) const {
+        const int64_t maxDist2 = static_cast<int64_t>(matchRadiusPx_) * matchRadiusPx_;
+        std::vector<bool> used(shadow.size(), false);
+        size_t matched = 0;
+        for (const cv::Point& p : primary) {
+            int64_t best = maxDist2 + 1;
+            size_t bestIdx = shadow.size();
+            for (size_t j = 0; j < shadow.size(); ++j) {
+                if (used[j]) {
+                    continue;
+                }
+                const int64_t dx = shadow[j].x - p.x;
+                const int64_t dy = shadow[j].y - p.y;
+                const int64_t d2 = dx * dx + dy * dy;
+                if (d2 < best) {
+                    best = d2;
+                    bestIdx = j;
+                }
+            }
+            if (bestIdx < shadow.size()) {
+                used[bestIdx] = true;
+                matched += 1;
+            }
+        }
+        return matched;
+    }
+
+    std::mutex controlMutex_;   // serializes Start/Stop
+    std::unique_ptr<vision::ColorPatternFinder> finder_;
+    std::thread worker_;
+    std::atomic<bool> enabled_{ false };
+    std::atomic<uint64_t> sampleInterval_{ 1 };
+    std::atomic<uint64_t> frameCounter_{ 0 };
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<Job> queue_;
+    size_t copying_ = 0;              // submits cloning a frame outside the lock
+    size_t capacity_ = 4;
+    int matchRadiusPx_ = 2;
+    bool stopping_ = false;
+    ShadowTotals totals_;
+};
+
+ShadowEvaluator g_shadow;
+
+void SubmitShadowSample(const cv::Mat& scene, const vision::ColorPatternRunResult& primary) {
+    g_shadow.Submit(scene, primary);
+}
+
+// "name = value" lines, one per ChromaConfigV1 field; hue ranges as "min-max, ...".
+std::string FormatApiConfigText(const ChromaConfigV1& cfg) {
+    std::ostringstream out;
+    const auto hues = [&](const char* name, const ChromaHueRange* ranges, const int32_t count) {
+        out << name << " =";
+        for (int32_t i = 0; i < count; ++i) {
+            out << (i == 0 ? " " : ", ") << ranges[i].minHue << '-' << ranges[i].maxHue;
+        }
+        out << '\n';
+    };
+    const auto range = [&](const char* name, const ChromaChannelRange& r) {
+        out << name << " = " << r.minValue << '-' << r.maxValue << '\n';
+    };
+    hues("centerHueRanges", cfg.centerHueRanges, cfg.centerHueRangeCount);
+    range("centerSatRange", cfg.centerSatRange);
+    range("centerValRange", cfg.centerValRange);
+    out << "centerMorphOpenIterations = " << cfg.centerMorphOpenIterations << '\n';
+    out << "centerMorphCloseIterations = " << cfg.centerMorphCloseIterations << '\n';
+    out << "centerDilateIterations = " << cfg.centerDilateIterations << '\n';
+    out << "minBlobArea = " << cfg.minBlobArea << '\n';
+    out << "maxBlobArea = " << cfg.maxBlobArea << '\n';
+    out << "minCircularity = " << cfg.minCircularity << '\n';
+    out << "minCenterFillRatio = " << cfg.minCenterFillRatio << '\n';
+    out << "requireContextRing = " << cfg.requireContextRing << '\n';
+    out << "ringInnerRadiusPercent = " << cfg.ringInnerRadiusPercent << '\n';
+    out << "ringOuterRadiusPercent = " << cfg.ringOuterRadiusPercent << '\n';
+    range("contextSupportSatRange", cfg.contextSupportSatRange);
+    range("contextSupportValRange", cfg.contextSupportValRange);
+    hues("contextExcludeHueRanges", cfg.contextExcludeHueRanges, cfg.contextExcludeHueRangeCount);
+    out << "contextMinSupportRatio = " << cfg.contextMinSupportRatio << '\n';
+    out << "drawRejectedCandidates = " << cfg.drawRejectedCandidates << '\n';
+    return out.str();
+}
+
+// Inverse of FormatApiConfigText. Keys that are not listed keep their value in `out`;
+// blank lines and lines starting with '#' are ignored. Value ranges are left to
+// ConvertApiConfigToPattern.
+bool ParseApiConfigText(const std::string& text, ChromaConfigV1& out, std::string& errorOut) {
+    const auto trim = [](std::string value) {
+        const size_t first = value.find_first_not_of(" \t\r");
+        if (first == std::string::npos) {
+            return std::string();
+        }
+        const size_t last = value.find_last_not_of(" \t\r");
+        return value.substr(first, last - first + 1);
+    };
+    const auto parseInt = [](const std::string& value, int32_t& target) {
+        size_t used = 0;
+        try {
+            const long parsed = std::stol(value, &used);
+            if (used != value.size() || parsed < std::numeric_limits<int32_t>::min() ||
+                parsed > std::numeric_limits<int32_t>::max()) {
+                return false;
+            }
+            target = static_cast<int32_t>(parsed);
+            return true;
+        }
+        catch (const std::exception&) {
+            return false;
+        }
+    };
+    const auto parseFloat = [](const std::string& value, float& target) {
+        size_t used = 0;
+        try {
+            target = std::stof(value, &used);
+            return used == value.size();
+        }
+        catch (const std::exception&) {
+            return false;
+        }
+    };
+    const auto parsePair = [&](const std::string& value, int32_t& lo, int32_t& hi) {
+        const size_t dash = value.find('-', 1);
+        return dash != std::string::npos
+            && parseInt(trim(value.substr(0, dash)), lo)
+            && parseInt(trim(value.substr(dash + 1)), hi);
+    };
+    const auto parseHues = [&](const std::string& value, ChromaHueRange* ranges, int32_t& count) {
+        count = 0;
+        std::istringstream items(value);
+        std::string item;
+        while (std::getline(items, item, ',')) {
+            item = trim(item);
+            if (item.empty()) {
+                continue;
+            }
+            if (count >= CHROMA_MAX_HUE_RANGES ||
+                !parsePair(item, ranges[count].minHue, ranges[count].maxHue)) {
+                return false;
+            }
+            ++count;
+        }
+        return true;
+    };
+    const auto parseRange = [&](const std::string& value, ChromaChannelRange& range) {
+        return parsePair(value, range.minValue, range.maxValue);
+    };
+
+    std::istringstream lines(text);
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(lines, line)) {
+        ++lineNumber;
+        line = trim(line);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        const size_t eq = line.find('=');
+        if (eq == std::string::npos) {
+            errorOut = "line " + std::to_string(lineNumber) + ": expected 'name = value'.";
+            return false;
+        }
+        const std::string name = trim(line.substr(0, eq));
+        const std::string value = trim(line.substr(eq + 1));
+        bool ok = false;
+        if (name == "centerHueRanges") {
+            ok = parseHues(value, out.centerHueRanges, out.centerHueRangeCount);
+        } else if (name == "centerSatRange") {
+            ok = parseRange(value, out.centerSatRange);
+        } else if (name == "centerValRange") {
+            ok = parseRange(value, out.centerValRange);
+        } else if (name == "centerMorphOpenIterations") {
+            ok = parseInt(value, out.centerMorphOpenIterations);
+        } else if (name == "centerMorphCloseIterations") {
+            ok = parseInt(value, out.centerMorphCloseIterations);
+        } else if (name == "centerDilateIterations") {
+            ok = parseInt(value, out.centerDilateIterations);
+        } else if (name == "minBlobArea") {
+            ok = parseInt(value, out.minBlobArea);
+        } else if (name == "maxBlobArea") {
+            ok = parseInt(value, out.maxBlobArea);
+        } else if (name == "minCircularity") {
+            ok = parseFloat(value, out.minCircularity);
+        } else if (name == "minCenterFillRatio") {
+            ok = parseFloat(value, out.minCenterFillRatio);
+        } else if (name == "requireContextRing") {
+            ok = parseInt(value, out.requireContextRing);
+        } else if (name == "ringInnerRadiusPercent") {
+            ok = parseInt(value, out.ringInnerRadiusPercent);
+        } else if (name == "ringOuterRadiusPercent") {
+            ok = parseInt(value, out.ringOuterRadiusPercent);
+        } else if (name == "contextSupportSatRange") {
+            ok = parseRange(value, out.contextSupportSatRange);
+        } else if (name == "contextSupportValRange") {
+            ok = parseRange(value, out.contextSupportValRange);
+        } else if (name == "contextExcludeHueRanges") {
+            ok = parseHues(value, out.contextExcludeHueRanges, out.contextExcludeHueRangeCount);
+        } else if (name == "contextMinSupportRatio") {
+            ok = parseFloat(value, out.contextMinSupportRatio);
+        } else if (name == "drawRejectedCandidates") {
+            ok = parseInt(value, out.drawRejectedCandidates);
+        } else {
+            errorOut = "line " + std::to_string(lineNumber) + ": unknown key '" + name + "'.";
+            return false;
+        }
+        if (!ok) {
+            errorOut = "line " + std::to_string(lineNumber) + ": invalid value for '" + name + "'.";
+            return false;
+        }
+    }
+    return true;
+}
+
+struct SentinelTotals {
+    uint64_t latencyTriggers = 0;
+    uint64_t candidateTriggers = 0;
+    uint64_t framesCaptured = 0;
+    uint64_t framesSkipped = 0;
+    uint64_t writeFailures = 0;
+    uint64_t capturesEvicted = 0;
+    uint64_t spoolCaptures = 0;
+    uint64_t spoolBytes = 0;
+};
+
+// Captures outlier frames: a detection slower than the latency threshold or with more
+// raw candidates than the candidate threshold is copied, together with its config,
+// plan hints, stage timings and counters, into a bounded queue. A low-priority worker
+// writes each capture as <stem>.png + <stem>.txt into the spool directory and deletes
+// the oldest captures beyond the count/size limits. Frames below both thresholds only
+// pay two relaxed loads and two comparisons.
+class SlowFrameSentinel {
+public:
+    ~SlowFrameSentinel() {
+#ifdef _WIN32
+        // Same loader-lock constraint as the shadow worker: call Chroma_StopSentinel
+        // before unloading the DLL.
+        if (worker_.joinable()) {
+            worker_.detach();
+        }
+#else
+        Stop();
+#endif
+    }
+
+    struct Options {
+        double latencyThresholdMs = 0.0;  // <= 0 disables
+        int candidateThreshold = 0;       // <= 0 disables
+        size_t queueCapacity = 4;
+        size_t maxCaptures = 64;
+        uint64_t maxBytes = 0;            // 0 = no size limit
+        int64_t minIntervalNs = 0;
+        std::filesystem::path directory;
+    };
+
+    void Start(Options options) {
+        std::lock_guard<std::mutex> control(controlMutex_);
+        StopLocked();
+        std::filesystem::create_directories(options.directory);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            totals_ = {};
+            stopping_ = false;
+            options_ = std::move(options);
+            ScanSpoolLocked();
+            TrimSpoolLocked();
+        }
+        latencyThresholdMs_.store(options_.latencyThresholdMs > 0.0 ? options_.latencyThresholdMs : kDisabledMs);
+        candidateThreshold_.store(options_.candidateThreshold > 0 ? options_.candidateThreshold : kDisabledCount);
+        lastCaptureNs_.store(std::numeric_limits<int64_t>::min() / 2);
+        worker_ = std::thread(&SlowFrameSentinel::Run, this);
+        enabled_.store(true);
+    }
+
+    // Queued captures are still written before the worker exits.
+    void Stop() {
+        std::lock_guard<std::mutex> control(controlMutex_);
+        StopLocked();
+    }
+
+    void Check(
+        const cv::Mat& scene,
+        const vision::ColorPatternConfig& cfg,
+        const vision::PlanHints& hints,
+        const vision::ColorPatternRunResult& result) {
+        const bool slow = result.timings[vision::PipelineStage::Total] > latencyThresholdMs_.load(std::memory_order_relaxed);
+        const bool crowded = result.rawCandidateCount > candidateThreshold_.load(std::memory_order_relaxed);
+        if (!slow && !crowded) {
+            return;
+        }
+        Capture(scene, cfg, hints, result, slow, crowded);
+    }
+
+    // The same trigger test Check() applies, for callers that must build a BGR scene
+    // before they can hand the frame over.
+    bool Triggers(const vision::ColorPatternRunResult& result) const {
+        return result.timings[vision::PipelineStage::Total] > latencyThresholdMs_.load(std::memory_order_relaxed)
+            || result.rawCandidateCount > candidateThreshold_.load(std::memory_order_relaxed);
+    }
+
+    SentinelTotals Totals(bool& running) const {
+        running = enabled_.load();
+        std::lock_guard<std::mutex> lock(mutex_);
+        return totals_;
+    }
+
+private:
+    static constexpr double kDisabledMs = std::numeric_limits<double>::infinity();
+    static constexpr int kDisabledCount = std::numeric_limits<int>::max();
+
+    struct Job {
+        cv::Mat scene;
+        vision::ColorPatternConfig cfg;
+        vision::PlanHints hints;
+        vision::PipelineTimings timings;
+        int rawCandidates = 0;
+        int accepted = 0;
+        float sceneMaskCoverage = 0.0F;
+        float contextMaskCoverage = 0.0F;
+        bool slow = false;
+        bool crowded = false;
+        int64_t unixMs = 0;
+    };
+
+    struct SpoolEntry {
+        std::filesystem::path stem;   // without extension
+        uint64_t bytes = 0;
+    };
+
+    static int64_t SteadyNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void Capture(
+        const cv::Mat& scene,
+        const vision::ColorPatternConfig& cfg,
+        const vision::PlanHints& hints,
+        const vision::ColorPatternRunResult& result,
+        const bool slow,
+        const bool crowded) {
+        if (!enabled_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) {
+                return;
+            }
+            totals_.latencyTriggers += slow ? 1 : 0;
+            totals_.candidateTriggers += crowded ? 1 : 0;
+            const int64_t now = SteadyNs();
+            if (queue_.size() + copying_ >= options_.queueCapacity ||
+                now - lastCaptureNs_.load(std::memory_order_relaxed) < options_.minIntervalNs) {
+                totals_.framesSkipped += 1;
+                return;
+            }
+            lastCaptureNs_.store(now, std::memory_order_relaxed);
+            // The clone below runs outside the lock; the reserved slot keeps concurrent
+            // captures from overfilling the queue meanwhile.
+            ++copying_;
+        }
+
+        Job job;
+        job.scene = scene.clone();
+        job.cfg = cfg;
+        job.hints = hints;
+        job.timings = result.timings;
+        job.rawCandidates = result.rawCandidateCount;
+        job.accepted = result.acceptedCount;
+        job.sceneMaskCoverage = result.sceneMaskCoverage;
+        job.contextMaskCoverage = result.contextMaskCoverage;
+        job.slow = slow;
+        job.crowded = crowded;
+        job.unixMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        --copying_;
+        if (stopping_) {
+            return;
+        }
+        queue_.push_back(std::move(job));
+        wake_.notify_one();
+    }
+
+    void StopLocked() {
+        enabled_.store(false);
+        latencyThresholdMs_.store(kDisabledMs);
+        candidateThreshold_.store(kDisabledCount);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+    }
+
+    void Run() {
+        LowerCurrentThreadPriority();
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&]() { return stopping_ || !queue_.empty(); });
+                if (queue_.empty()) {
+                    return;
+                }
+                job = std::move(queue_.front());
+                queue_.pop_front();
+            }
+
+            SpoolEntry entry;
+            const bool ok = WriteCapture(job, entry);
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!ok) {
+                totals_.writeFailures += 1;
+                continue;
+            }
+            totals_.framesCaptured += 1;
+            spool_.push_back(entry);
+            totals_.spoolCaptures += 1;
+            totals_.spoolBytes += entry.bytes;
+            TrimSpoolLocked();
+        }
+    }
+
+    bool WriteCapture(const Job& job, SpoolEntry& entry) {
+        char name[64];
+        std::snprintf(name, sizeof(name), "%s%013lld-%06llu", kPrefix,
+            static_cast<long long>(job.unixMs), static_cast<unsigned long long>(++sequence_));
+        entry.stem = options_.directory / name;
+
+        std::vector<uchar> png;
+        try {
+            cv::Mat bgr;
+            if (job.scene.channels() == 4) {
+                cv::cvtColor(job.scene, bgr, cv::COLOR_BGRA2BGR);   // BGRx alpha is often 0
+            }
+            else {
+                bgr = job.scene;
+            }
+            if (!cv::imencode(".png", bgr, png)) {
+                return false;
+            }
+        }
+        catch (...) {
+            return false;
+        }
+
+        static constexpr const char* kStages[vision::kPipelineStageCount] = {
+            "convert", "classifyCenter", "morphology", "classifyContext", "contours", "candidates", "debugRender", "total" };
+        std::ostringstream text;
+        text << "# Chroma slow-frame capture\n";
+        text << "trigger =" << (job.slow ? " latency" : "") << (job.crowded ? " candidates" : "") << '\n';
+        text << "unixMs = " << job.unixMs << '\n';
+        text << "width = " << job.scene.cols << '\n';
+        text << "height = " << job.scene.rows << '\n';
+        text << "channels = " << job.scene.channels() << '\n';
+        text << "latencyThresholdMs = " << options_.latencyThresholdMs << '\n';
+        text << "candidateThreshold = " << options_.candidateThreshold << '\n';
+        text << "\n# counters\n";
+        text << "rawCandidates = " << job.rawCandidates << '\n';
+        text << "accepted = " << job.accepted << '\n';
+        text << "sceneMaskCoverage = " << job.sceneMaskCoverage << '\n';
+        text << "contextMaskCoverage = " << job.contextMaskCoverage << '\n';
+        text << "\n# stage timings (ms)\n";
+        for (int i = 0; i < vision::kPipelineStageCount; ++i) {
+            text << "stageMs." << kStages[i] << " = " << job.timings.ms[static_cast<size_t>(i)] << '\n';
+        }
+        text << "\n# config\n" << FormatApiConfigText(ConvertPatternToApiConfig(job.cfg));
+        text << "\n# plan (renderDebug = " << (job.hints.renderDebug ? 1 : 0)
+             << ", ringCoverageHint = " << job.hints.expectedRingCoverage << ")\n";
+        text << vision::ColorPatternFinder::CompilePlan(job.cfg, job.hints).Explain();
+        const std::string textBytes = text.str();
+
+        std::filesystem::path pngPath = entry.stem;
+        pngPath += ".png";
+        std::filesystem::path textPath = entry.stem;
+        textPath += ".txt";
+        {
+            std::ofstream file(pngPath, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(png.data()), static_cast<std::streamsize>(png.size()));
+            if (!file) {
+                RemoveCapture(entry.stem);
+                return false;
+            }
+        }
+        {
+            std::ofstream file(textPath, std::ios::binary | std::ios::trunc);
+            file.write(textBytes.data(), static_cast<std::streamsize>(textBytes.size()));
+            if (!file) {
+                RemoveCapture(entry.stem);
+                return false;
+            }
+        }
+        entry.bytes = static_cast<uint64_t>(png.size() + textBytes.size());
+        return true;
+    }
+
+    static void RemoveCapture(const std::filesystem::path& stem) {
+        std::error_code ec;
+        std::filesystem::path path = stem;
+        path += ".png";
+        std::filesystem::remove(path, ec);
+        path = stem;
+        path += ".txt";
+        std::filesystem::remove(path, ec);
+    }
+
+    // Adopts captures left by earlier runs so the limits cover the whole directory.
+    void ScanSpoolLocked() {
+        spool_.clear();
+        std::map<std::filesystem::path, uint64_t> found;
+        std::error_code ec;
+        for (const auto& item : std::filesystem::directory_iterator(options_.directory, ec)) {
+            const std::filesystem::path& path = item.path();
+            const std::string file = path.filename().string();
+            if (file.rfind(kPrefix, 0) != 0 || (path.extension() != ".png" && path.extension() != ".txt")) {
+                continue;
+            }
+            std::error_code sizeEc;
+            const uintmax_t bytes = std::filesystem::file_size(path, sizeEc);
+            std::filesystem::path stem = path;
+            stem.replace_extension();
+            found[stem] += sizeEc ? 0 : static_cast<uint64_t>(bytes);
+        }
+        for (const auto& item : found) {
+            spool_.push_back(SpoolEntry{ item.first, item.second });   // map order = name = time order
+            totals_.spoolBytes += item.second;
+        }
+        totals_.spoolCaptures = spool_.size();
+    }
+
+    void TrimSpoolLocked() {
+        while (!spool_.empty() &&
+            (spool_.size() > options_.maxCaptures || (options_.maxBytes > 0 && totals_.spoolBytes > options_.maxBytes))) {
+            RemoveCapture(spool_.front().stem);
+            totals_.spoolBytes -= std::min(totals_.spoolBytes, spool_.front().bytes);
+            totals_.spoolCaptures -= 1;
+            totals_.capturesEvicted += 1;
+            spool_.pop_front();
+        }
+    }
+
+    static constexpr const char* kPrefix = "chroma-slow-";
+
+    std::mutex controlMutex_;   // serializes Start/Stop
+    std::thread worker_;
+    std::atomic<bool> enabled_{ false };
+    std::atomic<double> latencyThresholdMs_{ kDisabledMs };
+    std::atomic<int> candidateThreshold_{ kDisabledCount };
+    std::atomic<int64_t> lastCaptureNs_{ 0 };
+    uint64_t sequence_ = 0;       // worker thread only
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<Job> queue_;
+    size_t copying_ = 0;              // captures cloning a frame outside the lock
+    std::deque<SpoolEntry> spool_;
+    Options options_;
+    bool stopping_ = false;
+    SentinelTotals totals_;
+};
+
+SlowFrameSentinel g_sentinel;
+
+// Calibrated from every locate call; read by Chroma_EstimateCost.
+vision::LatencyCostModel g_costModel;
+
+struct ConfigWatchTotals {
+    uint64_t reloads = 0;
+    uint64_t rejected = 0;
+    uint64_t lastLoadUs = 0;
+    std::string lastError;
+};
+
+// Keeps the active config in sync with a text file ("name = value" lines, see
+// ParseApiConfigText). A background thread waits for the file to change (inotify on
+// the parent directory on Linux, so atomic renames are seen; mtime polling elsewhere),
+// then parses and validates it, runs an optional warmup detection with the new config
+// on a pooled workspace, and only then swaps it in. Detection threads only ever see
+// the old or the new snapshot. A file that fails to parse or validate leaves the
+// active config unchanged and is reported through the totals.
+class ConfigFileWatcher {
+public:
+    ~ConfigFileWatcher() {
+#ifdef _WIN32
+        // Same loader-lock constraint as the other workers: call Chroma_StopConfigWatch
+        // before unloading the DLL.
+        if (worker_.joinable()) {
+            worker_.detach();
+        }
+#else
+        Stop();
+#endif
+    }
+
+    struct Options {
+        std::filesystem::path path;
+        int pollIntervalMs = 250;
+        cv::Size warmupSize;   // empty = no warmup detection before the swap
+    };
+
+    // Loads the file once on the calling thread; the watch only starts when that
+    // load succeeds.
+    bool Start(Options options, std::string& errorOut) {
+        std::lock_guard<std::mutex> control(controlMutex_);
+        StopLocked();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            totals_ = {};
+            stopping_ = false;
+            options_ = std::move(options);
+            lastText_.clear();
+        }
+        if (!Reload(errorOut)) {
+            return false;
+        }
+#ifdef __linux__
+        inotifyFd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotifyFd_ >= 0) {
+            const std::filesystem::path parent = options_.path.has_parent_path()
+                ? options_.path.parent_path()
+                : std::filesystem::path(".");
+            if (inotify_add_watch(inotifyFd_, parent.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+                close(inotifyFd_);
+                inotifyFd_ = -1;
+            }
+        }
+#endif
+        worker_ = std::thread(&ConfigFileWatcher::Run, this);
+        running_.store(true);
+        return true;
+    }
+
+    void Stop() {
+        std::lock_guard<std::mutex> control(controlMutex_);
+        StopLocked();
+    }
+
+    ConfigWatchTotals Totals(bool& running) const {
+        running = running_.load();
+        std::lock_guard<std::mutex> lock(mutex_);
+        return totals_;
+    }
+
+private:
+    void StopLocked() {
+        running_.store(false);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+#ifdef __linux__
+        if (inotifyFd_ >= 0) {
+            close(inotifyFd_);
+            inotifyFd_ = -1;
+        }
+#endif
+    }
+
+    bool StopRequested() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stopping_;
+    }
+
+    // Blocks until the file may have changed or Stop() is called. Returns false on stop.
+    bool WaitForChange() {
+#ifdef __linux__
+        if (inotifyFd_ >= 0) {
+            const std::string fileName = options_.path.filename().string();
+            for (;;) {
+                if (StopRequested()) {
+                    return false;
+                }
+                pollfd pfd{ inotifyFd_, POLLIN, 0 };
+                if (poll(&pfd, 1, options_.pollIntervalMs) <= 0) {
+                    continue;
+                }
+                alignas(inotify_event) char buffer[4096];
+                bool matched = false;
+                ssize_t length = 0;
+                while ((length = read(inotifyFd_, buffer, sizeof(buffer))) > 0) {
+                    for (ssize_t offset = 0; offset < length;) {
+                        const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                        if (event->len > 0 && fileName == event->name) {
+                            matched = true;
+                        }
+                        offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+                    }
+                }
+                if (matched) {
+                    return true;
+                }
+            }
+        }
+#endif
+        // Compared against the stamp taken before the last read, so a write that lands
+        // between that read and this wait is still seen.
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            if (wake_.wait_for(lock, std::chrono::milliseconds(options_.pollIntervalMs), [&] { return stopping_; })) {
+                return false;
+            }
+            lock.unlock();
+            const bool changed = Stamp() != readStamp_;
+            lock.lock();
+            if (changed) {
+                return true;
+            }
+        }
+    }
+
+    using FileStamp = std::pair<std::filesystem::file_time_type, std::uintmax_t>;
+
+    // Modification time and size; a missing file gives a stamp of its own.
+    FileStamp Stamp() const {
+        std::error_code ec;
+        const auto time = std::filesystem::last_write_time(options_.path, ec);
+        const auto size = std::filesystem::file_size(options_.path, ec);
+        return { time, size };
+    }
+
+    void Run() {
+        LowerCurrentThreadPriority();
+        while (WaitForChange()) {
+            std::string error;
+            (void)Reload(error);
+        }
+    }
+
+    bool Reload(std::string& errorOut) {
+        const auto start = std::chrono::steady_clock::now();
+        readStamp_ = Stamp();
+        std::string text;
+        {
+            std::ifstream file(options_.path, std::ios::binary);
+            if (!file) {
+                return Reject("cannot open " + options_.path.string(), errorOut);
+            }
+            std::ostringstream contents;
+            contents << file.rdbuf();
+            text = contents.str();
+        }
+        if (text == lastText_) {
+            return true;
+        }
+
+        ChromaConfigV1 apiConfig = ConvertPatternToApiConfig(BuildDefaultPatternConfig());
+        std::string error;
+        if (!ParseApiConfigText(text, apiConfig, error)) {
+            return Reject(error, errorOut);
+        }
+        vision::ColorPatternConfig cfg;
+        if (ConvertApiConfigToPattern(apiConfig, cfg, error) != CHROMA_STATUS_OK) {
+            return Reject(error, errorOut);
+        }
+
+        std::shared_ptr<const ActiveConfig> next;
+        try {
+            next = MakeActiveConfig(cfg);
+            if (!options_.warmupSize.empty()) {
+                const cv::Mat frame = BuildWarmupFrame(options_.warmupSize.width, options_.warmupSize.height, cfg);
+                vision::PlanHints hints;
+                hints.renderDebug = false;
+                const vision::ColorPatternFinder finder(cfg, next->plan, hints);
+                PooledWorkspace workspace;
+                (void)finder.Find(frame, workspace.Get());
+            }
+        }
+        catch (const std::exception& ex) {
+            return Reject(ex.what(), errorOut);
+        }
+
+        SetActiveConfig(std::move(next));
+        lastText_ = std::move(text);
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++totals_.reloads;
+        totals_.lastLoadUs = ElapsedNs(start) / 1000;
+        totals_.lastError.clear();
+        return true;
+    }
+
+    bool Reject(const std::string& error, std::string& errorOut) {
+        errorOut = error;
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++totals_.rejected;
+        totals_.lastError = error;
+        return false;
+    }
+
+    std::mutex controlMutex_;
+    std::thread worker_;
+    std::atomic<bool> running_{ false };
+#ifdef __linux__
+    int inotifyFd_ = -1;
+#endif
+    std::string lastText_;   // worker thread (and Start) only
+    FileStamp readStamp_;    // taken before the last read; worker thread (and Start) only
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    Options options_;
+    bool stopping_ = false;
+    ConfigWatchTotals totals_;
+};
+
+ConfigFileWatcher g_configWatcher;
+
+// Per-call detection options threaded from the exported entry points.
+struct DetectCallOptions {
+    // Stream-owned workspace; null borrows one from the process-wide pool.
+    vision::DetectionWorkspace* workspace = nullptr;
+    // True when cfg is the active config (eligible for shadow sampling).
+    bool usesActiveConfig = false;
+    // Snapshot cfg belongs to; its compiled plan is reused instead of recompiled.
+    std::shared_ptr<const ActiveConfig> active = nullptr;
+    // Debug panels are only rendered when the caller asked for a debug image.
+    bool renderDebug = false;
+    vision::DebugRenderOptions debugOutput{};
+    // Ring coverage observed on the previous frame of a stream (< 0 = unknown); the
+    // planner uses it to choose between lazy and dense context classification.
+    float ringCoverageHint = -1.0F;
+    float* ringCoverageOut = nullptr;
+    // Accepted detections carry BlobColorStats.
+    bool blobStats = false;
+    // Cost model inputs: the caller's input layout and any conversion it did before
+    // detection. loadOut (optional) receives the frame's candidates and coverage.
+    vision::CostInput costInput = vision::CostInput::Bgr;
+    double inputConvertMs = 0.0;
+    vision::RecentLoad* loadOut = nullptr;
+};
+
 int32_t DetectRunResultFromMat(
     const cv::Mat& sceneBgrOrBgra,
     const vision::ColorPatternConfig& cfg,
+    const DetectCallOptions& options,
     vision::ColorPatternRunResult& outResult,
     wchar_t* outError,
     const int32_t outErrorChars) {
@@ -306,8 +1509,31 @@ int32_t DetectRunResultFromMat(
     }
 
     try {
-        const vision::ColorPatternFinder finder(cfg);
-        outResult = finder.Find(sceneBgrOrBgra);
+        vision::PlanHints hints;
+        hints.renderDebug = options.renderDebug;
+        hints.debugOutput = options.debugOutput;
+        hints.expectedRingCoverage = options.ringCoverageHint;
+        hints.blobStats = options.blobStats;
+        const vision::ColorPatternFinder finder = options.active != nullptr
+            ? vision::ColorPatternFinder(cfg, options.active->plan, hints)
+            : vision::ColorPatternFinder(cfg, hints);
+        if (options.workspace != nullptr) {
+            outResult = finder.Find(sceneBgrOrBgra, *options.workspace);
+        } else {
+            PooledWorkspace pooled;
+            outResult = finder.Find(sceneBgrOrBgra, pooled.Get());
+        }
+        if (options.ringCoverageOut != nullptr) {
+            *options.ringCoverageOut = outResult.contextMaskCoverage;
+        }
+        g_costModel.Observe(finder.Plan(), sceneBgrOrBgra.size(), options.costInput, options.inputConvertMs, outResult);
+        if (options.loadOut != nullptr) {
+            options.loadOut->Update(outResult, sceneBgrOrBgra.size());
+        }
+        g_sentinel.Check(sceneBgrOrBgra, cfg, hints, outResult);
+        if (options.usesActiveConfig) {
+            SubmitShadowSample(sceneBgrOrBgra, outResult);
+        }
         return CHROMA_STATUS_OK;
     }
     catch (const std::exception& ex) {
@@ -324,13 +1550,14 @@ int32_t DetectRunResultFromMat(
 int32_t DetectAcceptedCentersFromMat(
     const cv::Mat& sceneBgrOrBgra,
     const vision::ColorPatternConfig& cfg,
+    const DetectCallOptions& options,
     std::vector<ChromaPoint>& outCenters,
     wchar_t* outError,
     const int32_t outErrorChars) {
     outCenters.clear();
 
     vision::ColorPatternRunResult result;
-    const int32_t status = DetectRunResultFromMat(sceneBgrOrBgra, cfg, result, outError, outErrorChars);
+    const int32_t status = DetectRunResultFromMat(sceneBgrOrBgra, cfg, options, result, outError, outErrorChars);
     if (status != CHROMA_STATUS_OK) {
         return status;
     }
@@ -480,24 +1707,16 @@ int32_t ValidateOutputArgs(
     return CHROMA_STATUS_OK;
 }
 
-int32_t LocateBitmapImpl(
+// Validates a BGRA buffer and wraps it as a top-down scene. Top-down buffers are viewed
+// in place; bottom-up buffers (negative stride) are flipped into a new image.
+int32_t ViewBgraBuffer(
     const void* bgraPixels,
     const int32_t width,
     const int32_t height,
     const int32_t strideBytes,
-    const vision::ColorPatternConfig& cfg,
-    ChromaPoint* outPoints,
-    const int32_t outCapacity,
-    int32_t* outTotalFound,
-    int32_t* outWritten,
+    cv::Mat& outScene,
     wchar_t* outError,
     const int32_t outErrorChars) {
-    if (outTotalFound != nullptr) {
-        *outTotalFound = 0;
-    }
-    if (outWritten != nullptr) {
-        *outWritten = 0;
-    }
     if (bgraPixels == nullptr) {
         WriteErrorMessage(outError, outErrorChars, L"bgraPixels is null.");
         return CHROMA_STATUS_INVALID_ARGUMENT;
@@ -525,36 +1744,621 @@ int32_t LocateBitmapImpl(
         }
     }
 
-    const int32_t outputStatus = ValidateOutputArgs(outCapacity, outPoints, outError, outErrorChars);
-    if (outputStatus != CHROMA_STATUS_OK) {
-        return outputStatus;
-    }
-
     const size_t absStride = static_cast<size_t>(absStride64);
-    cv::Mat bgraView;
-    cv::Mat scene;
     if (strideBytes > 0) {
-        bgraView = cv::Mat(height, width, CV_8UC4, const_cast<void*>(bgraPixels), absStride);
-        scene = bgraView;
+        outScene = cv::Mat(height, width, CV_8UC4, const_cast<void*>(bgraPixels), absStride);
     }
     else {
         const uint8_t* base = static_cast<const uint8_t*>(bgraPixels);
         const size_t lastRowOffset = static_cast<size_t>(static_cast<uint64_t>(absStride64) * static_cast<uint64_t>(height - 1));
         const uint8_t* topRow = base + lastRowOffset;
-        bgraView = cv::Mat(height, width, CV_8UC4, const_cast<uint8_t*>(topRow), absStride);
-        cv::flip(bgraView, scene, 0);
+        const cv::Mat bgraView(height, width, CV_8UC4, const_cast<uint8_t*>(topRow), absStride);
+        cv::flip(bgraView, outScene, 0);
+    }
+    return CHROMA_STATUS_OK;
+}
+
+int32_t LocateBitmapImpl(
+    const void* bgraPixels,
+    const int32_t width,
+    const int32_t height,
+    const int32_t strideBytes,
+    const vision::ColorPatternConfig& cfg,
+    const DetectCallOptions& options,
+    ChromaPoint* outPoints,
+    const int32_t outCapacity,
+    int32_t* outTotalFound,
+    int32_t* outWritten,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    if (outTotalFound != nullptr) {
+        *outTotalFound = 0;
+    }
+    if (outWritten != nullptr) {
+        *outWritten = 0;
+    }
+    cv::Mat scene;
+    const int32_t viewStatus = ViewBgraBuffer(bgraPixels, width, height, strideBytes, scene, outError, outErrorChars);
+    if (viewStatus != CHROMA_STATUS_OK) {
+        return viewStatus;
+    }
+
+    const int32_t outputStatus = ValidateOutputArgs(outCapacity, outPoints, outError, outErrorChars);
+    if (outputStatus != CHROMA_STATUS_OK) {
+        return outputStatus;
+    }
+
+    std::vector<ChromaPoint> centers;
+    const int32_t detectStatus = DetectAcceptedCentersFromMat(scene, cfg, options, centers, outError, outErrorChars);
+    if (detectStatus != CHROMA_STATUS_OK) {
+        return detectStatus;
+    }
+    return WriteLocateOutputs(centers, outPoints, outCapacity, outTotalFound, outWritten, outError, outErrorChars);
+}
+
+// NV12 input: the Y and UV planes are viewed in place and converted to BGR into
+// `converted` (a workspace buffer), which is then detected like any BGR scene.
+int32_t LocateNv12Impl(
+    const ChromaFrameV1& frame,
+    const vision::ColorPatternConfig& cfg,
+    const DetectCallOptions& options,
+    cv::Mat& converted,
+    ChromaPoint* outPoints,
+    const int32_t outCapacity,
+    int32_t* outTotalFound,
+    int32_t* outWritten,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    if (outTotalFound != nullptr) {
+        *outTotalFound = 0;
+    }
+    if (outWritten != nullptr) {
+        *outWritten = 0;
+    }
+    if (frame.planes[0] == nullptr || frame.planes[1] == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"NV12 frame planes must not be null.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (frame.width <= 0 || frame.height <= 0) {
+        WriteErrorMessage(outError, outErrorChars, L"width/height must be > 0.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if ((frame.width % 2) != 0 || (frame.height % 2) != 0) {
+        WriteErrorMessage(outError, outErrorChars, L"NV12 width/height must be even.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (frame.strideBytes[0] < frame.width || frame.strideBytes[1] < frame.width) {
+        WriteErrorMessage(outError, outErrorChars, L"NV12 strides must be positive and at least width.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+
+    const int32_t outputStatus = ValidateOutputArgs(outCapacity, outPoints, outError, outErrorChars);
+    if (outputStatus != CHROMA_STATUS_OK) {
+        return outputStatus;
+    }
+
+    DetectCallOptions nv12Options = options;
+    nv12Options.costInput = vision::CostInput::Nv12;
+    try {
+        const auto convertStart = std::chrono::steady_clock::now();
+        const cv::Mat yPlane(
+            frame.height, frame.width, CV_8UC1,
+            const_cast<void*>(frame.planes[0]), static_cast<size_t>(frame.strideBytes[0]));
+        const cv::Mat uvPlane(
+            frame.height / 2, frame.width / 2, CV_8UC2,
+            const_cast<void*>(frame.planes[1]), static_cast<size_t>(frame.strideBytes[1]));
+        cv::cvtColorTwoPlane(yPlane, uvPlane, converted, cv::COLOR_YUV2BGR_NV12);
+        nv12Options.inputConvertMs = static_cast<double>(ElapsedNs(convertStart)) / 1.0e6;
+    }
+    catch (const std::exception& ex) {
+        const std::wstring wmsg = Utf8ToWide(ex.what());
+        WriteErrorMessage(outError, outErrorChars, wmsg.empty() ? L"Runtime error." : wmsg.c_str());
+        return CHROMA_STATUS_RUNTIME_ERROR;
     }
 
     std::vector<ChromaPoint> centers;
-    const int32_t detectStatus = DetectAcceptedCentersFromMat(scene, cfg, centers, outError, outErrorChars);
+    const int32_t detectStatus = DetectAcceptedCentersFromMat(converted, cfg, nv12Options, centers, outError, outErrorChars);
     if (detectStatus != CHROMA_STATUS_OK) {
         return detectStatus;
     }
     return WriteLocateOutputs(centers, outPoints, outCapacity, outTotalFound, outWritten, outError, outErrorChars);
 }
 
+// The plane layout rules of ChromaFrameV1 (see ChromaApi.h), checked before a frame's
+// bytes are read or copied.
+bool ValidateFrameLayout(const ChromaFrameV1& frame, const wchar_t*& error) {
+    if (frame.width <= 0 || frame.height <= 0) {
+        error = L"width/height must be > 0.";
+        return false;
+    }
+    if (frame.planes[0] == nullptr || (frame.pixelFormat == CHROMA_PIXEL_FORMAT_NV12 && frame.planes[1] == nullptr)) {
+        error = L"Frame plane is null.";
+        return false;
+    }
+    const int64_t width = frame.width;
+    switch (frame.pixelFormat) {
+    case CHROMA_PIXEL_FORMAT_NV12:
+        if ((frame.width % 2) != 0 || (frame.height % 2) != 0) {
+            error = L"NV12 width/height must be even.";
+            return false;
+        }
+        if (frame.strideBytes[0] < width || frame.strideBytes[1] < width) {
+            error = L"NV12 strides must be positive and at least width.";
+            return false;
+        }
+        return true;
+    case CHROMA_PIXEL_FORMAT_R10G10B10A2:
+    case CHROMA_PIXEL_FORMAT_RGBA16F: {
+        const bool halfFloat = frame.pixelFormat == CHROMA_PIXEL_FORMAT_RGBA16F;
+        if (frame.strideBytes[0] < width * (halfFloat ? 8 : 4)) {
+            error = halfFloat
+                ? L"RGBA16F stride must be positive and at least width*8."
+                : L"R10G10B10A2 stride must be positive and at least width*4.";
+            return false;
+        }
+        // Rows are read as 32-bit words or half floats, so the plane and every row must
+        // be aligned to the element size.
+        const size_t elementBytes = halfFloat ? 2 : 4;
+        if (static_cast<size_t>(frame.strideBytes[0]) % elementBytes != 0
+            || reinterpret_cast<uintptr_t>(frame.planes[0]) % elementBytes != 0) {
+            error = halfFloat
+                ? L"RGBA16F plane and stride must be 2-byte aligned."
+                : L"R10G10B10A2 plane and stride must be 4-byte aligned.";
+            return false;
+        }
+        return true;
+    }
+    default:
+        if (std::llabs(static_cast<int64_t>(frame.strideBytes[0])) < width * 4) {
+            error = L"strideBytes is smaller than width*4.";
+            return false;
+        }
+        return true;
+    }
+}
+
+// R10G10B10A2 / RGBA16F input: the frame is viewed in place and classified from its
+// source values (ColorPatternFinder::FindHdr), without an 8-bit BGR copy. A BGR scene
+// is only reconstructed from the HSV image when the sentinel captures the frame;
+// HDR frames are not sampled for shadow evaluation.
+int32_t LocateHdrImpl(
+    const ChromaFrameV1& frame,
+    const vision::ColorPatternConfig& cfg,
+    const DetectCallOptions& options,
+    ChromaPoint* outPoints,
+    const int32_t outCapacity,
+    int32_t* outTotalFound,
+    int32_t* outWritten,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    if (outTotalFound != nullptr) {
+        *outTotalFound = 0;
+    }
+    if (outWritten != nullptr) {
+        *outWritten = 0;
+    }
+    const wchar_t* layoutError = nullptr;
+    if (!ValidateFrameLayout(frame, layoutError)) {
+        WriteErrorMessage(outError, outErrorChars, layoutError);
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    const bool halfFloat = frame.pixelFormat == CHROMA_PIXEL_FORMAT_RGBA16F;
+
+    const int32_t outputStatus = ValidateOutputArgs(outCapacity, outPoints, outError, outErrorChars);
+    if (outputStatus != CHROMA_STATUS_OK) {
+        return outputStatus;
+    }
+
+    std::vector<ChromaPoint> centers;
+    try {
+        const cv::Mat source(
+            frame.height, frame.width, halfFloat ? CV_16UC4 : CV_32SC1,
+            const_cast<void*>(frame.planes[0]), static_cast<size_t>(frame.strideBytes[0]));
+        const vision::HdrFormat format = halfFloat ? vision::HdrFormat::Rgba16F : vision::HdrFormat::Rgb10A2;
+
+        vision::PlanHints hints;
+        hints.renderDebug = false;
+        hints.expectedRingCoverage = options.ringCoverageHint;
+        const vision::ColorPatternFinder finder = options.active != nullptr
+            ? vision::ColorPatternFinder(cfg, options.active->plan, hints)
+            : vision::ColorPatternFinder(cfg, hints);
+        auto run = [&](vision::DetectionWorkspace& ws) {
+            vision::ColorPatternRunResult result = finder.FindHdr(source, format, ws);
+            g_costModel.Observe(finder.Plan(), source.size(), halfFloat ? vision::CostInput::Rgba16F : vision::CostInput::Rgb10A2, 0.0, result);
+            if (options.loadOut != nullptr) {
+                options.loadOut->Update(result, source.size());
+            }
+            if (g_sentinel.Triggers(result)) {
+                cv::cvtColor(ws.hsv, ws.sceneBgr, cv::COLOR_HSV2BGR);
+                g_sentinel.Check(ws.sceneBgr, cfg, hints, result);
+            }
+            return result;
+        };
+        vision::ColorPatternRunResult result;
+        if (options.workspace != nullptr) {
+            result = run(*options.workspace);
+        } else {
+            PooledWorkspace pooled;
+            result = run(pooled.Get());
+        }
+        if (options.ringCoverageOut != nullptr) {
+            *options.ringCoverageOut = result.contextMaskCoverage;
+        }
+        centers.reserve(result.acceptedCentersPx.size());
+        for (const auto& p : result.acceptedCentersPx) {
+            centers.push_back(ChromaPoint{ p.x, p.y });
+        }
+    }
+    catch (const std::exception& ex) {
+        const std::wstring wmsg = Utf8ToWide(ex.what());
+        WriteErrorMessage(outError, outErrorChars, wmsg.empty() ? L"Runtime error." : wmsg.c_str());
+        return CHROMA_STATUS_RUNTIME_ERROR;
+    }
+    catch (...) {
+        WriteErrorMessage(outError, outErrorChars, L"Unknown runtime error.");
+        return CHROMA_STATUS_RUNTIME_ERROR;
+    }
+    return WriteLocateOutputs(centers, outPoints, outCapacity, outTotalFound, outWritten, outError, outErrorChars);
+}
+
+// Dispatches a ChromaFrameV1 on its pixel format. `converted` receives the BGR image of
+// NV12 frames.
+int32_t LocateFrameImpl(
+    const ChromaFrameV1& frame,
+    const vision::ColorPatternConfig& cfg,
+    const DetectCallOptions& options,
+    cv::Mat& converted,
+    ChromaPoint* outPoints,
+    const int32_t outCapacity,
+    int32_t* outTotalFound,
+    int32_t* outWritten,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    switch (frame.pixelFormat) {
+    case CHROMA_PIXEL_FORMAT_NV12:
+        return LocateNv12Impl(
+            frame, cfg, options, converted, outPoints, outCapacity, outTotalFound, outWritten, outError, outErrorChars);
+    case CHROMA_PIXEL_FORMAT_R10G10B10A2:
+    case CHROMA_PIXEL_FORMAT_RGBA16F:
+        return LocateHdrImpl(
+            frame, cfg, options, outPoints, outCapacity, outTotalFound, outWritten, outError, outErrorChars);
+    default:
+        return LocateBitmapImpl(
+            frame.planes[0],
+            frame.width,
+            frame.height,
+            frame.strideBytes[0],
+            cfg,
+            options,
+            outPoints,
+            outCapacity,
+            outTotalFound,
+            outWritten,
+            outError,
+            outErrorChars);
+    }
+}
+
+bool IsSupportedPixelFormat(const int32_t pixelFormat) {
+    return pixelFormat == CHROMA_PIXEL_FORMAT_BGRA8
+        || pixelFormat == CHROMA_PIXEL_FORMAT_NV12
+        || pixelFormat == CHROMA_PIXEL_FORMAT_R10G10B10A2
+        || pixelFormat == CHROMA_PIXEL_FORMAT_RGBA16F;
+}
+
+vision::CostInput CostInputFor(const int32_t pixelFormat) {
+    switch (pixelFormat) {
+    case CHROMA_PIXEL_FORMAT_NV12: return vision::CostInput::Nv12;
+    case CHROMA_PIXEL_FORMAT_R10G10B10A2: return vision::CostInput::Rgb10A2;
+    case CHROMA_PIXEL_FORMAT_RGBA16F: return vision::CostInput::Rgba16F;
+    default: return vision::CostInput::Bgr;
+    }
+}
+
+} // namespace
+
+int32_t CHROMA_CALL ChromaRuntime_LocateStreamFrame(
+    ChromaStream* stream,
+    const ChromaFrameV1* frame,
+    ChromaPoint* outPoints,
+    int32_t outCapacity,
+    int32_t* outTotalFound,
+    int32_t* outWritten,
+    wchar_t* outError,
+    int32_t outErrorChars);
+
+namespace {
+
+struct PumpTotals {
+    uint64_t framesPushed = 0;
+    uint64_t framesProcessed = 0;
+    uint64_t framesDropped = 0;
+    uint64_t producerBlocks = 0;
+    uint64_t producerWaitNs = 0;
+    uint64_t queueAgeNsTotal = 0;
+    uint64_t queueAgeNsMax = 0;
+    uint64_t lastQueueAgeNs = 0;
+    uint64_t lastDetectNs = 0;
+};
+
+// Newest pump result of a stream. It lives on the stream, so the result of the frame
+// that was in flight when the pump stopped can still be read.
+struct StreamResult {
+    mutable std::mutex mutex;
+    uint64_t frameId = 0;
+    int32_t status = CHROMA_STATUS_OK;
+    int32_t totalFound = 0;
+    std::vector<ChromaPoint> points;   // at most StreamPump::kMaxPoints
+};
+
+// Continuous mode for one stream: producers push frames, which are copied into
+// recycled slots, and one worker detects them in order through the stream (so the
+// cascade and ring-coverage state stay sequential). The backpressure policy decides
+// what a push does when the worker is behind: replace the waiting frame (latest wins),
+// drop the pushed frame when `capacity` frames wait (bounded FIFO), or wait for room
+// (block). Queue age is measured from push to the start of detection.
+class StreamPump {
+public:
+    static constexpr size_t kMaxPoints = 4096;   // points listed per result; totals are exact
+
+    struct Options {
+        int32_t policy = CHROMA_BACKPRESSURE_LATEST;
+        size_t capacity = 1;
+        ChromaFrameResultCallback callback = nullptr;
+        void* userData = nullptr;
+    };
+
+    // Results go to `result`, which must outlive the pump. Frame ids restart at 1, so
+    // the previous pump's result is cleared.
+    StreamPump(ChromaStream* stream, StreamResult& result, Options options)
+        : stream_(stream), result_(result), options_(options) {
+        if (options_.policy == CHROMA_BACKPRESSURE_LATEST) {
+            options_.capacity = 1;
+        }
+        {
+            std::lock_guard<std::mutex> lock(result_.mutex);
+            result_.frameId = 0;
+            result_.status = CHROMA_STATUS_OK;
+            result_.totalFound = 0;
+            result_.points.clear();
+        }
+        worker_ = std::thread(&StreamPump::Run, this);
+    }
+
+    ~StreamPump() {
+        Stop();
+    }
+
+    StreamPump(const StreamPump&) = delete;
+    StreamPump& operator=(const StreamPump&) = delete;
+
+    // Discards waiting frames, wakes blocked producers and waits for the frame in flight.
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) {
+                return;
+            }
+            stopping_ = true;
+            while (!queue_.empty()) {
+                free_.push_back(std::move(queue_.front()));
+                queue_.pop_front();
+            }
+        }
+        wake_.notify_all();
+        space_.notify_all();
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+    }
+
+    // Copies `frame` (already validated) into a slot. `queued` is false when the frame
+    // was dropped by the bounded FIFO policy. The copy runs outside the lock; frames
+    // being copied count against the capacity so concurrent producers cannot overfill it.
+    bool Push(const ChromaFrameV1& frame, uint64_t& frameId, bool& queued) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        const bool bounded = options_.policy != CHROMA_BACKPRESSURE_LATEST;
+        if (options_.policy == CHROMA_BACKPRESSURE_BLOCK && queue_.size() + copying_ >= options_.capacity && !stopping_) {
+            const auto waitStart = std::chrono::steady_clock::now();
+            ++totals_.producerBlocks;
+            space_.wait(lock, [&] { return stopping_ || queue_.size() + copying_ < options_.capacity; });
+            totals_.producerWaitNs += ElapsedNs(waitStart);
+        }
+        if (stopping_) {
+            return false;
+        }
+        frameId = ++nextFrameId_;
+        ++totals_.framesPushed;
+        queued = true;
+        if (bounded && queue_.size() + copying_ >= options_.capacity) {
+            ++totals_.framesDropped;
+            queued = false;
+            return true;
+        }
+
+        Slot slot;
+        if (!free_.empty()) {
+            slot = std::move(free_.back());
+            free_.pop_back();
+        }
+        ++copying_;
+        lock.unlock();
+        slot.Assign(frame);
+        slot.id = frameId;
+        slot.pushed = std::chrono::steady_clock::now();
+        lock.lock();
+        --copying_;
+        if (stopping_) {
+            return false;
+        }
+        if (!bounded && !queue_.empty()) {
+            // Latest frame wins: the waiting frame is stale.
+            free_.push_back(std::move(queue_.front()));
+            queue_.pop_front();
+            ++totals_.framesDropped;
+        }
+        queue_.push_back(std::move(slot));
+        lock.unlock();
+        wake_.notify_one();
+        return true;
+    }
+
+    int32_t Policy() const {
+        return options_.policy;
+    }
+
+    PumpTotals Totals(size_t& queueDepth) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queueDepth = queue_.size();
+        return totals_;
+    }
+
+private:
+    struct Slot {
+        uint64_t id = 0;
+        std::chrono::steady_clock::time_point pushed;
+        ChromaFrameV1 frame{};
+        std::vector<uint8_t> planes[2];
+
+        // Copies the bytes each plane spans (rows in memory order, so bottom-up BGRA
+        // keeps its negative stride).
+        void Assign(const ChromaFrameV1& source) {
+            frame = source;
+            const int planeCount = (source.pixelFormat == CHROMA_PIXEL_FORMAT_NV12) ? 2 : 1;
+            for (int p = 0; p < 2; ++p) {
+                if (p >= planeCount) {
+                    frame.planes[p] = nullptr;
+                    continue;
+                }
+                const int rows = (p == 0) ? source.height : source.height / 2;
+                const int64_t stride = std::llabs(static_cast<int64_t>(source.strideBytes[p]));
+                const size_t bytes = static_cast<size_t>(stride * (rows - 1) + RowBytes(source));
+                planes[p].resize(bytes);
+                std::memcpy(planes[p].data(), source.planes[p], bytes);
+                frame.planes[p] = planes[p].data();
+            }
+        }
+    };
+
+    static int64_t RowBytes(const ChromaFrameV1& frame) {
+        switch (frame.pixelFormat) {
+        case CHROMA_PIXEL_FORMAT_NV12: return frame.width;   // Y, or UV pairs at half width
+        case CHROMA_PIXEL_FORMAT_RGBA16F: return static_cast<int64_t>(frame.width) * 8;
+        default: return static_cast<int64_t>(frame.width) * 4;
+        }
+    }
+
+    void Run() {
+        std::vector<ChromaPoint> points(kMaxPoints);
+        for (;;) {
+            Slot slot;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&] { return stopping_ || !queue_.empty(); });
+                if (stopping_) {
+                    return;
+                }
+                slot = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            space_.notify_one();
+
+            const auto started = std::chrono::steady_clock::now();
+            const uint64_t ageNs = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(started - slot.pushed).count());
+            int32_t total = 0;
+            int32_t written = 0;
+            int32_t status = ChromaRuntime_LocateStreamFrame(
+                stream_, &slot.frame, points.data(), static_cast<int32_t>(points.size()), &total, &written, nullptr, 0);
+            const uint64_t detectNs = ElapsedNs(started);
+            if (status == CHROMA_STATUS_BUFFER_TOO_SMALL) {
+                // Only the worker's own list was cut; the detection and its total are complete.
+                status = CHROMA_STATUS_OK;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(result_.mutex);
+                result_.frameId = slot.id;
+                result_.status = status;
+                result_.totalFound = total;
+                result_.points.assign(points.begin(), points.begin() + written);
+            }
+            if (options_.callback != nullptr) {
+                ChromaFrameResultV1 result{};
+                result.structSize = static_cast<int32_t>(sizeof(ChromaFrameResultV1));
+                result.status = status;
+                result.frameId = slot.id;
+                result.queueAgeUs = ageNs / 1000;
+                result.detectUs = detectNs / 1000;
+                result.totalFound = total;
+                result.pointCount = written;
+                result.points = points.data();
+                options_.callback(options_.userData, &result);
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++totals_.framesProcessed;
+            totals_.queueAgeNsTotal += ageNs;
+            totals_.queueAgeNsMax = std::max(totals_.queueAgeNsMax, ageNs);
+            totals_.lastQueueAgeNs = ageNs;
+            totals_.lastDetectNs = detectNs;
+            free_.push_back(std::move(slot));
+        }
+    }
+
+    ChromaStream* stream_;
+    StreamResult& result_;
+    Options options_;
+    std::thread worker_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;    // worker: a frame is waiting
+    std::condition_variable space_;   // blocked producers: a slot was taken
+    std::deque<Slot> queue_;
+    std::vector<Slot> free_;
+    size_t copying_ = 0;              // pushes copying a frame outside the lock
+    uint64_t nextFrameId_ = 0;
+    bool stopping_ = false;
+    PumpTotals totals_;
+};
+
 } // namespace
 
+struct ChromaStream {
+    ~ChromaStream() {
+        // The pump's worker detects through this stream; stop it before the members go.
+        std::shared_ptr<StreamPump> running;
+        {
+            std::lock_guard<std::mutex> lock(pumpMutex);
+            running = std::move(pump);
+        }
+        if (running != nullptr) {
+            running->Stop();
+        }
+    }
+
+    std::mutex mutex;
+    std::unique_ptr<vision::DetectionWorkspace> workspace;
+    uint64_t acceptedDetections = 0;
+    float ringCoverage = -1.0F;   // previous frame, fed to the planner
+    vision::RecentLoad load;
+
+    // Copies of ringCoverage/load for Chroma_EstimateCost, which must not wait for a
+    // detection holding `mutex`.
+    std::mutex loadMutex;
+    float ringCoverageSnapshot = -1.0F;
+    vision::RecentLoad loadSnapshot;
+
+    // Continuous mode; shared so a producer blocked in Push outlives a concurrent stop.
+    std::mutex pumpMutex;
+    std::shared_ptr<StreamPump> pump;
+    StreamResult pumpResult;
+};
+
+struct ChromaRegionMap {
+    std::unique_ptr<vision::RegionPatternFinder> finder;
+};
+
 int32_t CHROMA_CALL ChromaRuntime_GetApiVersion() {
     return 1;
 }
@@ -633,13 +2437,15 @@ int32_t CHROMA_CALL ChromaRuntime_LocateBitmapBGRAW(
     wchar_t* outError,
     const int32_t outErrorChars) {
     WriteErrorMessage(outError, outErrorChars, L"");
-    const vision::ColorPatternConfig cfg = GetActiveConfigCopy();
+    DetectCallOptions options{ nullptr, true };
+    options.active = GetActiveConfig();
     return LocateBitmapImpl(
         bgraPixels,
         width,
         height,
         strideBytes,
-        cfg,
+        options.active->config,
+        options,
         outPoints,
         outCapacity,
         outTotalFound,
@@ -648,11 +2454,12 @@ int32_t CHROMA_CALL ChromaRuntime_LocateBitmapBGRAW(
         outErrorChars);
 }
 
-int32_t CHROMA_CALL ChromaRuntime_LocateBitmapWithDebugBGRAW(
+int32_t CHROMA_CALL ChromaRuntime_LocateBitmapWithDebugOptionsBGRAW(
     const void* bgraPixels,
     const int32_t width,
     const int32_t height,
     const int32_t strideBytes,
+    const ChromaDebugOptionsV1* debugOptions,
     ChromaPoint* outPoints,
     const int32_t outCapacity,
     int32_t* outTotalFound,
@@ -680,6 +2487,24 @@ int32_t CHROMA_CALL ChromaRuntime_LocateBitmapWithDebugBGRAW(
         outDebugImage->bytesWritten = 0;
     }
 
+    vision::DebugRenderOptions debugOutput;
+    if (debugOptions != nullptr) {
+        if (debugOptions->structSize < static_cast<int32_t>(sizeof(ChromaDebugOptionsV1))) {
+            WriteErrorMessage(outError, outErrorChars, L"ChromaDebugOptionsV1.structSize is smaller than required.");
+            return CHROMA_STATUS_INVALID_ARGUMENT;
+        }
+        if (debugOptions->panels < CHROMA_DEBUG_PANELS_OVERLAY || debugOptions->panels > CHROMA_DEBUG_PANELS_BOTH) {
+            WriteErrorMessage(outError, outErrorChars, L"ChromaDebugOptionsV1.panels must be OVERLAY, MASK or BOTH.");
+            return CHROMA_STATUS_INVALID_ARGUMENT;
+        }
+        if (debugOptions->maxWidth < 0 || debugOptions->maxHeight < 0) {
+            WriteErrorMessage(outError, outErrorChars, L"ChromaDebugOptionsV1.maxWidth/maxHeight must be >= 0.");
+            return CHROMA_STATUS_INVALID_ARGUMENT;
+        }
+        debugOutput.panels = static_cast<vision::DebugPanels>(debugOptions->panels);
+        debugOutput.maxSize = cv::Size(debugOptions->maxWidth, debugOptions->maxHeight);
+    }
+
     if (bgraPixels == nullptr) {
         WriteErrorMessage(outError, outErrorChars, L"bgraPixels is null.");
         return CHROMA_STATUS_INVALID_ARGUMENT;
@@ -728,9 +2553,13 @@ int32_t CHROMA_CALL ChromaRuntime_LocateBitmapWithDebugBGRAW(
         cv::flip(bgraView, scene, 0);
     }
 
-    const vision::ColorPatternConfig cfg = GetActiveConfigCopy();
     vision::ColorPatternRunResult runResult;
-    const int32_t detectStatus = DetectRunResultFromMat(scene, cfg, runResult, outError, outErrorChars);
+    DetectCallOptions options{ nullptr, true };
+    options.active = GetActiveConfig();
+    const vision::ColorPatternConfig& cfg = options.active->config;
+    options.renderDebug = (outDebugImage != nullptr);
+    options.debugOutput = debugOutput;
+    const int32_t detectStatus = DetectRunResultFromMat(scene, cfg, options, runResult, outError, outErrorChars);
     if (detectStatus != CHROMA_STATUS_OK) {
         return detectStatus;
     }
@@ -764,6 +2593,34 @@ int32_t CHROMA_CALL ChromaRuntime_LocateBitmapWithDebugBGRAW(
 
     return CHROMA_STATUS_OK;
 }
+
+int32_t CHROMA_CALL ChromaRuntime_LocateBitmapWithDebugBGRAW(
+    const void* bgraPixels,
+    const int32_t width,
+    const int32_t height,
+    const int32_t strideBytes,
+    ChromaPoint* outPoints,
+    const int32_t outCapacity,
+    int32_t* outTotalFound,
+    int32_t* outWritten,
+    ChromaDebugImageV1* outDebugImage,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_LocateBitmapWithDebugOptionsBGRAW(
+        bgraPixels,
+        width,
+        height,
+        strideBytes,
+        nullptr,
+        outPoints,
+        outCapacity,
+        outTotalFound,
+        outWritten,
+        outDebugImage,
+        outError,
+        outErrorChars);
+}
+
 int32_t CHROMA_CALL ChromaRuntime_LocateBitmapWithConfigBGRAW(
     const void* bgraPixels,
     const int32_t width,
@@ -789,6 +2646,7 @@ int32_t CHROMA_CALL ChromaRuntime_LocateBitmapWithConfigBGRAW(
         height,
         strideBytes,
         cfg,
+        DetectCallOptions{},
         outPoints,
         outCapacity,
         outTotalFound,
@@ -797,18 +2655,182 @@ int32_t CHROMA_CALL ChromaRuntime_LocateBitmapWithConfigBGRAW(
         outErrorChars);
 }
 
-int32_t CHROMA_CALL ChromaRuntime_LocateHBitmap(
-    const void* hBitmap,
+int32_t CHROMA_CALL ChromaRuntime_LocateBitmapWithBlobStatsBGRAW(
+    const void* bgraPixels,
+    const int32_t width,
+    const int32_t height,
+    const int32_t strideBytes,
+    const ChromaConfigV1* config,
     ChromaPoint* outPoints,
+    ChromaBlobStatsV1* outStats,
     const int32_t outCapacity,
     int32_t* outTotalFound,
     int32_t* outWritten,
     wchar_t* outError,
     const int32_t outErrorChars) {
     WriteErrorMessage(outError, outErrorChars, L"");
-#ifdef _WIN32
-    if (hBitmap == nullptr) {
-        WriteErrorMessage(outError, outErrorChars, L"hBitmap is null.");
+    if (outTotalFound != nullptr) {
+        *outTotalFound = 0;
+    }
+    if (outWritten != nullptr) {
+        *outWritten = 0;
+    }
+    if (outCapacity > 0 && outStats != nullptr &&
+        outStats[0].structSize < static_cast<int32_t>(sizeof(ChromaBlobStatsV1))) {
+        WriteErrorMessage(outError, outErrorChars, L"ChromaBlobStatsV1.structSize is smaller than required.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+
+    DetectCallOptions options;
+    options.blobStats = true;
+    vision::ColorPatternConfig cfg;
+    if (config == nullptr) {
+        options.active = GetActiveConfig();
+        cfg = options.active->config;
+        options.usesActiveConfig = true;
+    } else {
+        const int32_t cfgStatus = BuildConfigFromPointer(config, cfg, outError, outErrorChars);
+        if (cfgStatus != CHROMA_STATUS_OK) {
+            return cfgStatus;
+        }
+    }
+
+    cv::Mat scene;
+    const int32_t viewStatus = ViewBgraBuffer(bgraPixels, width, height, strideBytes, scene, outError, outErrorChars);
+    if (viewStatus != CHROMA_STATUS_OK) {
+        return viewStatus;
+    }
+    const int32_t outputStatus = ValidateOutputArgs(outCapacity, outPoints, outError, outErrorChars);
+    if (outputStatus != CHROMA_STATUS_OK) {
+        return outputStatus;
+    }
+
+    vision::ColorPatternRunResult result;
+    const int32_t detectStatus = DetectRunResultFromMat(scene, cfg, options, result, outError, outErrorChars);
+    if (detectStatus != CHROMA_STATUS_OK) {
+        return detectStatus;
+    }
+
+    std::vector<ChromaPoint> centers;
+    centers.reserve(result.acceptedCentersPx.size());
+    for (const auto& p : result.acceptedCentersPx) {
+        centers.push_back(ChromaPoint{ p.x, p.y });
+    }
+    int32_t written = 0;
+    const int32_t status = WriteLocateOutputs(centers, outPoints, outCapacity, outTotalFound, &written, outError, outErrorChars);
+    if (outWritten != nullptr) {
+        *outWritten = written;
+    }
+    if (outStats != nullptr) {
+        // Accepted detections lead result.detections in acceptedCentersPx order.
+        for (int32_t i = 0; i < written; ++i) {
+            const vision::BlobColorStats& in = result.detections[static_cast<size_t>(i)].colorStats;
+            ChromaBlobStatsV1 out{};
+            out.structSize = static_cast<int32_t>(sizeof(ChromaBlobStatsV1));
+            out.pixelCount = in.pixelCount;
+            out.meanHue = in.meanHue;
+            out.meanSat = in.meanSat;
+            out.meanVal = in.meanVal;
+            out.brightestX = in.brightestPx.x;
+            out.brightestY = in.brightestPx.y;
+            out.brightestHue = in.brightestHsv[0];
+            out.brightestSat = in.brightestHsv[1];
+            out.brightestVal = in.brightestHsv[2];
+            for (int b = 0; b < CHROMA_BLOB_HUE_BINS; ++b) {
+                out.hueHistogram[b] = in.hueHistogram[static_cast<size_t>(b)];
+            }
+            outStats[i] = out;
+        }
+    }
+    return status;
+}
+
+int32_t CHROMA_CALL ChromaRuntime_LocateNearestBGRAW(
+    const void* bgraPixels,
+    const int32_t width,
+    const int32_t height,
+    const int32_t strideBytes,
+    const ChromaConfigV1* config,
+    const int32_t focusX,
+    const int32_t focusY,
+    ChromaNearestResultV1* outResult,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (outResult == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"outResult is null.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (outResult->structSize < static_cast<int32_t>(sizeof(ChromaNearestResultV1))) {
+        WriteErrorMessage(outError, outErrorChars, L"ChromaNearestResultV1.structSize is smaller than required.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (focusX < 0 || focusY < 0 || focusX >= width || focusY >= height) {
+        WriteErrorMessage(outError, outErrorChars, L"focusX/focusY must lie inside the frame.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+
+    vision::ColorPatternConfig cfg;
+    std::shared_ptr<const ActiveConfig> active;
+    if (config == nullptr) {
+        active = GetActiveConfig();
+        cfg = active->config;
+    } else {
+        const int32_t cfgStatus = BuildConfigFromPointer(config, cfg, outError, outErrorChars);
+        if (cfgStatus != CHROMA_STATUS_OK) {
+            return cfgStatus;
+        }
+    }
+
+    cv::Mat scene;
+    const int32_t viewStatus = ViewBgraBuffer(bgraPixels, width, height, strideBytes, scene, outError, outErrorChars);
+    if (viewStatus != CHROMA_STATUS_OK) {
+        return viewStatus;
+    }
+
+    try {
+        vision::PlanHints hints;
+        hints.renderDebug = false;
+        const vision::ColorPatternFinder finder = active != nullptr
+            ? vision::ColorPatternFinder(cfg, active->plan, hints)
+            : vision::ColorPatternFinder(cfg, hints);
+        PooledWorkspace pooled;
+        const vision::NearestTargetResult nearest = finder.FindNearest(scene, cv::Point(focusX, focusY), pooled.Get());
+
+        ChromaNearestResultV1 result{};
+        result.structSize = static_cast<int32_t>(sizeof(ChromaNearestResultV1));
+        result.found = nearest.found ? 1 : 0;
+        result.x = nearest.found ? nearest.detection.centerPx.x : -1;
+        result.y = nearest.found ? nearest.detection.centerPx.y : -1;
+        result.distancePx = nearest.distancePx;
+        result.rounds = nearest.rounds;
+        result.processedFraction = nearest.processedFraction;
+        *outResult = result;
+        return CHROMA_STATUS_OK;
+    }
+    catch (const std::exception& ex) {
+        const std::wstring wmsg = Utf8ToWide(ex.what());
+        WriteErrorMessage(outError, outErrorChars, wmsg.empty() ? L"Runtime error." : wmsg.c_str());
+        return CHROMA_STATUS_RUNTIME_ERROR;
+    }
+    catch (...) {
+        WriteErrorMessage(outError, outErrorChars, L"Unknown runtime error.");
+        return CHROMA_STATUS_RUNTIME_ERROR;
+    }
+}
+
+int32_t CHROMA_CALL ChromaRuntime_LocateHBitmap(
+    const void* hBitmap,
+    ChromaPoint* outPoints,
+    const int32_t outCapacity,
+    int32_t* outTotalFound,
+    int32_t* outWritten,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    WriteErrorMessage(outError, outErrorChars, L"");
+#ifdef _WIN32
+    if (hBitmap == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"hBitmap is null.");
         return CHROMA_STATUS_INVALID_ARGUMENT;
     }
 
@@ -856,13 +2878,15 @@ int32_t CHROMA_CALL ChromaRuntime_LocateHBitmap(
         return CHROMA_STATUS_RUNTIME_ERROR;
     }
 
-    const vision::ColorPatternConfig cfg = GetActiveConfigCopy();
+    DetectCallOptions options{ nullptr, true };
+    options.active = GetActiveConfig();
     return LocateBitmapImpl(
         pixels.data(),
         width,
         height,
         width * 4,
-        cfg,
+        options.active->config,
+        options,
         outPoints,
         outCapacity,
         outTotalFound,
@@ -964,13 +2988,15 @@ int32_t CHROMA_CALL ChromaRuntime_LocateHWND(
         return CHROMA_STATUS_RUNTIME_ERROR;
     }
 
-    const vision::ColorPatternConfig cfg = GetActiveConfigCopy();
+    DetectCallOptions options{ nullptr, true };
+    options.active = GetActiveConfig();
     return LocateBitmapImpl(
         captured.data,
         captured.cols,
         captured.rows,
         static_cast<int32_t>(captured.step),
-        cfg,
+        options.active->config,
+        options,
         outPoints,
         outCapacity,
         outTotalFound,
@@ -990,97 +3016,245 @@ int32_t CHROMA_CALL ChromaRuntime_LocateHWND(
 }
 
 
+int32_t CHROMA_CALL ChromaRuntime_Warmup(
+    const int32_t width,
+    const int32_t height,
+    const int32_t pixelFormat,
+    const int32_t workspaceCount,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (width <= 0 || height <= 0) {
+        WriteErrorMessage(outError, outErrorChars, L"width/height must be > 0.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (pixelFormat != CHROMA_PIXEL_FORMAT_BGRA8) {
+        WriteErrorMessage(outError, outErrorChars, L"Unsupported pixelFormat.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (workspaceCount < 0) {
+        WriteErrorMessage(outError, outErrorChars, L"workspaceCount must be >= 0.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
 
+    try {
+        // Start OpenCV's worker threads before the first real frame needs them.
+        cv::parallel_for_(cv::Range(0, std::max(1, cv::getNumThreads())), [](const cv::Range&) {});
 
+        const std::shared_ptr<const ActiveConfig> active = GetActiveConfig();
+        const cv::Mat frame = BuildWarmupFrame(width, height, active->config);
+        vision::PlanHints hints;
+        hints.renderDebug = false;
+        const vision::ColorPatternFinder finder(active->config, active->plan, hints);
 
-
-#ifndef CHROMA_RUNTIME_ONLY
-CHROMA_API int32_t CHROMA_CALL Chroma_GetApiVersion() {
-    return ChromaRuntime_GetApiVersion();
-}
-
-CHROMA_API int32_t CHROMA_CALL Chroma_GetConfigStructSize() {
-    return ChromaRuntime_GetConfigStructSize();
+        // The pool hands out its most recently returned workspace, so warming one at a
+        // time would size the same workspace repeatedly. Hold all of them at once so each
+        // concurrent caller later finds a sized one.
+        const size_t count = std::min(kMaxPooledWorkspaces, static_cast<size_t>(std::max(1, workspaceCount)));
+        std::vector<std::unique_ptr<PooledWorkspace>> workspaces;
+        workspaces.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            workspaces.push_back(std::make_unique<PooledWorkspace>());
+            (void)finder.Find(frame, workspaces.back()->Get());
+        }
+        return CHROMA_STATUS_OK;
+    }
+    catch (const std::exception& ex) {
+        const std::wstring wmsg = Utf8ToWide(ex.what());
+        WriteErrorMessage(outError, outErrorChars, wmsg.empty() ? L"Runtime error." : wmsg.c_str());
+        return CHROMA_STATUS_RUNTIME_ERROR;
+    }
+    catch (...) {
+        WriteErrorMessage(outError, outErrorChars, L"Unknown runtime error.");
+        return CHROMA_STATUS_RUNTIME_ERROR;
+    }
 }
 
-CHROMA_API int32_t CHROMA_CALL Chroma_GetDefaultConfig(
-    ChromaConfigV1* outConfig,
+int32_t CHROMA_CALL ChromaRuntime_GetMemoryOptions(
+    ChromaMemoryOptionsV1* outOptions,
     wchar_t* outError,
     const int32_t outErrorChars) {
-    return ChromaRuntime_GetDefaultConfig(outConfig, outError, outErrorChars);
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (outOptions == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"outOptions is null.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (outOptions->structSize < static_cast<int32_t>(sizeof(ChromaMemoryOptionsV1))) {
+        WriteErrorMessage(outError, outErrorChars, L"ChromaMemoryOptionsV1.structSize is smaller than required.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    std::lock_guard<std::mutex> lock(g_workspaceMutex);
+    *outOptions = g_memoryOptions;
+    return CHROMA_STATUS_OK;
 }
 
-CHROMA_API int32_t CHROMA_CALL Chroma_GetActiveConfig(
-    ChromaConfigV1* outConfig,
+int32_t CHROMA_CALL ChromaRuntime_SetMemoryOptions(
+    const ChromaMemoryOptionsV1* options,
     wchar_t* outError,
     const int32_t outErrorChars) {
-    return ChromaRuntime_GetActiveConfig(outConfig, outError, outErrorChars);
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (options == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"options is null.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (options->structSize < static_cast<int32_t>(sizeof(ChromaMemoryOptionsV1))) {
+        WriteErrorMessage(outError, outErrorChars, L"ChromaMemoryOptionsV1.structSize is smaller than required.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (options->hugePageMode < CHROMA_HUGE_PAGES_OFF || options->hugePageMode > CHROMA_HUGE_PAGES_EXPLICIT) {
+        WriteErrorMessage(outError, outErrorChars, L"hugePageMode is not a ChromaHugePageMode value.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (options->maxCachedMegabytesPerArena < 0) {
+        WriteErrorMessage(outError, outErrorChars, L"maxCachedMegabytesPerArena must be >= 0.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_workspaceMutex);
+        g_memoryOptions = *options;
+        g_memoryOptions.structSize = static_cast<int32_t>(sizeof(ChromaMemoryOptionsV1));
+    }
+    TrimWorkspacePool();
+    return CHROMA_STATUS_OK;
 }
 
-CHROMA_API int32_t CHROMA_CALL Chroma_SetActiveConfig(
-    const ChromaConfigV1* config,
+int32_t CHROMA_CALL ChromaRuntime_GetMemoryStats(
+    ChromaMemoryStatsV1* outStats,
     wchar_t* outError,
     const int32_t outErrorChars) {
-    return ChromaRuntime_SetActiveConfig(config, outError, outErrorChars);
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (outStats == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"outStats is null.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (outStats->structSize < static_cast<int32_t>(sizeof(ChromaMemoryStatsV1))) {
+        WriteErrorMessage(outError, outErrorChars, L"ChromaMemoryStatsV1.structSize is smaller than required.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+
+    ChromaMemoryStatsV1 stats{};
+    stats.structSize = static_cast<int32_t>(sizeof(ChromaMemoryStatsV1));
+    std::lock_guard<std::mutex> lock(g_workspaceMutex);
+    stats.idleWorkspaces = static_cast<int32_t>(g_workspacePool.size());
+    for (const std::weak_ptr<vision::ArenaMatAllocator>& weak : g_arenaRegistry) {
+        const std::shared_ptr<vision::ArenaMatAllocator> arena = weak.lock();
+        if (!arena) {
+            continue;
+        }
+        const vision::ArenaStats a = arena->Stats();
+        stats.liveArenas += 1;
+        stats.allocations += a.allocations;
+        stats.reuseHits += a.reuseHits;
+        stats.systemAllocations += a.systemAllocations;
+        stats.hugePageAllocations += a.hugePageAllocations;
+        stats.hugePageFallbacks += a.hugePageFallbacks;
+        stats.bytesInUse += a.bytesInUse;
+        stats.bytesCached += a.bytesCached;
+        stats.peakBytesInUse += a.peakBytesInUse;
+        stats.peakBytesReserved += a.peakBytesReserved;
+    }
+    *outStats = stats;
+    return CHROMA_STATUS_OK;
 }
 
-CHROMA_API int32_t CHROMA_CALL Chroma_ResetConfigToDefault(
+int32_t CHROMA_CALL ChromaRuntime_TrimMemory(
     wchar_t* outError,
     const int32_t outErrorChars) {
-    return ChromaRuntime_ResetConfigToDefault(outError, outErrorChars);
+    WriteErrorMessage(outError, outErrorChars, L"");
+    TrimWorkspacePool();
+    return CHROMA_STATUS_OK;
 }
 
-CHROMA_API int32_t CHROMA_CALL Chroma_LocateBitmapBGRAW(
-    const void* bgraPixels,
-    const int32_t width,
-    const int32_t height,
-    const int32_t strideBytes,
-    ChromaPoint* outPoints,
-    const int32_t outCapacity,
-    int32_t* outTotalFound,
-    int32_t* outWritten,
+int32_t CHROMA_CALL ChromaRuntime_CreateStream(
+    ChromaStream** outStream,
+    const int32_t adaptiveCascade,
     wchar_t* outError,
     const int32_t outErrorChars) {
-    return ChromaRuntime_LocateBitmapBGRAW(
-        bgraPixels,
-        width,
-        height,
-        strideBytes,
-        outPoints,
-        outCapacity,
-        outTotalFound,
-        outWritten,
-        outError,
-        outErrorChars);
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (outStream == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"outStream is null.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    *outStream = nullptr;
+    try {
+        auto stream = std::make_unique<ChromaStream>();
+        stream->workspace = CreateWorkspace();
+        stream->workspace->cascade.adaptive = (adaptiveCascade != 0);
+        *outStream = stream.release();
+        return CHROMA_STATUS_OK;
+    }
+    catch (const std::exception& ex) {
+        WriteErrorMessage(outError, outErrorChars, Utf8ToWide(ex.what()).c_str());
+        return CHROMA_STATUS_RUNTIME_ERROR;
+    }
 }
 
-CHROMA_API int32_t CHROMA_CALL Chroma_LocateBitmapWithConfigBGRAW(
-    const void* bgraPixels,
-    const int32_t width,
-    const int32_t height,
-    const int32_t strideBytes,
-    const ChromaConfigV1* config,
+int32_t CHROMA_CALL ChromaRuntime_DestroyStream(ChromaStream* stream) {
+    delete stream;
+    return CHROMA_STATUS_OK;
+}
+
+int32_t CHROMA_CALL ChromaRuntime_LocateStreamFrame(
+    ChromaStream* stream,
+    const ChromaFrameV1* frame,
     ChromaPoint* outPoints,
     const int32_t outCapacity,
     int32_t* outTotalFound,
     int32_t* outWritten,
     wchar_t* outError,
     const int32_t outErrorChars) {
-    return ChromaRuntime_LocateBitmapWithConfigBGRAW(
-        bgraPixels,
-        width,
-        height,
-        strideBytes,
-        config,
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (stream == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"stream is null.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (frame == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"frame is null.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (frame->structSize < static_cast<int32_t>(sizeof(ChromaFrameV1))) {
+        WriteErrorMessage(outError, outErrorChars, L"ChromaFrameV1.structSize is smaller than required.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (!IsSupportedPixelFormat(frame->pixelFormat)) {
+        WriteErrorMessage(outError, outErrorChars, L"Unsupported pixelFormat.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+
+    const std::shared_ptr<const ActiveConfig> active = GetActiveConfig();
+    const vision::ColorPatternConfig& cfg = active->config;
+    std::lock_guard<std::mutex> lock(stream->mutex);
+    DetectCallOptions options{ stream->workspace.get(), true };
+    options.active = active;
+    options.ringCoverageHint = stream->ringCoverage;
+    options.ringCoverageOut = &stream->ringCoverage;
+    options.loadOut = &stream->load;
+    int32_t total = 0;
+    const int32_t status = LocateFrameImpl(
+        *frame,
+        cfg,
+        options,
+        stream->workspace->frameBgr,
         outPoints,
         outCapacity,
-        outTotalFound,
+        &total,
         outWritten,
         outError,
         outErrorChars);
+    stream->acceptedDetections += static_cast<uint64_t>(total);
+    {
+        std::lock_guard<std::mutex> loadLock(stream->loadMutex);
+        stream->ringCoverageSnapshot = stream->ringCoverage;
+        stream->loadSnapshot = stream->load;
+    }
+    if (outTotalFound != nullptr) {
+        *outTotalFound = total;
+    }
+    return status;
 }
 
-CHROMA_API int32_t CHROMA_CALL Chroma_LocateBitmapWithDebugBGRAW(
+int32_t CHROMA_CALL ChromaRuntime_LocateStreamBGRAW(
+    ChromaStream* stream,
     const void* bgraPixels,
     const int32_t width,
     const int32_t height,
@@ -1089,33 +3263,68 @@ CHROMA_API int32_t CHROMA_CALL Chroma_LocateBitmapWithDebugBGRAW(
     const int32_t outCapacity,
     int32_t* outTotalFound,
     int32_t* outWritten,
-    ChromaDebugImageV1* outDebugImage,
     wchar_t* outError,
     const int32_t outErrorChars) {
-    return ChromaRuntime_LocateBitmapWithDebugBGRAW(
-        bgraPixels,
-        width,
-        height,
-        strideBytes,
+    ChromaFrameV1 frame{};
+    frame.structSize = static_cast<int32_t>(sizeof(ChromaFrameV1));
+    frame.pixelFormat = CHROMA_PIXEL_FORMAT_BGRA8;
+    frame.width = width;
+    frame.height = height;
+    frame.planes[0] = bgraPixels;
+    frame.strideBytes[0] = strideBytes;
+    return ChromaRuntime_LocateStreamFrame(
+        stream,
+        &frame,
         outPoints,
         outCapacity,
         outTotalFound,
         outWritten,
-        outDebugImage,
         outError,
         outErrorChars);
 }
 
-CHROMA_API int32_t CHROMA_CALL Chroma_LocateHBitmap(
-    const void* hBitmap,
+int32_t CHROMA_CALL ChromaRuntime_LocateFrame(
+    const ChromaFrameV1* frame,
+    const ChromaConfigV1* config,
     ChromaPoint* outPoints,
     const int32_t outCapacity,
     int32_t* outTotalFound,
     int32_t* outWritten,
     wchar_t* outError,
     const int32_t outErrorChars) {
-    return ChromaRuntime_LocateHBitmap(
-        hBitmap,
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (frame == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"frame is null.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (frame->structSize < static_cast<int32_t>(sizeof(ChromaFrameV1))) {
+        WriteErrorMessage(outError, outErrorChars, L"ChromaFrameV1.structSize is smaller than required.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (!IsSupportedPixelFormat(frame->pixelFormat)) {
+        WriteErrorMessage(outError, outErrorChars, L"Unsupported pixelFormat.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+
+    DetectCallOptions options;
+    vision::ColorPatternConfig cfg;
+    if (config == nullptr) {
+        options.active = GetActiveConfig();
+        cfg = options.active->config;
+        options.usesActiveConfig = true;
+    } else {
+        const int32_t cfgStatus = BuildConfigFromPointer(config, cfg, outError, outErrorChars);
+        if (cfgStatus != CHROMA_STATUS_OK) {
+            return cfgStatus;
+        }
+    }
+
+    cv::Mat converted;
+    return LocateFrameImpl(
+        *frame,
+        cfg,
+        options,
+        converted,
         outPoints,
         outCapacity,
         outTotalFound,
@@ -1124,26 +3333,1583 @@ CHROMA_API int32_t CHROMA_CALL Chroma_LocateHBitmap(
         outErrorChars);
 }
 
-CHROMA_API int32_t CHROMA_CALL Chroma_LocateHWND(
-    const void* hWnd,
-    const int32_t captureClientArea,
-    ChromaPoint* outPoints,
-    const int32_t outCapacity,
-    int32_t* outTotalFound,
-    int32_t* outWritten,
+int32_t CHROMA_CALL ChromaRuntime_GetStreamStats(
+    ChromaStream* stream,
+    ChromaStreamStatsV1* outStats,
     wchar_t* outError,
     const int32_t outErrorChars) {
-    return ChromaRuntime_LocateHWND(
-        hWnd,
-        captureClientArea,
-        outPoints,
-        outCapacity,
-        outTotalFound,
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (stream == nullptr || outStats == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"stream/outStats is null.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (outStats->structSize < static_cast<int32_t>(sizeof(ChromaStreamStatsV1))) {
+        WriteErrorMessage(outError, outErrorChars, L"ChromaStreamStatsV1.structSize is smaller than required.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+
+    ChromaStreamStatsV1 stats{};
+    stats.structSize = static_cast<int32_t>(sizeof(ChromaStreamStatsV1));
+    std::lock_guard<std::mutex> lock(stream->mutex);
+    const vision::CandidateCascade& cascade = stream->workspace->cascade;
+    for (int i = 0; i < CHROMA_CANDIDATE_TEST_COUNT; ++i) {
+        const vision::CandidateTest test = static_cast<vision::CandidateTest>(i);
+        stats.cascadeOrder[i] = static_cast<int32_t>(cascade.order[static_cast<size_t>(i)]);
+        stats.tests[i].evaluated = cascade.evaluated[static_cast<size_t>(i)];
+        stats.tests[i].rejected = cascade.rejected[static_cast<size_t>(i)];
+        stats.tests[i].rejectionRate = static_cast<float>(cascade.RejectionRate(test));
+        stats.tests[i].meanCostNs = static_cast<float>(cascade.MeanCostNs(test));
+    }
+    stats.frames = cascade.frames;
+    stats.candidates = cascade.candidates;
+    stats.acceptedDetections = stream->acceptedDetections;
+    stats.cascadeReorders = cascade.reorders;
+    *outStats = stats;
+    return CHROMA_STATUS_OK;
+}
+
+int32_t CHROMA_CALL ChromaRuntime_SetStreamTileDedup(
+    ChromaStream* stream,
+    const int32_t enabled,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (stream == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"stream is null.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    std::lock_guard<std::mutex> lock(stream->mutex);
+    vision::TileDedupState& dedup = stream->workspace->tileDedup;
+    dedup.enabled = (enabled != 0);
+    dedup.framesUntilProbe = 0;
+    if (!dedup.enabled) {
+        dedup.Release();
+    }
+    return CHROMA_STATUS_OK;
+}
+
+int32_t CHROMA_CALL ChromaRuntime_SetStreamVerdictCache(
+    ChromaStream* stream,
+    const int32_t enabled,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (stream == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"stream is null.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    std::lock_guard<std::mutex> lock(stream->mutex);
+    vision::VerdictCache& cache = stream->workspace->verdictCache;
+    cache.enabled = (enabled != 0);
+    if (!cache.enabled) {
+        cache.Release();
+    }
+    return CHROMA_STATUS_OK;
+}
+
+int32_t CHROMA_CALL ChromaRuntime_StartStreamPump(
+    ChromaStream* stream,
+    const ChromaStreamPumpOptionsV1* options,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (stream == nullptr || options == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"stream or options is null.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (options->structSize < static_cast<int32_t>(sizeof(ChromaStreamPumpOptionsV1))) {
+        WriteErrorMessage(outError, outErrorChars, L"ChromaStreamPumpOptionsV1.structSize is smaller than required.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (options->policy < CHROMA_BACKPRESSURE_LATEST || options->policy > CHROMA_BACKPRESSURE_BLOCK) {
+        WriteErrorMessage(outError, outErrorChars, L"Unsupported backpressure policy.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (options->policy != CHROMA_BACKPRESSURE_LATEST && options->queueCapacity < 1) {
+        WriteErrorMessage(outError, outErrorChars, L"queueCapacity must be >= 1.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+
+    try {
+        StreamPump::Options pumpOptions;
+        pumpOptions.policy = options->policy;
+        pumpOptions.capacity = static_cast<size_t>(std::max(1, options->queueCapacity));
+        pumpOptions.callback = options->callback;
+        pumpOptions.userData = options->userData;
+        std::shared_ptr<StreamPump> previous;
+        {
+            std::lock_guard<std::mutex> lock(stream->pumpMutex);
+            previous = std::move(stream->pump);
+        }
+        if (previous != nullptr) {
+            previous->Stop();
+        }
+        auto pump = std::make_shared<StreamPump>(stream, stream->pumpResult, pumpOptions);
+        std::lock_guard<std::mutex> lock(stream->pumpMutex);
+        stream->pump = std::move(pump);
+        return CHROMA_STATUS_OK;
+    }
+    catch (const std::exception& ex) {
+        WriteErrorMessage(outError, outErrorChars, Utf8ToWide(ex.what()).c_str());
+        return CHROMA_STATUS_RUNTIME_ERROR;
+    }
+}
+
+int32_t CHROMA_CALL ChromaRuntime_PushStreamFrame(
+    ChromaStream* stream,
+    const ChromaFrameV1* frame,
+    uint64_t* outFrameId,
+    int32_t* outQueued,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (outFrameId != nullptr) {
+        *outFrameId = 0;
+    }
+    if (outQueued != nullptr) {
+        *outQueued = 0;
+    }
+    if (stream == nullptr || frame == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"stream or frame is null.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (frame->structSize < static_cast<int32_t>(sizeof(ChromaFrameV1))) {
+        WriteErrorMessage(outError, outErrorChars, L"ChromaFrameV1.structSize is smaller than required.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (!IsSupportedPixelFormat(frame->pixelFormat)) {
+        WriteErrorMessage(outError, outErrorChars, L"Unsupported pixelFormat.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    const wchar_t* layoutError = nullptr;
+    if (!ValidateFrameLayout(*frame, layoutError)) {
+        WriteErrorMessage(outError, outErrorChars, layoutError);
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+
+    std::shared_ptr<StreamPump> pump;
+    {
+        std::lock_guard<std::mutex> lock(stream->pumpMutex);
+        pump = stream->pump;
+    }
+    if (pump == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"Stream pump is not running.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+
+    try {
+        uint64_t frameId = 0;
+        bool queued = false;
+        if (!pump->Push(*frame, frameId, queued)) {
+            WriteErrorMessage(outError, outErrorChars, L"Stream pump stopped.");
+            return CHROMA_STATUS_RUNTIME_ERROR;
+        }
+        if (outFrameId != nullptr) {
+            *outFrameId = frameId;
+        }
+        if (outQueued != nullptr) {
+            *outQueued = queued ? 1 : 0;
+        }
+        return CHROMA_STATUS_OK;
+    }
+    catch (const std::exception& ex) {
+        WriteErrorMessage(outError, outErrorChars, Utf8ToWide(ex.what()).c_str());
+        return CHROMA_STATUS_RUNTIME_ERROR;
+    }
+}
+
+int32_t CHROMA_CALL ChromaRuntime_GetStreamResult(
+    ChromaStream* stream,
+    uint64_t* outFrameId,
+    ChromaPoint* outPoints,
+    const int32_t outCapacity,
+    int32_t* outTotalFound,
+    int32_t* outWritten,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (outFrameId != nullptr) {
+        *outFrameId = 0;
+    }
+    if (outTotalFound != nullptr) {
+        *outTotalFound = 0;
+    }
+    if (outWritten != nullptr) {
+        *outWritten = 0;
+    }
+    if (stream == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"stream is null.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    const int32_t outputStatus = ValidateOutputArgs(outCapacity, outPoints, outError, outErrorChars);
+    if (outputStatus != CHROMA_STATUS_OK) {
+        return outputStatus;
+    }
+
+    uint64_t frameId = 0;
+    int32_t status = CHROMA_STATUS_OK;
+    int32_t total = 0;
+    std::vector<ChromaPoint> points;
+    {
+        const StreamResult& latest = stream->pumpResult;
+        std::lock_guard<std::mutex> lock(latest.mutex);
+        frameId = latest.frameId;
+        status = latest.status;
+        total = latest.totalFound;
+        points = latest.points;
+    }
+    if (outFrameId != nullptr) {
+        *outFrameId = frameId;
+    }
+    (void)WriteLocateOutputs(points, outPoints, outCapacity, nullptr, outWritten, outError, outErrorChars);
+    if (outTotalFound != nullptr) {
+        *outTotalFound = total;
+    }
+    // The stored list may hold fewer points than were found; the caller's buffer is
+    // too small only when it cannot hold the full total.
+    if (outPoints != nullptr && outCapacity > 0 && outCapacity < total) {
+        WriteErrorMessage(outError, outErrorChars, L"Output buffer too small.");
+        return CHROMA_STATUS_BUFFER_TOO_SMALL;
+    }
+    if (status != CHROMA_STATUS_OK) {
+        WriteErrorMessage(outError, outErrorChars, L"Detection of the newest frame failed.");
+    }
+    return status;
+}
+
+int32_t CHROMA_CALL ChromaRuntime_GetStreamPumpStats(
+    ChromaStream* stream,
+    ChromaStreamPumpStatsV1* outStats,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (stream == nullptr || outStats == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"stream or outStats is null.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (outStats->structSize < static_cast<int32_t>(sizeof(ChromaStreamPumpStatsV1))) {
+        WriteErrorMessage(outError, outErrorChars, L"ChromaStreamPumpStatsV1.structSize is smaller than required.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+
+    std::shared_ptr<StreamPump> pump;
+    {
+        std::lock_guard<std::mutex> lock(stream->pumpMutex);
+        pump = stream->pump;
+    }
+    ChromaStreamPumpStatsV1 stats{};
+    stats.structSize = static_cast<int32_t>(sizeof(ChromaStreamPumpStatsV1));
+    if (pump != nullptr) {
+        size_t depth = 0;
+        const PumpTotals totals = pump->Totals(depth);
+        stats.running = 1;
+        stats.policy = pump->Policy();
+        stats.queueDepth = static_cast<int32_t>(depth);
+        stats.framesPushed = totals.framesPushed;
+        stats.framesProcessed = totals.framesProcessed;
+        stats.framesDropped = totals.framesDropped;
+        stats.producerBlocks = totals.producerBlocks;
+        stats.producerWaitUs = totals.producerWaitNs / 1000;
+        stats.meanQueueAgeUs = totals.framesProcessed > 0 ? totals.queueAgeNsTotal / totals.framesProcessed / 1000 : 0;
+        stats.maxQueueAgeUs = totals.queueAgeNsMax / 1000;
+        stats.lastQueueAgeUs = totals.lastQueueAgeNs / 1000;
+        stats.lastDetectUs = totals.lastDetectNs / 1000;
+    }
+    *outStats = stats;
+    return CHROMA_STATUS_OK;
+}
+
+int32_t CHROMA_CALL ChromaRuntime_StopStreamPump(
+    ChromaStream* stream,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (stream == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"stream is null.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    std::shared_ptr<StreamPump> pump;
+    {
+        std::lock_guard<std::mutex> lock(stream->pumpMutex);
+        pump = std::move(stream->pump);
+    }
+    if (pump != nullptr) {
+        pump->Stop();
+    }
+    return CHROMA_STATUS_OK;
+}
+
+int32_t CHROMA_CALL ChromaRuntime_GetStreamTileDedupStats(
+    ChromaStream* stream,
+    ChromaTileDedupStatsV1* outStats,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (stream == nullptr || outStats == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"stream/outStats is null.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (outStats->structSize < static_cast<int32_t>(sizeof(ChromaTileDedupStatsV1))) {
+        WriteErrorMessage(outError, outErrorChars, L"ChromaTileDedupStatsV1.structSize is smaller than required.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+
+    ChromaTileDedupStatsV1 stats{};
+    stats.structSize = static_cast<int32_t>(sizeof(ChromaTileDedupStatsV1));
+    std::lock_guard<std::mutex> lock(stream->mutex);
+    const vision::TileDedupState& dedup = stream->workspace->tileDedup;
+    stats.enabled = dedup.enabled ? 1 : 0;
+    stats.lastFrameRan = dedup.last.ran ? 1 : 0;
+    stats.lastFrameTiles = dedup.last.tiles;
+    stats.lastFrameDuplicateTiles = dedup.last.duplicateTiles;
+    stats.lastFrameHitRate = dedup.last.HitRate();
+    stats.lastFrameOverheadMs = static_cast<float>(dedup.last.overheadMs);
+    stats.lastFrameSavedMs = static_cast<float>(dedup.last.savedMs);
+    stats.framesRun = dedup.framesRun;
+    stats.framesBypassed = dedup.framesBypassed;
+    stats.tiles = dedup.tiles;
+    stats.duplicateTiles = dedup.duplicateTiles;
+    stats.backoffs = dedup.backoffs;
+    *outStats = stats;
+    return CHROMA_STATUS_OK;
+}
+
+int32_t CHROMA_CALL ChromaRuntime_GetStreamVerdictCacheStats(
+    ChromaStream* stream,
+    ChromaVerdictCacheStatsV1* outStats,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (stream == nullptr || outStats == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"stream/outStats is null.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (outStats->structSize < static_cast<int32_t>(sizeof(ChromaVerdictCacheStatsV1))) {
+        WriteErrorMessage(outError, outErrorChars, L"ChromaVerdictCacheStatsV1.structSize is smaller than required.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+
+    ChromaVerdictCacheStatsV1 stats{};
+    stats.structSize = static_cast<int32_t>(sizeof(ChromaVerdictCacheStatsV1));
+    std::lock_guard<std::mutex> lock(stream->mutex);
+    const vision::VerdictCache& cache = stream->workspace->verdictCache;
+    stats.enabled = cache.enabled ? 1 : 0;
+    stats.entries = static_cast<int32_t>(cache.entries.size());
+    stats.lastFrameLookups = cache.lastFrameLookups;
+    stats.lastFrameHits = cache.lastFrameHits;
+    stats.lastFrameHitRate = cache.lastFrameLookups > 0
+        ? static_cast<float>(cache.lastFrameHits) / static_cast<float>(cache.lastFrameLookups)
+        : 0.0F;
+    stats.hitRate = cache.HitRate();
+    stats.frames = cache.frames;
+    stats.lookups = cache.lookups;
+    stats.hits = cache.hits;
+    stats.inserts = cache.inserts;
+    stats.evictions = cache.evictions;
+    *outStats = stats;
+    return CHROMA_STATUS_OK;
+}
+
+int32_t CHROMA_CALL ChromaRuntime_CreateRegionMap(
+    const ChromaRegionV1* regions,
+    const int32_t regionCount,
+    ChromaRegionMap** outMap,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (outMap == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"outMap is null.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    *outMap = nullptr;
+    if (regions == nullptr || regionCount <= 0) {
+        WriteErrorMessage(outError, outErrorChars, L"regions must hold at least one region.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+
+    std::vector<vision::PatternRegion> patternRegions(static_cast<size_t>(regionCount));
+    for (int32_t i = 0; i < regionCount; ++i) {
+        const ChromaRegionV1& region = regions[i];
+        if (region.structSize < static_cast<int32_t>(sizeof(ChromaRegionV1))) {
+            WriteErrorMessage(outError, outErrorChars, L"ChromaRegionV1.structSize is smaller than required.");
+            return CHROMA_STATUS_INVALID_ARGUMENT;
+        }
+        if (region.config == nullptr) {
+            WriteErrorMessage(outError, outErrorChars, Utf8ToWide("region " + std::to_string(i) + ": config is null.").c_str());
+            return CHROMA_STATUS_INVALID_ARGUMENT;
+        }
+        vision::PatternRegion& out = patternRegions[static_cast<size_t>(i)];
+        out.rectPx = cv::Rect(region.x, region.y, region.width, region.height);
+        std::string error;
+        const int32_t status = ConvertApiConfigToPattern(*region.config, out.config, error);
+        if (status != CHROMA_STATUS_OK) {
+            WriteErrorMessage(outError, outErrorChars, Utf8ToWide("region " + std::to_string(i) + ": " + error).c_str());
+            return status;
+        }
+    }
+
+    try {
+        auto map = std::make_unique<ChromaRegionMap>();
+        map->finder = std::make_unique<vision::RegionPatternFinder>(std::move(patternRegions));
+        *outMap = map.release();
+        return CHROMA_STATUS_OK;
+    }
+    catch (const std::invalid_argument& ex) {
+        WriteErrorMessage(outError, outErrorChars, Utf8ToWide(ex.what()).c_str());
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    catch (const std::exception& ex) {
+        WriteErrorMessage(outError, outErrorChars, Utf8ToWide(ex.what()).c_str());
+        return CHROMA_STATUS_RUNTIME_ERROR;
+    }
+}
+
+int32_t CHROMA_CALL ChromaRuntime_DestroyRegionMap(ChromaRegionMap* map) {
+    delete map;
+    return CHROMA_STATUS_OK;
+}
+
+int32_t CHROMA_CALL ChromaRuntime_LocateRegionsBGRAW(
+    const ChromaRegionMap* map,
+    const void* bgraPixels,
+    const int32_t width,
+    const int32_t height,
+    const int32_t strideBytes,
+    ChromaPoint* outPoints,
+    const int32_t outCapacity,
+    int32_t* outTotalFound,
+    int32_t* outWritten,
+    int32_t* outRegionIndices,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (outTotalFound != nullptr) {
+        *outTotalFound = 0;
+    }
+    if (outWritten != nullptr) {
+        *outWritten = 0;
+    }
+    if (map == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"map is null.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    cv::Mat scene;
+    const int32_t viewStatus = ViewBgraBuffer(bgraPixels, width, height, strideBytes, scene, outError, outErrorChars);
+    if (viewStatus != CHROMA_STATUS_OK) {
+        return viewStatus;
+    }
+    const int32_t outputStatus = ValidateOutputArgs(outCapacity, outPoints, outError, outErrorChars);
+    if (outputStatus != CHROMA_STATUS_OK) {
+        return outputStatus;
+    }
+
+    std::vector<ChromaPoint> centers;
+    std::vector<int32_t> regionIndices;
+    try {
+        PooledWorkspace pooled;
+        const vision::ColorPatternRunResult result = map->finder->Find(scene, pooled.Get());
+        centers.reserve(static_cast<size_t>(result.acceptedCount));
+        regionIndices.reserve(static_cast<size_t>(result.acceptedCount));
+        for (const vision::ColorPatternDetection& det : result.detections) {
+            if (det.metrics.accepted) {
+                centers.push_back(ChromaPoint{ det.centerPx.x, det.centerPx.y });
+                regionIndices.push_back(det.region);
+            }
+        }
+    }
+    catch (const std::exception& ex) {
+        const std::wstring wmsg = Utf8ToWide(ex.what());
+        WriteErrorMessage(outError, outErrorChars, wmsg.empty() ? L"Runtime error." : wmsg.c_str());
+        return CHROMA_STATUS_RUNTIME_ERROR;
+    }
+    catch (...) {
+        WriteErrorMessage(outError, outErrorChars, L"Unknown runtime error.");
+        return CHROMA_STATUS_RUNTIME_ERROR;
+    }
+
+    const int32_t status = WriteLocateOutputs(centers, outPoints, outCapacity, outTotalFound, outWritten, outError, outErrorChars);
+    if (outRegionIndices != nullptr && outPoints != nullptr) {
+        const size_t written = std::min(centers.size(), static_cast<size_t>(std::max(0, outCapacity)));
+        std::copy(regionIndices.begin(), regionIndices.begin() + static_cast<std::ptrdiff_t>(written), outRegionIndices);
+    }
+    return status;
+}
+
+int32_t CHROMA_CALL ChromaRuntime_StartShadowConfig(
+    const ChromaConfigV1* config,
+    const ChromaShadowOptionsV1* options,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (options == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"options is null.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (options->structSize < static_cast<int32_t>(sizeof(ChromaShadowOptionsV1))) {
+        WriteErrorMessage(outError, outErrorChars, L"ChromaShadowOptionsV1.structSize is smaller than required.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (options->sampleIntervalFrames < 1 || options->queueCapacity < 1 || options->matchRadiusPx < 0) {
+        WriteErrorMessage(outError, outErrorChars, L"sampleIntervalFrames and queueCapacity must be >= 1, matchRadiusPx >= 0.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+
+    try {
+        vision::ColorPatternConfig cfg;
+        const int32_t status = BuildConfigFromPointer(config, cfg, outError, outErrorChars);
+        if (status != CHROMA_STATUS_OK) {
+            return status;
+        }
+        g_shadow.Start(std::move(cfg), options->sampleIntervalFrames, options->queueCapacity, options->matchRadiusPx);
+        return CHROMA_STATUS_OK;
+    }
+    catch (const std::exception& ex) {
+        WriteErrorMessage(outError, outErrorChars, Utf8ToWide(ex.what()).c_str());
+        return CHROMA_STATUS_RUNTIME_ERROR;
+    }
+}
+
+int32_t CHROMA_CALL ChromaRuntime_StopShadowConfig(
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    WriteErrorMessage(outError, outErrorChars, L"");
+    g_shadow.Stop();
+    return CHROMA_STATUS_OK;
+}
+
+int32_t CHROMA_CALL ChromaRuntime_GetShadowStats(
+    ChromaShadowStatsV1* outStats,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (outStats == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"outStats is null.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (outStats->structSize < static_cast<int32_t>(sizeof(ChromaShadowStatsV1))) {
+        WriteErrorMessage(outError, outErrorChars, L"ChromaShadowStatsV1.structSize is smaller than required.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+
+    bool running = false;
+    const ShadowTotals totals = g_shadow.Totals(running);
+    ChromaShadowStatsV1 stats{};
+    stats.structSize = static_cast<int32_t>(sizeof(ChromaShadowStatsV1));
+    stats.running = running ? 1 : 0;
+    stats.framesSampled = totals.framesSampled;
+    stats.framesEvaluated = totals.framesEvaluated;
+    stats.framesDropped = totals.framesDropped;
+    stats.framesFailed = totals.framesFailed;
+    stats.framesDiverged = totals.framesDiverged;
+    stats.primaryDetections = totals.primaryDetections;
+    stats.shadowDetections = totals.shadowDetections;
+    stats.addedDetections = totals.addedDetections;
+    stats.lostDetections = totals.lostDetections;
+    const double frames = static_cast<double>(std::max<uint64_t>(1, totals.framesEvaluated));
+    for (int i = 0; i < CHROMA_PIPELINE_STAGE_COUNT; ++i) {
+        stats.meanPrimaryStageMs[i] = static_cast<float>(totals.primaryMsSum.ms[static_cast<size_t>(i)] / frames);
+        stats.meanShadowStageMs[i] = static_cast<float>(totals.shadowMsSum.ms[static_cast<size_t>(i)] / frames);
+    }
+    *outStats = stats;
+    return CHROMA_STATUS_OK;
+}
+
+int32_t CHROMA_CALL ChromaRuntime_StartSentinel(
+    const ChromaSentinelOptionsV1* options,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (options == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"options is null.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (options->structSize < static_cast<int32_t>(sizeof(ChromaSentinelOptionsV1))) {
+        WriteErrorMessage(outError, outErrorChars, L"ChromaSentinelOptionsV1.structSize is smaller than required.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (options->spoolDirectory == nullptr || options->spoolDirectory[0] == L'\0') {
+        WriteErrorMessage(outError, outErrorChars, L"spoolDirectory is empty.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (options->latencyThresholdUs <= 0 && options->candidateThreshold <= 0) {
+        WriteErrorMessage(outError, outErrorChars, L"At least one of latencyThresholdUs and candidateThreshold must be > 0.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (options->queueCapacity < 1 || options->maxSpoolCaptures < 1 ||
+        options->maxSpoolMegabytes < 0 || options->minIntervalMs < 0) {
+        WriteErrorMessage(outError, outErrorChars, L"queueCapacity and maxSpoolCaptures must be >= 1, maxSpoolMegabytes and minIntervalMs >= 0.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+
+    try {
+        SlowFrameSentinel::Options sentinel;
+        sentinel.latencyThresholdMs = options->latencyThresholdUs > 0 ? options->latencyThresholdUs / 1000.0 : 0.0;
+        sentinel.candidateThreshold = options->candidateThreshold;
+        sentinel.queueCapacity = static_cast<size_t>(options->queueCapacity);
+        sentinel.maxCaptures = static_cast<size_t>(options->maxSpoolCaptures);
+        sentinel.maxBytes = static_cast<uint64_t>(options->maxSpoolMegabytes) << 20;
+        sentinel.minIntervalNs = static_cast<int64_t>(options->minIntervalMs) * 1000000;
+        sentinel.directory = std::filesystem::path(std::wstring(options->spoolDirectory));
+        g_sentinel.Start(std::move(sentinel));
+        return CHROMA_STATUS_OK;
+    }
+    catch (const std::exception& ex) {
+        WriteErrorMessage(outError, outErrorChars, Utf8ToWide(ex.what()).c_str());
+        return CHROMA_STATUS_RUNTIME_ERROR;
+    }
+}
+
+int32_t CHROMA_CALL ChromaRuntime_StopSentinel(
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    WriteErrorMessage(outError, outErrorChars, L"");
+    g_sentinel.Stop();
+    return CHROMA_STATUS_OK;
+}
+
+int32_t CHROMA_CALL ChromaRuntime_GetSentinelStats(
+    ChromaSentinelStatsV1* outStats,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (outStats == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"outStats is null.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (outStats->structSize < static_cast<int32_t>(sizeof(ChromaSentinelStatsV1))) {
+        WriteErrorMessage(outError, outErrorChars, L"ChromaSentinelStatsV1.structSize is smaller than required.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+
+    bool running = false;
+    const SentinelTotals totals = g_sentinel.Totals(running);
+    ChromaSentinelStatsV1 stats{};
+    stats.structSize = static_cast<int32_t>(sizeof(ChromaSentinelStatsV1));
+    stats.running = running ? 1 : 0;
+    stats.latencyTriggers = totals.latencyTriggers;
+    stats.candidateTriggers = totals.candidateTriggers;
+    stats.framesCaptured = totals.framesCaptured;
+    stats.framesSkipped = totals.framesSkipped;
+    stats.writeFailures = totals.writeFailures;
+    stats.capturesEvicted = totals.capturesEvicted;
+    stats.spoolCaptures = totals.spoolCaptures;
+    stats.spoolBytes = totals.spoolBytes;
+    *outStats = stats;
+    return CHROMA_STATUS_OK;
+}
+
+int32_t CHROMA_CALL ChromaRuntime_StartConfigWatch(
+    const ChromaConfigWatchOptionsV1* options,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (options == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"options is null.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (options->structSize < static_cast<int32_t>(sizeof(ChromaConfigWatchOptionsV1))) {
+        WriteErrorMessage(outError, outErrorChars, L"ChromaConfigWatchOptionsV1.structSize is smaller than required.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (options->path == nullptr || options->path[0] == L'\0') {
+        WriteErrorMessage(outError, outErrorChars, L"path is empty.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (options->pollIntervalMs < 1 || options->warmupWidth < 0 || options->warmupHeight < 0 ||
+        (options->warmupWidth == 0) != (options->warmupHeight == 0)) {
+        WriteErrorMessage(outError, outErrorChars, L"pollIntervalMs must be >= 1; warmupWidth/warmupHeight must both be 0 or both > 0.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+
+    try {
+        ConfigFileWatcher::Options watch;
+        watch.path = std::filesystem::path(std::wstring(options->path));
+        watch.pollIntervalMs = options->pollIntervalMs;
+        watch.warmupSize = cv::Size(options->warmupWidth, options->warmupHeight);
+        std::string error;
+        if (!g_configWatcher.Start(std::move(watch), error)) {
+            WriteErrorMessage(outError, outErrorChars, Utf8ToWide(error).c_str());
+            return CHROMA_STATUS_CONFIG_ERROR;
+        }
+        return CHROMA_STATUS_OK;
+    }
+    catch (const std::exception& ex) {
+        WriteErrorMessage(outError, outErrorChars, Utf8ToWide(ex.what()).c_str());
+        return CHROMA_STATUS_RUNTIME_ERROR;
+    }
+}
+
+int32_t CHROMA_CALL ChromaRuntime_StopConfigWatch(
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    WriteErrorMessage(outError, outErrorChars, L"");
+    g_configWatcher.Stop();
+    return CHROMA_STATUS_OK;
+}
+
+int32_t CHROMA_CALL ChromaRuntime_GetConfigWatchStats(
+    ChromaConfigWatchStatsV1* outStats,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (outStats == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"outStats is null.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (outStats->structSize < static_cast<int32_t>(sizeof(ChromaConfigWatchStatsV1))) {
+        WriteErrorMessage(outError, outErrorChars, L"ChromaConfigWatchStatsV1.structSize is smaller than required.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+
+    bool running = false;
+    const ConfigWatchTotals totals = g_configWatcher.Totals(running);
+    ChromaConfigWatchStatsV1 stats{};
+    stats.structSize = static_cast<int32_t>(sizeof(ChromaConfigWatchStatsV1));
+    stats.running = running ? 1 : 0;
+    stats.reloads = totals.reloads;
+    stats.rejected = totals.rejected;
+    stats.lastLoadUs = totals.lastLoadUs;
+    WriteErrorMessage(stats.lastError, CHROMA_CONFIG_WATCH_ERROR_CHARS, Utf8ToWide(totals.lastError).c_str());
+    *outStats = stats;
+    return CHROMA_STATUS_OK;
+}
+
+int32_t CHROMA_CALL ChromaRuntime_GetRuntimeStats(
+    ChromaRuntimeStatsV1* outStats,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (outStats == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"outStats is null.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (outStats->structSize < static_cast<int32_t>(sizeof(ChromaRuntimeStatsV1))) {
+        WriteErrorMessage(outError, outErrorChars, L"ChromaRuntimeStatsV1.structSize is smaller than required.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    ChromaRuntimeStatsV1 stats{};
+    stats.structSize = static_cast<int32_t>(sizeof(ChromaRuntimeStatsV1));
+    stats.configLockAcquisitions = g_cfgLockAcquisitions.load(std::memory_order_relaxed);
+    stats.configLockContended = g_cfgLockContended.load(std::memory_order_relaxed);
+    stats.configLockWaitNs = g_cfgLockWaitNs.load(std::memory_order_relaxed);
+    stats.configLockHoldNs = g_cfgLockHoldNs.load(std::memory_order_relaxed);
+    *outStats = stats;
+    return CHROMA_STATUS_OK;
+}
+
+int32_t CHROMA_CALL ChromaRuntime_ResetRuntimeStats() {
+    g_cfgLockAcquisitions.store(0);
+    g_cfgLockContended.store(0);
+    g_cfgLockWaitNs.store(0);
+    g_cfgLockHoldNs.store(0);
+    return CHROMA_STATUS_OK;
+}
+
+int32_t CHROMA_CALL ChromaRuntime_MeasureCoverageGrid(
+    const void* bgraPixels,
+    const int32_t width,
+    const int32_t height,
+    const int32_t strideBytes,
+    const ChromaConfigV1* config,
+    const int32_t gridCols,
+    const int32_t gridRows,
+    const int32_t applyMorphology,
+    ChromaCoverageCell* outCells,
+    const int32_t outCellCapacity,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (gridCols < 1 || gridRows < 1 || gridCols > width || gridRows > height) {
+        WriteErrorMessage(outError, outErrorChars, L"gridCols/gridRows must be in [1, width] / [1, height].");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    const int64_t cellCount = static_cast<int64_t>(gridCols) * gridRows;
+    if (outCells == nullptr || outCellCapacity < cellCount) {
+        WriteErrorMessage(outError, outErrorChars, L"outCells must hold gridCols*gridRows cells.");
+        return outCells == nullptr ? CHROMA_STATUS_INVALID_ARGUMENT : CHROMA_STATUS_BUFFER_TOO_SMALL;
+    }
+
+    cv::Mat scene;
+    const int32_t viewStatus = ViewBgraBuffer(bgraPixels, width, height, strideBytes, scene, outError, outErrorChars);
+    if (viewStatus != CHROMA_STATUS_OK) {
+        return viewStatus;
+    }
+
+    vision::ColorPatternConfig cfg;
+    std::shared_ptr<const ActiveConfig> active;
+    if (config == nullptr) {
+        active = GetActiveConfig();
+        cfg = active->config;
+    } else {
+        const int32_t cfgStatus = BuildConfigFromPointer(config, cfg, outError, outErrorChars);
+        if (cfgStatus != CHROMA_STATUS_OK) {
+            return cfgStatus;
+        }
+    }
+
+    try {
+        vision::PlanHints hints;
+        hints.renderDebug = false;
+        const vision::ColorPatternFinder finder = active != nullptr
+            ? vision::ColorPatternFinder(cfg, active->plan, hints)
+            : vision::ColorPatternFinder(cfg, hints);
+        PooledWorkspace pooled;
+        const vision::CoverageGrid grid = finder.MeasureCoverage(scene, pooled.Get(), gridCols, gridRows, applyMorphology != 0);
+        for (size_t i = 0; i < grid.cells.size(); ++i) {
+            outCells[i] = ChromaCoverageCell{ grid.cells[i].center, grid.cells[i].support, grid.cells[i].exclude };
+        }
+        return CHROMA_STATUS_OK;
+    }
+    catch (const std::exception& ex) {
+        const std::wstring wmsg = Utf8ToWide(ex.what());
+        WriteErrorMessage(outError, outErrorChars, wmsg.empty() ? L"Runtime error." : wmsg.c_str());
+        return CHROMA_STATUS_RUNTIME_ERROR;
+    }
+    catch (...) {
+        WriteErrorMessage(outError, outErrorChars, L"Unknown runtime error.");
+        return CHROMA_STATUS_RUNTIME_ERROR;
+    }
+}
+
+int32_t CHROMA_CALL ChromaRuntime_ExplainConfig(
+    const ChromaConfigV1* config,
+    const int32_t renderDebug,
+    wchar_t* outText,
+    const int32_t outTextChars,
+    int32_t* outRequiredChars,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (outRequiredChars != nullptr) {
+        *outRequiredChars = 0;
+    }
+
+    vision::ColorPatternConfig cfg;
+    std::shared_ptr<const ActiveConfig> active;
+    if (config == nullptr) {
+        active = GetActiveConfig();
+        cfg = active->config;
+    } else {
+        const int32_t cfgStatus = BuildConfigFromPointer(config, cfg, outError, outErrorChars);
+        if (cfgStatus != CHROMA_STATUS_OK) {
+            return cfgStatus;
+        }
+    }
+
+    try {
+        vision::PlanHints hints;
+        hints.renderDebug = (renderDebug != 0);
+        vision::PipelinePlan plan = active != nullptr ? active->plan : vision::ColorPatternFinder::CompileConfig(cfg);
+        vision::ColorPatternFinder::ApplyHints(plan, hints);
+        const std::wstring text = Utf8ToWide(plan.Explain());
+        const int32_t required = static_cast<int32_t>(text.size() + 1);
+        if (outRequiredChars != nullptr) {
+            *outRequiredChars = required;
+        }
+        if (outText == nullptr || outTextChars < required) {
+            WriteErrorMessage(outError, outErrorChars, L"Output buffer too small.");
+            return CHROMA_STATUS_BUFFER_TOO_SMALL;
+        }
+        std::copy(text.begin(), text.end(), outText);
+        outText[text.size()] = L'\0';
+        return CHROMA_STATUS_OK;
+    }
+    catch (const std::exception& ex) {
+        const std::wstring wmsg = Utf8ToWide(ex.what());
+        WriteErrorMessage(outError, outErrorChars, wmsg.empty() ? L"Runtime error." : wmsg.c_str());
+        return CHROMA_STATUS_RUNTIME_ERROR;
+    }
+}
+
+int32_t CHROMA_CALL ChromaRuntime_EstimateCost(
+    ChromaStream* stream,
+    const int32_t width,
+    const int32_t height,
+    const int32_t pixelFormat,
+    const ChromaConfigV1* config,
+    ChromaCostEstimateV1* outEstimate,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    WriteErrorMessage(outError, outErrorChars, L"");
+    if (outEstimate == nullptr) {
+        WriteErrorMessage(outError, outErrorChars, L"outEstimate is null.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (outEstimate->structSize < static_cast<int32_t>(sizeof(ChromaCostEstimateV1))) {
+        WriteErrorMessage(outError, outErrorChars, L"ChromaCostEstimateV1.structSize is smaller than required.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (width <= 0 || height <= 0) {
+        WriteErrorMessage(outError, outErrorChars, L"width/height must be > 0.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+    if (!IsSupportedPixelFormat(pixelFormat)) {
+        WriteErrorMessage(outError, outErrorChars, L"Unsupported pixelFormat.");
+        return CHROMA_STATUS_INVALID_ARGUMENT;
+    }
+
+    vision::ColorPatternConfig cfg;
+    std::shared_ptr<const ActiveConfig> active;
+    if (config == nullptr) {
+        active = GetActiveConfig();
+        cfg = active->config;
+    } else {
+        const int32_t cfgStatus = BuildConfigFromPointer(config, cfg, outError, outErrorChars);
+        if (cfgStatus != CHROMA_STATUS_OK) {
+            return cfgStatus;
+        }
+    }
+
+    try {
+        vision::PlanHints hints;
+        hints.renderDebug = false;
+        vision::RecentLoad load;
+        if (stream != nullptr) {
+            std::lock_guard<std::mutex> lock(stream->loadMutex);
+            hints.expectedRingCoverage = stream->ringCoverageSnapshot;
+            load = stream->loadSnapshot;
+        }
+        vision::PipelinePlan plan = active != nullptr ? active->plan : vision::ColorPatternFinder::CompileConfig(cfg);
+        vision::ColorPatternFinder::ApplyHints(plan, hints);
+        const vision::CostEstimate estimate = g_costModel.Estimate(
+            plan,
+            cv::Size(width, height),
+            CostInputFor(pixelFormat),
+            stream != nullptr ? &load : nullptr);
+
+        ChromaCostEstimateV1 out{};
+        out.structSize = static_cast<int32_t>(sizeof(ChromaCostEstimateV1));
+        out.calibrated = estimate.calibrated ? 1 : 0;
+        for (int i = 0; i < CHROMA_PIPELINE_STAGE_COUNT; ++i) {
+            out.stageUs[i] = static_cast<float>(estimate.stages.ms[static_cast<size_t>(i)] * 1000.0);
+        }
+        out.totalUs = out.stageUs[CHROMA_STAGE_TOTAL];
+        out.expectedCandidates = static_cast<float>(estimate.candidates);
+        out.expectedContextCoverage = static_cast<float>(estimate.contextCoverage);
+        out.modelError = static_cast<float>(estimate.modelError);
+        out.samples = estimate.samples;
+        *outEstimate = out;
+        return CHROMA_STATUS_OK;
+    }
+    catch (const std::exception& ex) {
+        const std::wstring wmsg = Utf8ToWide(ex.what());
+        WriteErrorMessage(outError, outErrorChars, wmsg.empty() ? L"Runtime error." : wmsg.c_str());
+        return CHROMA_STATUS_RUNTIME_ERROR;
+    }
+}
+
+int32_t CHROMA_CALL ChromaRuntime_ResetCostModel() {
+    g_costModel.Reset();
+    return CHROMA_STATUS_OK;
+}
+
+#ifndef CHROMA_RUNTIME_ONLY
+CHROMA_API int32_t CHROMA_CALL Chroma_GetApiVersion() {
+    return ChromaRuntime_GetApiVersion();
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_GetConfigStructSize() {
+    return ChromaRuntime_GetConfigStructSize();
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_GetDefaultConfig(
+    ChromaConfigV1* outConfig,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_GetDefaultConfig(outConfig, outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_GetActiveConfig(
+    ChromaConfigV1* outConfig,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_GetActiveConfig(outConfig, outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_SetActiveConfig(
+    const ChromaConfigV1* config,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_SetActiveConfig(config, outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_ResetConfigToDefault(
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_ResetConfigToDefault(outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_LocateBitmapBGRAW(
+    const void* bgraPixels,
+    const int32_t width,
+    const int32_t height,
+    const int32_t strideBytes,
+    ChromaPoint* outPoints,
+    const int32_t outCapacity,
+    int32_t* outTotalFound,
+    int32_t* outWritten,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_LocateBitmapBGRAW(
+        bgraPixels,
+        width,
+        height,
+        strideBytes,
+        outPoints,
+        outCapacity,
+        outTotalFound,
+        outWritten,
+        outError,
+        outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_LocateBitmapWithConfigBGRAW(
+    const void* bgraPixels,
+    const int32_t width,
+    const int32_t height,
+    const int32_t strideBytes,
+    const ChromaConfigV1* config,
+    ChromaPoint* outPoints,
+    const int32_t outCapacity,
+    int32_t* outTotalFound,
+    int32_t* outWritten,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_LocateBitmapWithConfigBGRAW(
+        bgraPixels,
+        width,
+        height,
+        strideBytes,
+        config,
+        outPoints,
+        outCapacity,
+        outTotalFound,
+        outWritten,
+        outError,
+        outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_LocateBitmapWithDebugBGRAW(
+    const void* bgraPixels,
+    const int32_t width,
+    const int32_t height,
+    const int32_t strideBytes,
+    ChromaPoint* outPoints,
+    const int32_t outCapacity,
+    int32_t* outTotalFound,
+    int32_t* outWritten,
+    ChromaDebugImageV1* outDebugImage,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_LocateBitmapWithDebugBGRAW(
+        bgraPixels,
+        width,
+        height,
+        strideBytes,
+        outPoints,
+        outCapacity,
+        outTotalFound,
+        outWritten,
+        outDebugImage,
+        outError,
+        outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_LocateBitmapWithDebugOptionsBGRAW(
+    const void* bgraPixels,
+    const int32_t width,
+    const int32_t height,
+    const int32_t strideBytes,
+    const ChromaDebugOptionsV1* debugOptions,
+    ChromaPoint* outPoints,
+    const int32_t outCapacity,
+    int32_t* outTotalFound,
+    int32_t* outWritten,
+    ChromaDebugImageV1* outDebugImage,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_LocateBitmapWithDebugOptionsBGRAW(
+        bgraPixels,
+        width,
+        height,
+        strideBytes,
+        debugOptions,
+        outPoints,
+        outCapacity,
+        outTotalFound,
+        outWritten,
+        outDebugImage,
+        outError,
+        outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_LocateBitmapWithBlobStatsBGRAW(
+    const void* bgraPixels,
+    const int32_t width,
+    const int32_t height,
+    const int32_t strideBytes,
+    const ChromaConfigV1* config,
+    ChromaPoint* outPoints,
+    ChromaBlobStatsV1* outStats,
+    const int32_t outCapacity,
+    int32_t* outTotalFound,
+    int32_t* outWritten,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_LocateBitmapWithBlobStatsBGRAW(
+        bgraPixels,
+        width,
+        height,
+        strideBytes,
+        config,
+        outPoints,
+        outStats,
+        outCapacity,
+        outTotalFound,
+        outWritten,
+        outError,
+        outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_LocateNearestBGRAW(
+    const void* bgraPixels,
+    const int32_t width,
+    const int32_t height,
+    const int32_t strideBytes,
+    const ChromaConfigV1* config,
+    const int32_t focusX,
+    const int32_t focusY,
+    ChromaNearestResultV1* outResult,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_LocateNearestBGRAW(
+        bgraPixels,
+        width,
+        height,
+        strideBytes,
+        config,
+        focusX,
+        focusY,
+        outResult,
+        outError,
+        outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_LocateHBitmap(
+    const void* hBitmap,
+    ChromaPoint* outPoints,
+    const int32_t outCapacity,
+    int32_t* outTotalFound,
+    int32_t* outWritten,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_LocateHBitmap(
+        hBitmap,
+        outPoints,
+        outCapacity,
+        outTotalFound,
+        outWritten,
+        outError,
+        outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_LocateHWND(
+    const void* hWnd,
+    const int32_t captureClientArea,
+    ChromaPoint* outPoints,
+    const int32_t outCapacity,
+    int32_t* outTotalFound,
+    int32_t* outWritten,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_LocateHWND(
+        hWnd,
+        captureClientArea,
+        outPoints,
+        outCapacity,
+        outTotalFound,
+        outWritten,
+        outError,
+        outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_Warmup(
+    const int32_t width,
+    const int32_t height,
+    const int32_t pixelFormat,
+    const int32_t workspaceCount,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_Warmup(width, height, pixelFormat, workspaceCount, outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_TrimMemory(
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_TrimMemory(outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_GetMemoryOptions(
+    ChromaMemoryOptionsV1* outOptions,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_GetMemoryOptions(outOptions, outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_SetMemoryOptions(
+    const ChromaMemoryOptionsV1* options,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_SetMemoryOptions(options, outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_GetMemoryStats(
+    ChromaMemoryStatsV1* outStats,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_GetMemoryStats(outStats, outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_CreateStream(
+    ChromaStream** outStream,
+    const int32_t adaptiveCascade,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_CreateStream(outStream, adaptiveCascade, outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_DestroyStream(
+    ChromaStream* stream) {
+    return ChromaRuntime_DestroyStream(stream);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_LocateStreamBGRAW(
+    ChromaStream* stream,
+    const void* bgraPixels,
+    const int32_t width,
+    const int32_t height,
+    const int32_t strideBytes,
+    ChromaPoint* outPoints,
+    const int32_t outCapacity,
+    int32_t* outTotalFound,
+    int32_t* outWritten,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_LocateStreamBGRAW(
+        stream,
+        bgraPixels,
+        width,
+        height,
+        strideBytes,
+        outPoints,
+        outCapacity,
+        outTotalFound,
+        outWritten,
+        outError,
+        outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_LocateStreamFrame(
+    ChromaStream* stream,
+    const ChromaFrameV1* frame,
+    ChromaPoint* outPoints,
+    const int32_t outCapacity,
+    int32_t* outTotalFound,
+    int32_t* outWritten,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_LocateStreamFrame(
+        stream,
+        frame,
+        outPoints,
+        outCapacity,
+        outTotalFound,
+        outWritten,
+        outError,
+        outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_LocateFrame(
+    const ChromaFrameV1* frame,
+    const ChromaConfigV1* config,
+    ChromaPoint* outPoints,
+    const int32_t outCapacity,
+    int32_t* outTotalFound,
+    int32_t* outWritten,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_LocateFrame(
+        frame,
+        config,
+        outPoints,
+        outCapacity,
+        outTotalFound,
+        outWritten,
+        outError,
+        outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_GetStreamStats(
+    ChromaStream* stream,
+    ChromaStreamStatsV1* outStats,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_GetStreamStats(stream, outStats, outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_SetStreamTileDedup(
+    ChromaStream* stream,
+    const int32_t enabled,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_SetStreamTileDedup(stream, enabled, outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_GetStreamTileDedupStats(
+    ChromaStream* stream,
+    ChromaTileDedupStatsV1* outStats,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_GetStreamTileDedupStats(stream, outStats, outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_SetStreamVerdictCache(
+    ChromaStream* stream,
+    const int32_t enabled,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_SetStreamVerdictCache(stream, enabled, outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_GetStreamVerdictCacheStats(
+    ChromaStream* stream,
+    ChromaVerdictCacheStatsV1* outStats,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_GetStreamVerdictCacheStats(stream, outStats, outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_StartStreamPump(
+    ChromaStream* stream,
+    const ChromaStreamPumpOptionsV1* options,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_StartStreamPump(stream, options, outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_PushStreamFrame(
+    ChromaStream* stream,
+    const ChromaFrameV1* frame,
+    uint64_t* outFrameId,
+    int32_t* outQueued,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_PushStreamFrame(stream, frame, outFrameId, outQueued, outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_GetStreamResult(
+    ChromaStream* stream,
+    uint64_t* outFrameId,
+    ChromaPoint* outPoints,
+    const int32_t outCapacity,
+    int32_t* outTotalFound,
+    int32_t* outWritten,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_GetStreamResult(
+        stream,
+        outFrameId,
+        outPoints,
+        outCapacity,
+        outTotalFound,
+        outWritten,
+        outError,
+        outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_GetStreamPumpStats(
+    ChromaStream* stream,
+    ChromaStreamPumpStatsV1* outStats,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_GetStreamPumpStats(stream, outStats, outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_StopStreamPump(
+    ChromaStream* stream,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_StopStreamPump(stream, outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_CreateRegionMap(
+    const ChromaRegionV1* regions,
+    const int32_t regionCount,
+    ChromaRegionMap** outMap,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_CreateRegionMap(regions, regionCount, outMap, outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_DestroyRegionMap(ChromaRegionMap* map) {
+    return ChromaRuntime_DestroyRegionMap(map);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_LocateRegionsBGRAW(
+    const ChromaRegionMap* map,
+    const void* bgraPixels,
+    const int32_t width,
+    const int32_t height,
+    const int32_t strideBytes,
+    ChromaPoint* outPoints,
+    const int32_t outCapacity,
+    int32_t* outTotalFound,
+    int32_t* outWritten,
+    int32_t* outRegionIndices,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_LocateRegionsBGRAW(
+        map,
+        bgraPixels,
+        width,
+        height,
+        strideBytes,
+        outPoints,
+        outCapacity,
+        outTotalFound,
         outWritten,
+        outRegionIndices,
+        outError,
+        outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_StartShadowConfig(
+    const ChromaConfigV1* config,
+    const ChromaShadowOptionsV1* options,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_StartShadowConfig(config, options, outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_StopShadowConfig(
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_StopShadowConfig(outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_GetShadowStats(
+    ChromaShadowStatsV1* outStats,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_GetShadowStats(outStats, outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_StartSentinel(
+    const ChromaSentinelOptionsV1* options,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_StartSentinel(options, outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_StopSentinel(
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_StopSentinel(outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_GetSentinelStats(
+    ChromaSentinelStatsV1* outStats,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_GetSentinelStats(outStats, outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_StartConfigWatch(
+    const ChromaConfigWatchOptionsV1* options,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_StartConfigWatch(options, outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_StopConfigWatch(
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_StopConfigWatch(outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_GetConfigWatchStats(
+    ChromaConfigWatchStatsV1* outStats,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_GetConfigWatchStats(outStats, outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_GetRuntimeStats(
+    ChromaRuntimeStatsV1* outStats,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_GetRuntimeStats(outStats, outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_ResetRuntimeStats() {
+    return ChromaRuntime_ResetRuntimeStats();
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_MeasureCoverageGrid(
+    const void* bgraPixels,
+    const int32_t width,
+    const int32_t height,
+    const int32_t strideBytes,
+    const ChromaConfigV1* config,
+    const int32_t gridCols,
+    const int32_t gridRows,
+    const int32_t applyMorphology,
+    ChromaCoverageCell* outCells,
+    const int32_t outCellCapacity,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_MeasureCoverageGrid(
+        bgraPixels,
+        width,
+        height,
+        strideBytes,
+        config,
+        gridCols,
+        gridRows,
+        applyMorphology,
+        outCells,
+        outCellCapacity,
         outError,
         outErrorChars);
 }
 
+CHROMA_API int32_t CHROMA_CALL Chroma_ExplainConfig(
+    const ChromaConfigV1* config,
+    int32_t renderDebug,
+    wchar_t* outText,
+    int32_t outTextChars,
+    int32_t* outRequiredChars,
+    wchar_t* outError,
+    int32_t outErrorChars) {
+    return ChromaRuntime_ExplainConfig(config, renderDebug, outText, outTextChars, outRequiredChars, outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_EstimateCost(
+    ChromaStream* stream,
+    const int32_t width,
+    const int32_t height,
+    const int32_t pixelFormat,
+    const ChromaConfigV1* config,
+    ChromaCostEstimateV1* outEstimate,
+    wchar_t* outError,
+    const int32_t outErrorChars) {
+    return ChromaRuntime_EstimateCost(stream, width, height, pixelFormat, config, outEstimate, outError, outErrorChars);
+}
+
+CHROMA_API int32_t CHROMA_CALL Chroma_ResetCostModel() {
+    return ChromaRuntime_ResetCostModel();
+}
+
 #endif // CHROMA_RUNTIME_ONLY
 
 
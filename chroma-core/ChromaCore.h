@@ -1,17 +1,27 @@
 #pragma once
 
+#include "ChromaArena.h"
+
 #include <opencv2/core.hpp>
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <initializer_list>
+#include <iterator>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -66,14 +76,35 @@ public:
         int satMax,
         int valMin,
         int valMax) const {
+        cv::Mat accumulated;
+        cv::Mat partA;
+        cv::Mat partB;
+        BuildMaskInto(hsv, satMin, satMax, valMin, valMax, accumulated, partA, partB);
+        return accumulated;
+    }
+
+    // Same as BuildMask, but writes into caller-owned buffers so repeated calls on
+    // same-sized frames do not reallocate.
+    void BuildMaskInto(
+        const cv::Mat& hsv,
+        int satMin,
+        int satMax,
+        int valMin,
+        int valMax,
+        cv::Mat& accumulated,
+        cv::Mat& partA,
+        cv::Mat& partB) const {
         if (hsv.empty()) {
-            return {};
+            accumulated.release();
+            return;
         }
         if (hsv.type() != CV_8UC3) {
             throw std::invalid_argument("HueRangeSet::BuildMask expects CV_8UC3 HSV image.");
         }
+        accumulated.create(hsv.size(), CV_8U);
+        accumulated.setTo(cv::Scalar(0));
         if (ranges_.empty()) {
-            return cv::Mat::zeros(hsv.size(), CV_8U);
+            return;
         }
 
         satMin = std::clamp(satMin, 0, 255);
@@ -87,21 +118,16 @@ public:
             std::swap(valMin, valMax);
         }
 
-        cv::Mat accumulated = cv::Mat::zeros(hsv.size(), CV_8U);
         for (const HueRange& r : ranges_) {
-            cv::Mat part;
             if (r.minHue <= r.maxHue) {
-                cv::inRange(hsv, cv::Scalar(r.minHue, satMin, valMin), cv::Scalar(r.maxHue, satMax, valMax), part);
+                cv::inRange(hsv, cv::Scalar(r.minHue, satMin, valMin), cv::Scalar(r.maxHue, satMax, valMax), partA);
             } else {
-                cv::Mat a;
-                cv::Mat b;
-                cv::inRange(hsv, cv::Scalar(0, satMin, valMin), cv::Scalar(r.maxHue, satMax, valMax), a);
-                cv::inRange(hsv, cv::Scalar(r.minHue, satMin, valMin), cv::Scalar(179, satMax, valMax), b);
-                cv::bitwise_or(a, b, part);
+                cv::inRange(hsv, cv::Scalar(0, satMin, valMin), cv::Scalar(r.maxHue, satMax, valMax), partA);
+                cv::inRange(hsv, cv::Scalar(r.minHue, satMin, valMin), cv::Scalar(179, satMax, valMax), partB);
+                cv::bitwise_or(partA, partB, partA);
             }
-            cv::bitwise_or(accumulated, part, accumulated);
+            cv::bitwise_or(accumulated, partA, accumulated);
         }
-        return accumulated;
     }
 
 private:
@@ -189,12 +215,65 @@ struct DetectionMetrics {
     bool accepted = false;
 };
 
+// Color of one blob: the center-mask pixels inside its contour, in OpenCV's 8-bit HSV
+// scale. Measured for accepted detections when PlanHints::blobStats is set.
+struct BlobColorStats {
+    static constexpr int kHueBins = 18;   // 10 hue units per bin
+
+    int pixelCount = 0;                   // 0 = not measured
+    float meanHue = 0.0F;                 // circular mean, [0,180)
+    float meanSat = 0.0F;
+    float meanVal = 0.0F;
+    cv::Point brightestPx{ -1, -1 };      // highest V, first in row order
+    cv::Vec3b brightestHsv;
+    std::array<int, kHueBins> hueHistogram{};
+};
+
 struct ColorPatternDetection {
     cv::Rect boxPx;
     cv::Point centerPx;
     float radiusPx = 0.0F;
     std::vector<cv::Point> contour;
     DetectionMetrics metrics;
+    BlobColorStats colorStats;
+    int region = -1;   // RegionPatternFinder region index; -1 for single-config runs
+};
+
+enum class PipelineStage : int {
+    Convert = 0,          // input -> BGR -> HSV
+    ClassifyCenter = 1,   // center color mask
+    Morphology = 2,
+    ClassifyContext = 3,  // support / exclude masks (lazily, inside candidate ring regions)
+    Contours = 4,
+    Candidates = 5,       // per-candidate metrics, ring scoring and ranking
+    DebugRender = 6,
+    Total = 7
+};
+
+constexpr int kPipelineStageCount = 8;
+
+struct PipelineTimings {
+    std::array<double, kPipelineStageCount> ms{};
+
+    double& operator[](PipelineStage stage) {
+        return ms[static_cast<size_t>(stage)];
+    }
+    double operator[](PipelineStage stage) const {
+        return ms[static_cast<size_t>(stage)];
+    }
+};
+
+// Outcome of duplicate-tile classification for one frame (see TileDedupState).
+struct TileDedupFrame {
+    bool ran = false;         // false when the mode is off or backing off
+    int tiles = 0;
+    int duplicateTiles = 0;   // classified by copying an identical tile's mask bits
+    double overheadMs = 0.0;  // hashing, matching and copying
+    double savedMs = 0.0;     // estimated classification time not spent on duplicates
+
+    float HitRate() const {
+        return tiles > 0 ? static_cast<float>(duplicateTiles) / static_cast<float>(tiles) : 0.0F;
+    }
 };
 
 struct ColorPatternRunResult {
@@ -206,366 +285,3058 @@ struct ColorPatternRunResult {
     int acceptedCount = 0;
     float acceptedRatio = 0.0F;
     float sceneMaskCoverage = 0.0F;
+    float contextMaskCoverage = 0.0F; // fraction of the frame classified for the context ring
     float score = 0.0F;
 
+    PipelineTimings timings;
+    TileDedupFrame tileDedup;
+
     cv::Mat debugOverlay;  // color view with boxes/labels
     cv::Mat debugMask;     // mask view with boxes/labels
     cv::Mat sideBySideDebug;
 };
 
-namespace detail {
-
-inline float SafeDiv(float num, float den) {
-    return den <= 0.0F ? 0.0F : (num / den);
-}
-
-inline float Clamp01(float v) {
-    if (v < 0.0F) {
-        return 0.0F;
-    }
-    if (v > 1.0F) {
-        return 1.0F;
-    }
-    return v;
-}
+// Outcome of ColorPatternFinder::FindNearest.
+struct NearestTargetResult {
+    bool found = false;
+    ColorPatternDetection detection;   // frame coordinates
+    float distancePx = 0.0F;           // from the focus to detection.centerPx
+    int rounds = 0;                    // windows detected
+    float processedFraction = 0.0F;    // pixels detected over all rounds (halo included) / frame pixels
+    PipelineTimings timings;           // summed over the rounds
+};
 
-inline cv::Mat BuildMask(const cv::Mat& hsv, const ColorMaskConfig& cfg) {
-    return cfg.hues.BuildMask(
-        hsv,
-        cfg.satRange.minValue,
-        cfg.satRange.maxValue,
-        cfg.valRange.minValue,
-        cfg.valRange.maxValue);
-}
+// Class coverage of one grid cell: fraction of the cell's pixels in each class.
+struct CoverageCell {
+    float center = 0.0F;
+    float support = 0.0F;   // context support color
+    float exclude = 0.0F;   // context exclude hues (0 when none are configured)
+};
 
-inline cv::Mat BuildExcludeMask(
-    const cv::Mat& hsv,
-    const HueRangeSet& ranges,
-    const ChannelRange& satRange,
-    const ChannelRange& valRange) {
-    return ranges.BuildMask(hsv, satRange.minValue, satRange.maxValue, valRange.minValue, valRange.maxValue);
-}
+// Result of ColorPatternFinder::MeasureCoverage. Cell (c, r) spans columns
+// [c*W/cols, (c+1)*W/cols) and rows [r*H/rows, (r+1)*H/rows).
+struct CoverageGrid {
+    int cols = 0;
+    int rows = 0;
+    std::vector<CoverageCell> cells;   // row-major, cols * rows
+    PipelineTimings timings;           // the fused pass (conversion included) is charged to ClassifyCenter
+};
 
-inline void ApplyMorphology(cv::Mat& mask, const MorphologyConfig& cfg) {
-    if (mask.empty()) {
-        return;
-    }
-    const cv::Mat k3 = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(3, 3));
-    if (cfg.openIterations > 0) {
-        cv::morphologyEx(mask, mask, cv::MORPH_OPEN, k3, cv::Point(-1, -1), cfg.openIterations);
-    }
-    if (cfg.closeIterations > 0) {
-        cv::morphologyEx(mask, mask, cv::MORPH_CLOSE, k3, cv::Point(-1, -1), cfg.closeIterations);
-    }
-    if (cfg.dilateIterations > 0) {
-        cv::dilate(mask, mask, k3, cv::Point(-1, -1), cfg.dilateIterations);
+// Separable per-channel class tables. A pixel belongs to class bit b when
+// (hue[h] & sat[s] & val[v]) has bit b set, which reproduces "any hue range AND sat
+// range AND val range" for every mask in a single table lookup per channel.
+struct ClassLut {
+    static constexpr uint8_t kCenter = 1;
+    static constexpr uint8_t kSupport = 2;
+    static constexpr uint8_t kExclude = 4;
+
+    std::array<uint8_t, 256> hue{};
+    std::array<uint8_t, 256> sat{};
+    std::array<uint8_t, 256> val{};
+
+    // Mirrors HueRangeSet::BuildMaskInto: channel bounds are clamped and swapped,
+    // hue values above 179 never match.
+    void Add(uint8_t bit, const HueRangeSet& hues, int satMin, int satMax, int valMin, int valMax) {
+        for (const HueRange& r : hues.Ranges()) {
+            if (r.minHue <= r.maxHue) {
+                MarkRange(hue, bit, r.minHue, r.maxHue);
+            } else {
+                MarkRange(hue, bit, 0, r.maxHue);
+                MarkRange(hue, bit, r.minHue, 179);
+            }
+        }
+        satMin = std::clamp(satMin, 0, 255);
+        satMax = std::clamp(satMax, 0, 255);
+        valMin = std::clamp(valMin, 0, 255);
+        valMax = std::clamp(valMax, 0, 255);
+        MarkRange(sat, bit, std::min(satMin, satMax), std::max(satMin, satMax));
+        MarkRange(val, bit, std::min(valMin, valMax), std::max(valMin, valMax));
     }
-}
 
-inline float ComputeCircularity(const std::vector<cv::Point>& contour) {
-    const float area = static_cast<float>(cv::contourArea(contour));
-    const float perimeter = static_cast<float>(cv::arcLength(contour, true));
-    if (area <= 0.0F || perimeter <= 0.0F) {
-        return 0.0F;
+private:
+    static void MarkRange(std::array<uint8_t, 256>& table, uint8_t bit, int lo, int hi) {
+        for (int i = lo; i <= hi; ++i) {
+            table[static_cast<size_t>(i)] = static_cast<uint8_t>(table[static_cast<size_t>(i)] | bit);
+        }
     }
-    return static_cast<float>((4.0 * CV_PI * area) / (perimeter * perimeter));
-}
+};
 
-inline cv::Mat EnsureColor(const cv::Mat& image) {
-    if (image.empty()) {
-        return {};
-    }
-    if (image.channels() == 3) {
-        return image.clone();
-    }
-    if (image.channels() == 1) {
-        cv::Mat out;
-        cv::cvtColor(image, out, cv::COLOR_GRAY2BGR);
-        return out;
-    }
-    cv::Mat out;
-    cv::cvtColor(image, out, cv::COLOR_BGRA2BGR);
-    return out;
-}
+enum class ClassifierKernel : int {
+    None = 0,        // nothing to classify
+    Arithmetic = 1,  // one cv::inRange per hue range (two for wrapping ranges), OR-accumulated
+    Lut = 2          // single pass through ClassLut, all requested masks at once
+};
 
-inline void DrawLabel(
-    cv::Mat& image,
-    const std::string& text,
-    const cv::Point& anchor,
-    const DebugDrawConfig& dbg) {
-    if (image.empty() || text.empty() || !dbg.drawLabels) {
-        return;
-    }
-    int baseline = 0;
-    const cv::Size textSize = cv::getTextSize(text, cv::FONT_HERSHEY_SIMPLEX, dbg.fontScale, dbg.lineThickness, &baseline);
+enum class ContextMaskKernel : int {
+    Disabled = 0,    // context off, or the ring needs no classified pixels
+    LazyTiles = 1,   // classified per 32x32 tile while scoring rings
+    Dense = 2        // classified over the whole frame up front
+};
 
-    int x = std::max(0, anchor.x);
-    int y = std::max(textSize.height + 1, anchor.y);
-    if (x + textSize.width + 2 >= image.cols) {
-        x = std::max(0, image.cols - textSize.width - 2);
-    }
-    if (y >= image.rows) {
-        y = std::max(textSize.height + 1, image.rows - 2);
-    }
+enum class RingKernel : int {
+    Disabled = 0,
+    Classified = 1,   // support and exclude pixels counted in the ring
+    ExcludeOnly = 2,  // support accepts every pixel: ratio is 1 unless the ring is fully excluded
+    GeometryOnly = 3  // support accepts every pixel and nothing is excluded: ring is only rasterized
+};
 
-    if (dbg.drawLabelBackground) {
-        const cv::Point tl(std::max(0, x - dbg.labelPaddingPx), std::max(0, y - textSize.height - dbg.labelPaddingPx));
-        const cv::Point br(std::min(image.cols - 1, x + textSize.width + dbg.labelPaddingPx), std::min(image.rows - 1, y + baseline + dbg.labelPaddingPx));
-        cv::rectangle(image, tl, br, dbg.labelBgColor, cv::FILLED);
-    }
-    cv::putText(image, text, cv::Point(x, y), cv::FONT_HERSHEY_SIMPLEX, dbg.fontScale, dbg.textColor, dbg.lineThickness, cv::LINE_AA);
-}
+enum class DebugPanels : int {
+    Overlay = 1,
+    Mask = 2,
+    Both = 3   // overlay | mask, side by side
+};
 
-inline std::string BuildMetricLabel(const DetectionMetrics& m) {
-    std::ostringstream oss;
-    oss.setf(std::ios::fixed);
-    oss.precision(2);
-    oss << (m.accepted ? "A" : "R")
-        << " rr=" << m.ringSupportRatio
-        << " c=" << m.circularity
-        << " f=" << m.centerFillRatio;
-    return oss.str();
-}
-
-inline cv::Mat BuildSideBySide(const cv::Mat& leftBgr, const cv::Mat& rightBgr) {
-    if (leftBgr.empty() || rightBgr.empty()) {
-        return {};
-    }
-    cv::Mat left = EnsureColor(leftBgr);
-    cv::Mat right = EnsureColor(rightBgr);
-    if (left.rows != right.rows) {
-        const int targetRows = std::max(left.rows, right.rows);
-        const double leftScale = static_cast<double>(targetRows) / static_cast<double>(left.rows);
-        const double rightScale = static_cast<double>(targetRows) / static_cast<double>(right.rows);
-        cv::resize(left, left, cv::Size(), leftScale, leftScale, cv::INTER_NEAREST);
-        cv::resize(right, right, cv::Size(), rightScale, rightScale, cv::INTER_NEAREST);
-    }
-    cv::Mat out;
-    cv::hconcat(left, right, out);
-    return out;
-}
+// Shape of the debug image. Panels are rendered directly at the output scale: the
+// scene and mask are downscaled first and boxes, circles and label anchors are drawn
+// at scaled coordinates (label text keeps the configured font size).
+struct DebugRenderOptions {
+    DebugPanels panels = DebugPanels::Both;
+    cv::Size maxSize;   // bound on the selected panels side by side; 0 = no bound on that axis
+};
 
-}
+// Facts about the call site that are not part of the config.
+struct PlanHints {
+    bool renderDebug = true;             // false skips the DebugRender stage
+    DebugRenderOptions debugOutput;
+    float expectedRingCoverage = -1.0F;  // fraction of the frame near scored rings; < 0 = unknown
+    bool blobStats = false;              // measure BlobColorStats for accepted detections
+};
 
-class ColorPatternFinder {
-public:
-    explicit ColorPatternFinder(ColorPatternConfig config = {}) : config_(std::move(config)) {}
+// Kernel chosen for each stage of one config, plus the inputs behind each choice so
+// Explain() can say why. Plans are exact: every kernel produces the same detections.
+struct PipelinePlan {
+    static constexpr int kMaxArithmeticPasses = 2;       // above this, one LUT pass is cheaper
+    static constexpr float kDenseContextCoverage = 0.25F; // expected coverage that favors dense context
+
+    ClassifierKernel centerClassifier = ClassifierKernel::Arithmetic;
+    bool morphology = true;
+    ContextMaskKernel contextMasks = ContextMaskKernel::Disabled;
+    ClassifierKernel contextClassifier = ClassifierKernel::None;
+    bool fusedDenseClassify = false;  // center LUT pass also writes the dense context masks
+    bool classifySupport = false;
+    bool classifyExclude = false;
+    RingKernel ring = RingKernel::Disabled;
+    bool renderDebug = true;
+    DebugRenderOptions debugOutput;
+    bool blobStats = false;
+    uint64_t verdictKey = 0;  // shape/context settings, part of VerdictCache signatures
+
+    ClassLut lut;
+
+    // Decision inputs.
+    int centerArithmeticPasses = 0;
+    int contextArithmeticPasses = 0;
+    int morphologyIterations = 0;
+    float expectedRingCoverage = -1.0F;
+    bool drawRejected = false;
 
-    static bool ValidateConfig(const ColorPatternConfig& cfg, std::string* errorOut = nullptr) {
-        auto setError = [&](const std::string& msg) {
-            if (errorOut != nullptr) {
-                *errorOut = msg;
-            }
-            return false;
-        };
-        auto validateRange = [&](const ChannelRange& range, const std::string& name) {
-            if (range.minValue < 0 || range.minValue > 255 || range.maxValue < 0 || range.maxValue > 255) {
-                return setError(name + " must be within [0,255].");
-            }
-            if (range.minValue > range.maxValue) {
-                return setError(name + " must satisfy minValue <= maxValue.");
+    std::string Explain() const {
+        auto classifierName = [](ClassifierKernel k) {
+            switch (k) {
+            case ClassifierKernel::Arithmetic: return "arithmetic (inRange)";
+            case ClassifierKernel::Lut: return "LUT";
+            default: return "none";
             }
-            return true;
         };
 
-        if (cfg.centerColor.hues.Empty()) {
-            return setError("centerColor.hues is empty.");
+        std::ostringstream oss;
+        oss << "convert: cvtColor BGR->HSV over the full frame\n";
+
+        oss << "classify-center: " << classifierName(centerClassifier);
+        if (centerClassifier == ClassifierKernel::Lut) {
+            oss << " - " << centerArithmeticPasses << " inRange passes would be needed";
+            if (fusedDenseClassify) {
+                oss << "; the same pass also writes the dense context masks";
+            }
+        } else {
+            oss << " - " << centerArithmeticPasses << " inRange pass(es), at most " << kMaxArithmeticPasses;
         }
-        if (!validateRange(cfg.centerColor.satRange, "centerColor.satRange")) {
-            return false;
+        oss << "\n";
+
+        oss << "morphology: ";
+        if (morphology) {
+            oss << morphologyIterations << " iteration(s) of 3x3 open/close/dilate\n";
+        } else {
+            oss << "skipped - all iteration counts are 0\n";
         }
-        if (!validateRange(cfg.centerColor.valRange, "centerColor.valRange")) {
-            return false;
+
+        oss << "classify-context: ";
+        switch (contextMasks) {
+        case ContextMaskKernel::Disabled:
+            if (ring == RingKernel::Disabled) {
+                oss << "skipped - context ring is disabled\n";
+            } else {
+                oss << "skipped - support accepts every pixel and no hues are excluded\n";
+            }
+            break;
+        case ContextMaskKernel::LazyTiles:
+            oss << classifierName(contextClassifier) << ", lazy 32x32 tiles around scored rings - ";
+            if (expectedRingCoverage < 0.0F) {
+                oss << "ring coverage unknown";
+            } else {
+                oss << "expected ring coverage " << expectedRingCoverage << " < " << kDenseContextCoverage;
+            }
+            oss << "\n";
+            break;
+        case ContextMaskKernel::Dense:
+            oss << (fusedDenseClassify ? "fused into classify-center" : classifierName(contextClassifier))
+                << ", dense full frame - expected ring coverage " << expectedRingCoverage
+                << " >= " << kDenseContextCoverage << "\n";
+            break;
         }
-        if (cfg.shape.minArea < 1) {
-            return setError("shape.minArea must be >= 1.");
+        if (contextMasks != ContextMaskKernel::Disabled) {
+            oss << "  masks: support " << (classifySupport ? "classified" : "skipped (accepts every pixel)")
+                << ", exclude " << (classifyExclude ? "classified" : "skipped (no exclude hues)")
+                << ", " << contextArithmeticPasses << " inRange pass(es) vs one LUT pass\n";
         }
-        if (cfg.shape.maxArea < cfg.shape.minArea) {
-            return setError("shape.maxArea must be >= shape.minArea.");
+
+        oss << "contours: findContours on the center mask\n";
+
+        oss << "candidates: ";
+        switch (ring) {
+        case RingKernel::Disabled: oss << "shape tests only"; break;
+        case RingKernel::Classified: oss << "shape tests + ring support/exclude count"; break;
+        case RingKernel::ExcludeOnly: oss << "shape tests + ring exclude count (support accepts every pixel)"; break;
+        case RingKernel::GeometryOnly: oss << "shape tests + ring rasterization only (every ring pixel supports)"; break;
         }
-        if (cfg.shape.minCircularity < 0.0F || cfg.shape.minCircularity > 1.0F) {
-            return setError("shape.minCircularity must be in [0,1].");
+        oss << "; parallel chunks from 64 candidates";
+        if (blobStats) {
+            oss << "; color statistics of accepted blobs";
         }
-        if (cfg.shape.minFillRatio < 0.0F || cfg.shape.minFillRatio > 1.0F) {
-            return setError("shape.minFillRatio must be in [0,1].");
+        if (drawRejected) {
+            oss << "; drawRejected forces full metrics for rejected candidates";
         }
-        if (cfg.context.enabled) {
-            if (cfg.context.innerRadiusPercent < 1 || cfg.context.outerRadiusPercent <= cfg.context.innerRadiusPercent) {
-                return setError("context ring radius percents must satisfy: 1 <= inner < outer.");
-            }
-            if (cfg.context.minSupportRatio < 0.0F || cfg.context.minSupportRatio > 1.0F) {
-                return setError("context.minSupportRatio must be in [0,1].");
-            }
-            if (!validateRange(cfg.context.supportColor.satRange, "context.supportColor.satRange")) {
-                return false;
-            }
-            if (!validateRange(cfg.context.supportColor.valRange, "context.supportColor.valRange")) {
-                return false;
-            }
-            if (!validateRange(cfg.context.excludeSatRange, "context.excludeSatRange")) {
-                return false;
+        oss << "\n";
+
+        oss << "debug-render: ";
+        if (!renderDebug) {
+            oss << "skipped - no debug image requested\n";
+        } else {
+            switch (debugOutput.panels) {
+            case DebugPanels::Overlay: oss << "overlay panel"; break;
+            case DebugPanels::Mask: oss << "mask panel"; break;
+            default: oss << "overlay + mask panels"; break;
             }
-            if (!validateRange(cfg.context.excludeValRange, "context.excludeValRange")) {
-                return false;
+            if (debugOutput.maxSize.width > 0 || debugOutput.maxSize.height > 0) {
+                oss << ", rendered within " << debugOutput.maxSize.width << "x" << debugOutput.maxSize.height << " (0 = unbounded)";
             }
+            oss << "\n";
         }
+        return oss.str();
+    }
+};
 
-        return true;
+enum class CandidateTest : int {
+    Area = 0,
+    Circularity = 1,
+    CenterFill = 2,
+    ContextRing = 3
+};
+
+constexpr int kCandidateTestCount = 4;
+
+// Per-stream candidate cascade. Tracks how often each candidate test rejects and
+// what it costs, and periodically reorders the tests so the ones with the highest
+// rejection rate per unit cost run first. When `adaptive` is set, a candidate stops
+// at its first failing test, so rejected detections only carry the metrics that
+// were evaluated; accepted detections run every test and are unaffected by the order.
+// Every `exploreIntervalFrames`-th frame evaluates all tests so rejection rates are
+// measured without the bias introduced by short-circuiting.
+struct CandidateCascade {
+    // Test costs are timed on every kCostSampleStride-th candidate only; reading the
+    // tick counter around every test of every candidate costs as much as cheap tests.
+    static constexpr int kCostSampleStride = 8;
+
+    bool adaptive = false;
+    int reorderIntervalFrames = 16;
+    int exploreIntervalFrames = 8;
+
+    std::array<CandidateTest, kCandidateTestCount> order{
+        CandidateTest::Area, CandidateTest::Circularity, CandidateTest::CenterFill, CandidateTest::ContextRing };
+
+    // Indexed by CandidateTest.
+    std::array<uint64_t, kCandidateTestCount> evaluated{};
+    std::array<uint64_t, kCandidateTestCount> rejected{};
+    std::array<int64_t, kCandidateTestCount> costTicks{};
+    std::array<uint64_t, kCandidateTestCount> timed{};
+    std::array<uint64_t, kCandidateTestCount> exploredEvaluated{};
+    std::array<uint64_t, kCandidateTestCount> exploredRejected{};
+
+    uint64_t frames = 0;
+    uint64_t candidates = 0;
+    uint64_t reorders = 0;
+
+    bool ShortCircuitThisFrame() const {
+        return adaptive && exploreIntervalFrames > 0 && (frames % static_cast<uint64_t>(exploreIntervalFrames)) != 0;
     }
 
-    ColorPatternRunResult LoadAndFind(const std::string& scenePath) const {
-        const cv::Mat scene = cv::imread(scenePath, cv::IMREAD_COLOR);
-        if (scene.empty()) {
-            throw std::runtime_error("Failed to load scene image: " + scenePath);
+    void Record(CandidateTest test, bool passed, bool exploring) {
+        const size_t i = static_cast<size_t>(test);
+        evaluated[i] += 1;
+        rejected[i] += passed ? 0 : 1;
+        if (exploring) {
+            exploredEvaluated[i] += 1;
+            exploredRejected[i] += passed ? 0 : 1;
         }
-        return Find(scene);
     }
 
-    ColorPatternRunResult Find(const cv::Mat& sceneBgr) const {
-        if (sceneBgr.empty()) {
-            throw std::invalid_argument("Find received empty scene image.");
+    void RecordCost(CandidateTest test, int64_t ticks) {
+        const size_t i = static_cast<size_t>(test);
+        costTicks[i] += ticks;
+        timed[i] += 1;
+    }
+
+    double MeanCostNs(CandidateTest test) const {
+        const size_t i = static_cast<size_t>(test);
+        if (timed[i] == 0) {
+            return 0.0;
         }
+        return (static_cast<double>(costTicks[i]) * 1e9 / cv::getTickFrequency()) / static_cast<double>(timed[i]);
+    }
 
-        cv::Mat scene = detail::EnsureColor(sceneBgr);
-        cv::Mat hsv;
-        cv::cvtColor(scene, hsv, cv::COLOR_BGR2HSV);
+    double RejectionRate(CandidateTest test) const {
+        const size_t i = static_cast<size_t>(test);
+        return exploredEvaluated[i] == 0 ? 0.0 : static_cast<double>(exploredRejected[i]) / static_cast<double>(exploredEvaluated[i]);
+    }
 
-        cv::Mat centerMask = detail::BuildMask(hsv, config_.centerColor);
-        detail::ApplyMorphology(centerMask, config_.centerMorph);
+    // Adds the per-test counters of `tally` (a per-worker copy) into this cascade.
+    void Accumulate(const CandidateCascade& tally) {
+        for (size_t i = 0; i < static_cast<size_t>(kCandidateTestCount); ++i) {
+            evaluated[i] += tally.evaluated[i];
+            rejected[i] += tally.rejected[i];
+            costTicks[i] += tally.costTicks[i];
+            timed[i] += tally.timed[i];
+            exploredEvaluated[i] += tally.exploredEvaluated[i];
+            exploredRejected[i] += tally.exploredRejected[i];
+        }
+    }
 
-        cv::Mat supportMask;
-        cv::Mat excludeMask;
-        if (config_.context.enabled) {
-            supportMask = detail::BuildMask(hsv, config_.context.supportColor);
-            if (!config_.context.excludeHues.Empty()) {
-                excludeMask = detail::BuildExcludeMask(
-                    hsv,
-                    config_.context.excludeHues,
-                    config_.context.excludeSatRange,
-                    config_.context.excludeValRange);
-            }
+    void ClearCounters() {
+        evaluated.fill(0);
+        rejected.fill(0);
+        costTicks.fill(0);
+        timed.fill(0);
+        exploredEvaluated.fill(0);
+        exploredRejected.fill(0);
+    }
+
+    void EndFrame() {
+        frames += 1;
+        if (adaptive && reorderIntervalFrames > 0 && (frames % static_cast<uint64_t>(reorderIntervalFrames)) == 0) {
+            Reorder();
         }
+    }
 
-        std::vector<std::vector<cv::Point>> contours;
-        cv::findContours(centerMask.clone(), contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+    void Reorder() {
+        std::array<double, kCandidateTestCount> key{};
+        for (int i = 0; i < kCandidateTestCount; ++i) {
+            const CandidateTest t = static_cast<CandidateTest>(i);
+            key[static_cast<size_t>(i)] = RejectionRate(t) / std::max(1.0, MeanCostNs(t));
+        }
+        std::stable_sort(order.begin(), order.end(), [&](CandidateTest a, CandidateTest b) {
+            return key[static_cast<size_t>(a)] > key[static_cast<size_t>(b)];
+        });
+        reorders += 1;
+
+        // Halve the exploration window so the order follows changes in the scene.
+        for (size_t i = 0; i < static_cast<size_t>(kCandidateTestCount); ++i) {
+            exploredEvaluated[i] /= 2;
+            exploredRejected[i] /= 2;
+        }
+    }
+};
 
-        ColorPatternRunResult result;
-        result.rawCandidateCount = static_cast<int>(contours.size());
-        result.sceneMaskCoverage = detail::SafeDiv(
-            static_cast<float>(cv::countNonZero(centerMask)),
-            static_cast<float>(centerMask.rows * centerMask.cols));
+// Per-worker state for candidate evaluation. Ring buffers grow to the largest ring
+// box seen and are used through views; cascade and context counters are merged
+// into the workspace after each frame.
+struct CandidateScratch {
+    cv::Mat blobMask;
+    cv::Mat ringMask;
+    cv::Mat validRingMask;
+    cv::Mat ringScratch;
+    CandidateCascade tally;
+    int64_t contextClassifyTicks = 0;
+    int64_t contextClassifiedPx = 0;
+};
 
-        cv::Mat overlay = scene.clone();
-        cv::Mat maskDebug;
-        cv::cvtColor(centerMask, maskDebug, cv::COLOR_GRAY2BGR);
+// Duplicate-tile classification for one workspace. When enabled, the HSV frame is split
+// into kTileSize tiles; each distinct tile is classified once and its mask bits are
+// copied to the byte-identical tiles (matched by hash, then compared byte for byte),
+// so masks are unchanged. A frame whose hashing and copying cost more than the
+// classification it saved turns the mode off for backoffFrames frames, after which one
+// frame measures again.
+struct TileDedupState {
+    static constexpr int kTileSize = 16;
 
-        for (const std::vector<cv::Point>& contour : contours) {
-            const float area = static_cast<float>(cv::contourArea(contour));
-            if (area <= 0.0F) {
-                continue;
-            }
+    bool enabled = false;
+    int backoffFrames = 32;
+
+    int framesUntilProbe = 0;
+    TileDedupFrame last;
+    uint64_t framesRun = 0;
+    uint64_t framesBypassed = 0;  // enabled, but backing off
+    uint64_t tiles = 0;
+    uint64_t duplicateTiles = 0;
+    uint64_t backoffs = 0;
+
+    std::vector<uint64_t> hashes;
+    std::vector<int> source;  // per tile: the identical tile it copies, -1 = classified
+    std::unordered_map<uint64_t, int> firstByHash;
+
+    // True when this frame should be deduplicated.
+    bool BeginFrame() {
+        last = {};
+        if (!enabled) {
+            return false;
+        }
+        if (framesUntilProbe > 0) {
+            --framesUntilProbe;
+            framesBypassed += 1;
+            return false;
+        }
+        return true;
+    }
 
-            cv::Point2f centerFloat;
-            float radius = 0.0F;
-            cv::minEnclosingCircle(contour, centerFloat, radius);
-            const cv::Point center(static_cast<int>(std::lround(centerFloat.x)), static_cast<int>(std::lround(centerFloat.y)));
-            const cv::Rect box = cv::boundingRect(contour);
-
-            DetectionMetrics m;
-            m.areaPx = area;
-            m.circularity = detail::Clamp01(detail::ComputeCircularity(contour));
-            m.passesArea = (area >= static_cast<float>(config_.shape.minArea) && area <= static_cast<float>(config_.shape.maxArea));
-            m.passesCircularity = (m.circularity >= config_.shape.minCircularity);
-
-            const float circleArea = std::max(1.0F, static_cast<float>(CV_PI) * radius * radius);
-            m.centerFillRatio = detail::Clamp01(detail::SafeDiv(area, circleArea));
-            m.passesCenterFill = (m.centerFillRatio >= config_.shape.minFillRatio);
-
-            if (config_.context.enabled) {
-                cv::Mat ringMask = cv::Mat::zeros(centerMask.size(), CV_8U);
-                const int inner = std::max(1, static_cast<int>(std::lround(radius * (static_cast<float>(config_.context.innerRadiusPercent) / 100.0F))));
-                const int outer = std::max(inner + 1, static_cast<int>(std::lround(radius * (static_cast<float>(config_.context.outerRadiusPercent) / 100.0F))));
-
-                cv::circle(ringMask, center, outer, cv::Scalar(255), cv::FILLED);
-                cv::circle(ringMask, center, inner, cv::Scalar(0), cv::FILLED);
-
-                cv::Mat validRingMask = ringMask.clone();
-                if (!excludeMask.empty()) {
-                    cv::Mat excludedInRing;
-                    cv::bitwise_and(ringMask, excludeMask, excludedInRing);
-                    cv::bitwise_xor(validRingMask, excludedInRing, validRingMask);
-                }
+    void EndFrame(const TileDedupFrame& frame) {
+        last = frame;
+        framesRun += 1;
+        tiles += static_cast<uint64_t>(frame.tiles);
+        duplicateTiles += static_cast<uint64_t>(frame.duplicateTiles);
+        if (frame.overheadMs > frame.savedMs) {
+            framesUntilProbe = backoffFrames;
+            backoffs += 1;
+        }
+    }
 
-                cv::Mat supportInRing;
-                cv::bitwise_and(supportMask, validRingMask, supportInRing);
+    void Release() {
+        hashes.clear();
+        hashes.shrink_to_fit();
+        source.clear();
+        source.shrink_to_fit();
+        firstByHash = {};
+    }
+};
 
-                const float validPx = static_cast<float>(cv::countNonZero(validRingMask));
-                const float supportPx = static_cast<float>(cv::countNonZero(supportInRing));
-                m.ringSupportRatio = detail::Clamp01(detail::SafeDiv(supportPx, validPx));
-                m.passesContext = (m.ringSupportRatio >= config_.context.minSupportRatio);
-            } else {
-                m.ringSupportRatio = 1.0F;
-                m.passesContext = true;
-            }
+// Candidate verdicts reused across frames for one workspace. A candidate's signature
+// covers everything its metrics depend on: its box, area and center-mask bytes (which
+// fix the contour), the HSV bytes of its context ring box, the clip bounds and the
+// shape/context settings. A candidate whose signature matches an entry takes that
+// entry's metrics and circle instead of being scored again, so static background blobs
+// are evaluated once. Candidates outside the area limits are not cached (the area test
+// is cheaper than a signature). Entries not matched for maxIdleFrames frames are dropped.
+struct VerdictCache {
+    static constexpr size_t kMaxEntries = 4096;
+
+    struct Entry {
+        cv::Rect boxPx;
+        cv::Point centerPx;
+        float radiusPx = 0.0F;
+        DetectionMetrics metrics;
+        uint64_t lastFrame = 0;
+    };
 
-            const float shapeScore = (m.circularity * 0.55F) + (m.centerFillRatio * 0.45F);
-            if (config_.context.enabled) {
-                m.score = detail::Clamp01((shapeScore * 0.60F) + (m.ringSupportRatio * 0.40F));
+    bool enabled = false;
+    int maxIdleFrames = 30;
+
+    uint64_t frames = 0;
+    uint64_t lookups = 0;
+    uint64_t hits = 0;
+    uint64_t inserts = 0;
+    uint64_t evictions = 0;
+    int lastFrameLookups = 0;
+    int lastFrameHits = 0;
+    int frameLookups = 0;  // current frame, folded into lastFrame* by EndFrame
+    int frameHits = 0;
+
+    std::unordered_map<uint64_t, Entry> entries;
+
+    // Per candidate of the current EvaluateCandidates call: its signature (0 = not
+    // cached) and whether it was answered from the cache.
+    std::vector<uint64_t> signatures;
+    std::vector<uint8_t> hit;
+
+    const Entry* Find(uint64_t signature, const cv::Rect& box) const {
+        const auto it = entries.find(signature);
+        return (it != entries.end() && it->second.boxPx == box) ? &it->second : nullptr;
+    }
+
+    void EndFrame() {
+        if (!enabled) {
+            return;
+        }
+        frames += 1;
+        lastFrameLookups = frameLookups;
+        lastFrameHits = frameHits;
+        frameLookups = 0;
+        frameHits = 0;
+        const uint64_t idle = static_cast<uint64_t>(std::max(1, maxIdleFrames));
+        if (frames % 8 != 0) {
+            return;
+        }
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (frames - it->second.lastFrame > idle) {
+                it = entries.erase(it);
+                evictions += 1;
             } else {
-                m.score = detail::Clamp01(shapeScore);
+                ++it;
             }
-
-            m.accepted = (m.passesArea && m.passesCircularity && m.passesCenterFill && m.passesContext);
-
-            ColorPatternDetection det;
-            det.boxPx = box;
-            det.centerPx = center;
-            det.radiusPx = radius;
-            det.contour = contour;
-            det.metrics = m;
-            result.detections.push_back(std::move(det));
         }
+    }
 
-        std::sort(result.detections.begin(), result.detections.end(),
-            [](const ColorPatternDetection& a, const ColorPatternDetection& b) {
-                if (a.metrics.accepted != b.metrics.accepted) {
-                    return a.metrics.accepted > b.metrics.accepted;
-                }
-                return a.metrics.score > b.metrics.score;
-            });
+    float HitRate() const {
+        return lookups > 0 ? static_cast<float>(hits) / static_cast<float>(lookups) : 0.0F;
+    }
 
-        for (const ColorPatternDetection& det : result.detections) {
-            if (det.metrics.accepted) {
-                result.acceptedCentersPx.push_back(det.centerPx);
-                result.acceptedBoxesPx.push_back(det.boxPx);
-                result.acceptedCount += 1;
-                result.score = std::max(result.score, det.metrics.score);
-            }
+    void Release() {
+        entries = {};
+        signatures.clear();
+        signatures.shrink_to_fit();
+        hit.clear();
+        hit.shrink_to_fit();
+        frameLookups = 0;
+        frameHits = 0;
+    }
+};
 
+// Scratch buffers reused across ColorPatternFinder::Find calls. Keeping one per
+// detection thread removes per-frame allocations once the frame shape is stable;
+// buffers are resized in place when the shape changes. A workspace must not be
+// shared by concurrent Find calls.
+struct DetectionWorkspace {
+    // Optional allocator for the buffers below. Declared first so it outlives them.
+    std::shared_ptr<ArenaMatAllocator> arena;
+
+    cv::Mat sceneBgr;      // only used when the input needs a color conversion
+    cv::Mat frameBgr;      // caller-side conversion of planar input (NV12)
+    cv::Mat hsv;
+    cv::Mat centerMask;
+    cv::Mat contourInput;
+    cv::Mat supportMask;
+    cv::Mat excludeMask;
+    cv::Mat maskScratchA;
+    cv::Mat maskScratchB;
+    std::vector<std::vector<cv::Point>> contours;
+
+    // Lazy context classification. supportMask/excludeMask are frame-sized but only
+    // valid on tiles whose state is kTileReady for the current frame. Tiles are
+    // claimed atomically so concurrent candidate workers classify each tile once.
+    static constexpr int kContextTileSize = 32;
+    static constexpr uint8_t kTilePending = 0;
+    static constexpr uint8_t kTileClaimed = 1;
+    static constexpr uint8_t kTileReady = 2;
+    std::vector<std::atomic<uint8_t>> contextTiles;
+    int contextTileCols = 0;
+    int64_t contextClassifyTicks = 0; // frame totals, summed over candidate workers
+    int64_t contextClassifiedPx = 0;
+
+    // One entry per candidate worker chunk; entry 0 is used by the serial path.
+    std::vector<CandidateScratch> candidateScratch;
+
+    // Candidate test order and statistics; only used adaptively when cascade.adaptive is set.
+    CandidateCascade cascade;
+
+    // Duplicate-tile classification; off unless tileDedup.enabled is set.
+    TileDedupState tileDedup;
+
+    // Cross-frame candidate verdicts; off unless verdictCache.enabled is set.
+    VerdictCache verdictCache;
+
+    // Routes every workspace buffer through `allocator` (null restores the OpenCV
+    // default). Existing buffers are released first.
+    void UseArena(std::shared_ptr<ArenaMatAllocator> allocator) {
+        Release();
+        arena = std::move(allocator);
+        ForEachBuffer(*this, [&](cv::Mat& m) { m.allocator = arena.get(); });
+    }
+
+    void Release() {
+        ForEachBuffer(*this, [](cv::Mat& m) { m.release(); });
+        contours.clear();
+        contours.shrink_to_fit();
+        contextTiles.clear();
+        contextTiles.shrink_to_fit();
+        candidateScratch.clear();
+        candidateScratch.shrink_to_fit();
+        tileDedup.Release();
+        verdictCache.Release();
+    }
+
+    // Grows candidateScratch to `count` entries. New ring buffers use the arena.
+    void EnsureCandidateScratch(size_t count) {
+        if (candidateScratch.size() >= count) {
+            return;
+        }
+        candidateScratch.resize(count);
+        for (CandidateScratch& scratch : candidateScratch) {
+            scratch.ringMask.allocator = arena.get();
+            scratch.validRingMask.allocator = arena.get();
+            scratch.ringScratch.allocator = arena.get();
+        }
+    }
+
+private:
+    template <typename Self, typename Fn>
+    static void ForEachBuffer(Self& self, Fn&& fn) {
+        fn(self.sceneBgr);
+        fn(self.frameBgr);
+        fn(self.hsv);
+        fn(self.centerMask);
+        fn(self.contourInput);
+        fn(self.supportMask);
+        fn(self.excludeMask);
+        fn(self.maskScratchA);
+        fn(self.maskScratchB);
+        for (auto& scratch : self.candidateScratch) {
+            fn(scratch.ringMask);
+            fn(scratch.validRingMask);
+            fn(scratch.ringScratch);
+        }
+    }
+};
+
+// High-precision capture formats accepted by ColorPatternFinder::FindHdr.
+enum class HdrFormat : int {
+    Rgb10A2 = 0,  // CV_32SC1 words: R bits 0-9, G 10-19, B 20-29, A 30-31; same transfer as 8-bit input
+    Rgba16F = 1   // CV_16UC4 half-float bits in R, G, B, A order; linear scRGB, 1.0 = SDR white
+};
+
+namespace detail {
+
+inline float SafeDiv(float num, float den) {
+    return den <= 0.0F ? 0.0F : (num / den);
+}
+
+inline double TicksToMs(int64_t ticks) {
+    return static_cast<double>(ticks) * 1000.0 / cv::getTickFrequency();
+}
+
+// Accumulates wall time per pipeline stage. Each Mark() charges the time since the
+// previous mark to `stage`.
+class StageClock {
+public:
+    explicit StageClock(PipelineTimings& timings)
+        : timings_(timings), start_(cv::getTickCount()), last_(start_) {}
+
+    void Mark(PipelineStage stage) {
+        const int64_t now = cv::getTickCount();
+        timings_[stage] += TicksToMs(now - last_);
+        last_ = now;
+    }
+
+    void Finish() {
+        timings_[PipelineStage::Total] = TicksToMs(cv::getTickCount() - start_);
+    }
+
+private:
+    PipelineTimings& timings_;
+    int64_t start_;
+    int64_t last_;
+};
+
+inline float Clamp01(float v) {
+    if (v < 0.0F) {
+        return 0.0F;
+    }
+    if (v > 1.0F) {
+        return 1.0F;
+    }
+    return v;
+}
+
+// Returns a `size` view of `buffer`, growing it (never shrinking) when needed, so
+// buffers sized per candidate stop reallocating once the largest size has been seen.
+inline cv::Mat GrowView(cv::Mat& buffer, const cv::Size& size, int type) {
+    if (buffer.type() != type || buffer.cols < size.width || buffer.rows < size.height) {
+        buffer.create(std::max(buffer.rows, size.height), std::max(buffer.cols, size.width), type);
+    }
+    return buffer(cv::Rect(0, 0, size.width, size.height));
+}
+
+// Number of cv::inRange passes HueRangeSet::BuildMaskInto makes for `hues`.
+inline int ArithmeticPasses(const HueRangeSet& hues) {
+    int passes = 0;
+    for (const HueRange& r : hues.Ranges()) {
+        passes += (r.minHue <= r.maxHue) ? 1 : 2;
+    }
+    return passes;
+}
+
+// Writes 255/0 masks for the requested classes of `hsv` in one pass. Null outputs are
+// skipped; non-null outputs must already have hsv's size (ROI headers are fine).
+inline void ClassifyWithLut(const cv::Mat& hsv, const ClassLut& lut, cv::Mat* center, cv::Mat* support, cv::Mat* exclude) {
+    const bool wantCenter = center != nullptr;
+    const bool wantSupport = support != nullptr;
+    const bool wantExclude = exclude != nullptr;
+    auto classifyRows = [&](const cv::Range& rows) {
+        for (int y = rows.start; y < rows.end; ++y) {
+            const uint8_t* px = hsv.ptr<uint8_t>(y);
+            uint8_t* c = wantCenter ? center->ptr<uint8_t>(y) : nullptr;
+            uint8_t* s = wantSupport ? support->ptr<uint8_t>(y) : nullptr;
+            uint8_t* e = wantExclude ? exclude->ptr<uint8_t>(y) : nullptr;
+            for (int x = 0; x < hsv.cols; ++x, px += 3) {
+                const unsigned bits = static_cast<unsigned>(lut.hue[px[0]] & lut.sat[px[1]] & lut.val[px[2]]);
+                if (wantCenter) {
+                    c[x] = static_cast<uint8_t>(0U - (bits & 1U));
+                }
+                if (wantSupport) {
+                    s[x] = static_cast<uint8_t>(0U - ((bits >> 1) & 1U));
+                }
+                if (wantExclude) {
+                    e[x] = static_cast<uint8_t>(0U - ((bits >> 2) & 1U));
+                }
+            }
+        }
+    };
+
+    constexpr int kParallelPixels = 1 << 16;
+    if (hsv.rows * hsv.cols >= kParallelPixels) {
+        cv::parallel_for_(cv::Range(0, hsv.rows), classifyRows);
+    } else {
+        classifyRows(cv::Range(0, hsv.rows));
+    }
+}
+
+inline uint64_t HashTile(const cv::Mat& image, const cv::Rect& tile) {
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ (static_cast<uint64_t>(tile.width) << 32) ^ static_cast<uint64_t>(tile.height);
+    auto mix = [&h](uint64_t word) {
+        h = (h ^ word) * 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 32;
+    };
+    const size_t rowBytes = static_cast<size_t>(tile.width) * image.elemSize();
+    for (int y = tile.y; y < tile.y + tile.height; ++y) {
+        const uint8_t* row = image.ptr<uint8_t>(y) + static_cast<size_t>(tile.x) * image.elemSize();
+        size_t i = 0;
+        for (; i + sizeof(uint64_t) <= rowBytes; i += sizeof(uint64_t)) {
+            uint64_t word = 0;
+            std::memcpy(&word, row + i, sizeof(uint64_t));
+            mix(word);
+        }
+        if (i < rowBytes) {
+            uint64_t word = 0;
+            std::memcpy(&word, row + i, rowBytes - i);
+            mix(word);
+        }
+    }
+    return h;
+}
+
+inline uint64_t HashCombine(uint64_t h, uint64_t value) {
+    h = (h ^ value) * 0xFF51AFD7ED558CCDULL;
+    return h ^ (h >> 32);
+}
+
+// Hash of the settings a candidate's metrics depend on besides its pixels: shape
+// thresholds, the context ring and its colors, and whether rejected candidates are
+// fully scored. Center color and morphology are covered by the center-mask bytes.
+inline uint64_t VerdictConfigKey(const ColorPatternConfig& cfg) {
+    uint64_t h = 0x6A09E667F3BCC908ULL;
+    auto mixFloat = [&h](float v) {
+        uint32_t bits = 0;
+        std::memcpy(&bits, &v, sizeof(bits));
+        h = HashCombine(h, bits);
+    };
+    auto mixInt = [&h](int v) { h = HashCombine(h, static_cast<uint64_t>(static_cast<uint32_t>(v))); };
+    auto mixHues = [&](const HueRangeSet& hues) {
+        mixInt(static_cast<int>(hues.Ranges().size()));
+        for (const HueRange& r : hues.Ranges()) {
+            mixInt(r.minHue);
+            mixInt(r.maxHue);
+        }
+    };
+    mixInt(cfg.shape.minArea);
+    mixInt(cfg.shape.maxArea);
+    mixFloat(cfg.shape.minCircularity);
+    mixFloat(cfg.shape.minFillRatio);
+    mixInt(cfg.context.enabled ? 1 : 0);
+    mixInt(cfg.debug.drawRejected ? 1 : 0);
+    if (cfg.context.enabled) {
+        mixInt(cfg.context.innerRadiusPercent);
+        mixInt(cfg.context.outerRadiusPercent);
+        mixHues(cfg.context.supportColor.hues);
+        mixInt(cfg.context.supportColor.satRange.minValue);
+        mixInt(cfg.context.supportColor.satRange.maxValue);
+        mixInt(cfg.context.supportColor.valRange.minValue);
+        mixInt(cfg.context.supportColor.valRange.maxValue);
+        mixHues(cfg.context.excludeHues);
+        mixInt(cfg.context.excludeSatRange.minValue);
+        mixInt(cfg.context.excludeSatRange.maxValue);
+        mixInt(cfg.context.excludeValRange.minValue);
+        mixInt(cfg.context.excludeValRange.maxValue);
+        mixFloat(cfg.context.minSupportRatio);
+    }
+    return h;
+}
+
+inline bool SameTile(const cv::Mat& image, const cv::Rect& a, const cv::Rect& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    const size_t rowBytes = static_cast<size_t>(a.width) * image.elemSize();
+    for (int dy = 0; dy < a.height; ++dy) {
+        const uint8_t* rowA = image.ptr<uint8_t>(a.y + dy) + static_cast<size_t>(a.x) * image.elemSize();
+        const uint8_t* rowB = image.ptr<uint8_t>(b.y + dy) + static_cast<size_t>(b.x) * image.elemSize();
+        if (std::memcmp(rowA, rowB, rowBytes) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ClassifyWithLut with duplicate-tile elimination (see TileDedupState): tiles are
+// hashed in parallel, matched against the first tile with the same hash and bytes,
+// distinct tiles are classified in runs along each tile row, and duplicates copy the
+// mask bits of their match. Writes the same masks as ClassifyWithLut and records the
+// frame in `state`.
+inline TileDedupFrame ClassifyTilesDeduped(
+    const cv::Mat& hsv,
+    const ClassLut& lut,
+    cv::Mat& center,
+    cv::Mat* support,
+    cv::Mat* exclude,
+    TileDedupState& state) {
+    const int64_t t0 = cv::getTickCount();
+    const int tileSize = TileDedupState::kTileSize;
+    const int tilesX = (hsv.cols + tileSize - 1) / tileSize;
+    const int tilesY = (hsv.rows + tileSize - 1) / tileSize;
+    const int count = tilesX * tilesY;
+    const cv::Rect frame(0, 0, hsv.cols, hsv.rows);
+    auto tileRect = [&](int i) {
+        return cv::Rect((i % tilesX) * tileSize, (i / tilesX) * tileSize, tileSize, tileSize) & frame;
+    };
+
+    state.hashes.resize(static_cast<size_t>(count));
+    state.source.assign(static_cast<size_t>(count), -1);
+    cv::parallel_for_(cv::Range(0, tilesY), [&](const cv::Range& rows) {
+        for (int i = rows.start * tilesX; i < rows.end * tilesX; ++i) {
+            state.hashes[static_cast<size_t>(i)] = HashTile(hsv, tileRect(i));
+        }
+    });
+
+    // Serial so the first occurrence in raster order is always the one classified.
+    state.firstByHash.clear();
+    int duplicates = 0;
+    for (int i = 0; i < count; ++i) {
+        const auto [it, inserted] = state.firstByHash.emplace(state.hashes[static_cast<size_t>(i)], i);
+        if (!inserted && SameTile(hsv, tileRect(it->second), tileRect(i))) {
+            state.source[static_cast<size_t>(i)] = it->second;
+            ++duplicates;
+        }
+    }
+    const int64_t t1 = cv::getTickCount();
+
+    cv::parallel_for_(cv::Range(0, tilesY), [&](const cv::Range& rows) {
+        for (int ty = rows.start; ty < rows.end; ++ty) {
+            int tx = 0;
+            while (tx < tilesX) {
+                if (state.source[static_cast<size_t>(ty * tilesX + tx)] >= 0) {
+                    ++tx;
+                    continue;
+                }
+                const int runStart = tx;
+                while (tx < tilesX && state.source[static_cast<size_t>(ty * tilesX + tx)] < 0) {
+                    ++tx;
+                }
+                const cv::Rect run = cv::Rect(runStart * tileSize, ty * tileSize, (tx - runStart) * tileSize, tileSize) & frame;
+                cv::Mat centerRoi = center(run);
+                cv::Mat supportRoi = support != nullptr ? (*support)(run) : cv::Mat();
+                cv::Mat excludeRoi = exclude != nullptr ? (*exclude)(run) : cv::Mat();
+                ClassifyWithLut(
+                    hsv(run),
+                    lut,
+                    &centerRoi,
+                    support != nullptr ? &supportRoi : nullptr,
+                    exclude != nullptr ? &excludeRoi : nullptr);
+            }
+        }
+    });
+    const int64_t t2 = cv::getTickCount();
+
+    if (duplicates > 0) {
+        cv::parallel_for_(cv::Range(0, tilesY), [&](const cv::Range& rows) {
+            auto copyTile = [](cv::Mat* mask, const cv::Rect& from, const cv::Rect& to) {
+                if (mask != nullptr) {
+                    cv::Mat dst = (*mask)(to);
+                    (*mask)(from).copyTo(dst);
+                }
+            };
+            for (int i = rows.start * tilesX; i < rows.end * tilesX; ++i) {
+                const int from = state.source[static_cast<size_t>(i)];
+                if (from >= 0) {
+                    const cv::Rect fromRect = tileRect(from);
+                    const cv::Rect toRect = tileRect(i);
+                    copyTile(&center, fromRect, toRect);
+                    copyTile(support, fromRect, toRect);
+                    copyTile(exclude, fromRect, toRect);
+                }
+            }
+        });
+    }
+    const int64_t t3 = cv::getTickCount();
+
+    TileDedupFrame result;
+    result.ran = true;
+    result.tiles = count;
+    result.duplicateTiles = duplicates;
+    result.overheadMs = TicksToMs((t1 - t0) + (t3 - t2));
+    const int distinct = count - duplicates;
+    result.savedMs = distinct > 0 ? TicksToMs(t2 - t1) * static_cast<double>(duplicates) / static_cast<double>(distinct) : 0.0;
+    state.EndFrame(result);
+    return result;
+}
+
+inline float HalfToFloat(uint16_t half) {
+    const uint32_t sign = static_cast<uint32_t>(half & 0x8000U) << 16;
+    uint32_t exponent = (half >> 10) & 0x1FU;
+    uint32_t mantissa = half & 0x3FFU;
+    uint32_t bits = 0;
+    if (exponent == 0) {
+        if (mantissa == 0) {
+            bits = sign;
+        } else {
+            exponent = 113;
+            while ((mantissa & 0x400U) == 0) {
+                mantissa <<= 1;
+                --exponent;
+            }
+            bits = sign | (exponent << 23) | ((mantissa & 0x3FFU) << 13);
+        }
+    } else if (exponent == 31) {
+        bits = sign | 0x7F800000U | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    float value = 0.0F;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Every half-float bit pattern mapped to an sRGB-encoded value in [0,1]: linear
+// scRGB is clamped to [0,1] (negative and NaN to 0) and passed through the sRGB
+// transfer, so SDR content lands where an 8-bit capture would put it. Built once.
+inline const std::vector<float>& HalfToEncodedTable() {
+    static const std::vector<float> table = [] {
+        std::vector<float> t(65536);
+        for (uint32_t i = 0; i < 65536U; ++i) {
+            float v = HalfToFloat(static_cast<uint16_t>(i));
+            v = (v > 0.0F) ? std::min(v, 1.0F) : 0.0F;
+            t[i] = (v <= 0.0031308F) ? 12.92F * v : 1.055F * std::pow(v, 1.0F / 2.4F) - 0.055F;
+        }
+        return t;
+    }();
+    return table;
+}
+
+// OpenCV's 8-bit HSV encoding (H in [0,180), S and V in [0,255]) of an RGB value in
+// [0,1], computed at float precision and quantized once.
+inline void EncodeHsv(float r, float g, float b, uint8_t* out) {
+    const float v = std::max(r, std::max(g, b));
+    const float delta = v - std::min(r, std::min(g, b));
+    float h = 0.0F;
+    if (delta > 0.0F) {
+        if (v == r) {
+            h = (g - b) / delta;
+        } else if (v == g) {
+            h = 2.0F + (b - r) / delta;
+        } else {
+            h = 4.0F + (r - g) / delta;
+        }
+        h *= 30.0F;
+        if (h < 0.0F) {
+            h += 180.0F;
+        }
+    }
+    int hq = static_cast<int>(h + 0.5F);
+    hq = (hq >= 180) ? hq - 180 : hq;
+    const float s = (v > 0.0F) ? delta / v : 0.0F;
+    out[0] = static_cast<uint8_t>(hq);
+    out[1] = static_cast<uint8_t>(static_cast<int>(s * 255.0F + 0.5F));
+    out[2] = static_cast<uint8_t>(static_cast<int>(v * 255.0F + 0.5F));
+}
+
+// Converts an HdrFormat frame straight into the 8-bit HSV image the pipeline
+// classifies, in one pass over the source rows.
+inline void ConvertHdrToHsv(const cv::Mat& source, HdrFormat format, cv::Mat& hsv) {
+    const int expectedType = (format == HdrFormat::Rgb10A2) ? CV_32SC1 : CV_16UC4;
+    if (source.type() != expectedType) {
+        throw std::invalid_argument(format == HdrFormat::Rgb10A2
+            ? "Rgb10A2 input must be CV_32SC1."
+            : "Rgba16F input must be CV_16UC4.");
+    }
+    hsv.create(source.size(), CV_8UC3);
+
+    const std::vector<float>* halfTable = (format == HdrFormat::Rgba16F) ? &HalfToEncodedTable() : nullptr;
+    auto convertRows = [&](const cv::Range& rows) {
+        constexpr float kScale10 = 1.0F / 1023.0F;
+        for (int y = rows.start; y < rows.end; ++y) {
+            uint8_t* out = hsv.ptr<uint8_t>(y);
+            if (halfTable == nullptr) {
+                const uint32_t* px = source.ptr<uint32_t>(y);
+                for (int x = 0; x < source.cols; ++x, out += 3) {
+                    const uint32_t w = px[x];
+                    EncodeHsv(
+                        static_cast<float>(w & 0x3FFU) * kScale10,
+                        static_cast<float>((w >> 10) & 0x3FFU) * kScale10,
+                        static_cast<float>((w >> 20) & 0x3FFU) * kScale10,
+                        out);
+                }
+            } else {
+                const uint16_t* px = source.ptr<uint16_t>(y);
+                const float* table = halfTable->data();
+                for (int x = 0; x < source.cols; ++x, px += 4, out += 3) {
+                    EncodeHsv(table[px[0]], table[px[1]], table[px[2]], out);
+                }
+            }
+        }
+    };
+
+    constexpr int kParallelPixels = 1 << 16;
+    if (source.rows * source.cols >= kParallelPixels) {
+        cv::parallel_for_(cv::Range(0, source.rows), convertRows);
+    } else {
+        convertRows(cv::Range(0, source.rows));
+    }
+}
+
+// ClassifyWithLut for several disjoint rectangles of `hsv` in one pass over the rows:
+// pixels of rects[i] are classified with luts[i], pixels outside every rect are not
+// written. Null support/exclude outputs are skipped; outputs are frame-sized.
+inline void ClassifyRectsWithLut(
+    const cv::Mat& hsv,
+    const std::vector<cv::Rect>& rects,
+    const std::vector<ClassLut>& luts,
+    cv::Mat& center,
+    cv::Mat* support,
+    cv::Mat* exclude) {
+    int64_t pixels = 0;
+    for (const cv::Rect& r : rects) {
+        pixels += static_cast<int64_t>(r.area());
+    }
+    auto classifyRows = [&](const cv::Range& rows) {
+        for (int y = rows.start; y < rows.end; ++y) {
+            const uint8_t* hsvRow = hsv.ptr<uint8_t>(y);
+            uint8_t* c = center.ptr<uint8_t>(y);
+            uint8_t* s = support != nullptr ? support->ptr<uint8_t>(y) : nullptr;
+            uint8_t* e = exclude != nullptr ? exclude->ptr<uint8_t>(y) : nullptr;
+            for (size_t i = 0; i < rects.size(); ++i) {
+                const cv::Rect& r = rects[i];
+                if (y < r.y || y >= r.y + r.height) {
+                    continue;
+                }
+                const ClassLut& lut = luts[i];
+                const uint8_t* px = hsvRow + static_cast<size_t>(r.x) * 3;
+                for (int x = r.x; x < r.x + r.width; ++x, px += 3) {
+                    const unsigned bits = static_cast<unsigned>(lut.hue[px[0]] & lut.sat[px[1]] & lut.val[px[2]]);
+                    c[x] = static_cast<uint8_t>(0U - (bits & 1U));
+                    if (s != nullptr) {
+                        s[x] = static_cast<uint8_t>(0U - ((bits >> 1) & 1U));
+                    }
+                    if (e != nullptr) {
+                        e[x] = static_cast<uint8_t>(0U - ((bits >> 2) & 1U));
+                    }
+                }
+            }
+        }
+    };
+
+    constexpr int64_t kParallelPixels = 1 << 16;
+    if (pixels >= kParallelPixels) {
+        cv::parallel_for_(cv::Range(0, hsv.rows), classifyRows);
+    } else {
+        classifyRows(cv::Range(0, hsv.rows));
+    }
+}
+
+// Counts center/support/exclude pixels per grid cell (3 counters per cell, row-major)
+// in one pass. Without `hsv`, scene rows (BGR or BGRA) are converted to HSV one row at
+// a time, so no frame-sized HSV image is written. With `centerMask`, center pixels are
+// read from the mask instead of the LUT. Stripes of rows run in parallel; the counts
+// are integers, so the result does not depend on the thread count.
+inline void AccumulateCoverage(
+    const cv::Mat& scene,
+    const cv::Mat* hsv,
+    const cv::Mat* centerMask,
+    const ClassLut& lut,
+    int cols,
+    int rows,
+    std::vector<uint64_t>& counts) {
+    const int width = scene.cols;
+    const int height = scene.rows;
+    std::vector<int> cellOfX(static_cast<size_t>(width));
+    for (int c = 0; c < cols; ++c) {
+        const int x0 = static_cast<int>(static_cast<int64_t>(c) * width / cols);
+        const int x1 = static_cast<int>(static_cast<int64_t>(c + 1) * width / cols);
+        std::fill(cellOfX.begin() + x0, cellOfX.begin() + x1, c);
+    }
+    std::vector<int> cellOfY(static_cast<size_t>(height));
+    for (int r = 0; r < rows; ++r) {
+        const int y0 = static_cast<int>(static_cast<int64_t>(r) * height / rows);
+        const int y1 = static_cast<int>(static_cast<int64_t>(r + 1) * height / rows);
+        std::fill(cellOfY.begin() + y0, cellOfY.begin() + y1, r);
+    }
+
+    counts.assign(static_cast<size_t>(cols) * static_cast<size_t>(rows) * 3, 0);
+    std::mutex mergeMutex;
+    constexpr int kStripeRows = 32;
+    const int stripes = (height + kStripeRows - 1) / kStripeRows;
+    cv::parallel_for_(cv::Range(0, stripes), [&](const cv::Range& range) {
+        std::vector<uint32_t> local(counts.size(), 0);
+        cv::Mat hsvRow;
+        for (int stripe = range.start; stripe < range.end; ++stripe) {
+            const int yEnd = std::min(height, (stripe + 1) * kStripeRows);
+            for (int y = stripe * kStripeRows; y < yEnd; ++y) {
+                const uint8_t* px = nullptr;
+                if (hsv != nullptr) {
+                    px = hsv->ptr<uint8_t>(y);
+                } else {
+                    // BGR2HSV reads 4-channel rows directly and ignores alpha.
+                    cv::cvtColor(scene.row(y), hsvRow, cv::COLOR_BGR2HSV);
+                    px = hsvRow.ptr<uint8_t>(0);
+                }
+                const uint8_t* mask = centerMask != nullptr ? centerMask->ptr<uint8_t>(y) : nullptr;
+                uint32_t* cellRow = local.data() + static_cast<size_t>(cellOfY[static_cast<size_t>(y)]) * cols * 3;
+                for (int x = 0; x < width; ++x, px += 3) {
+                    const unsigned bits = static_cast<unsigned>(lut.hue[px[0]] & lut.sat[px[1]] & lut.val[px[2]]);
+                    uint32_t* cell = cellRow + static_cast<size_t>(cellOfX[static_cast<size_t>(x)]) * 3;
+                    cell[0] += mask != nullptr ? (mask[x] != 0 ? 1U : 0U) : (bits & 1U);
+                    cell[1] += (bits >> 1) & 1U;
+                    cell[2] += (bits >> 2) & 1U;
+                }
+            }
+        }
+        std::lock_guard<std::mutex> lock(mergeMutex);
+        for (size_t i = 0; i < counts.size(); ++i) {
+            counts[i] += local[i];
+        }
+    });
+}
+
+inline cv::Mat BuildMask(const cv::Mat& hsv, const ColorMaskConfig& cfg) {
+    return cfg.hues.BuildMask(
+        hsv,
+        cfg.satRange.minValue,
+        cfg.satRange.maxValue,
+        cfg.valRange.minValue,
+        cfg.valRange.maxValue);
+}
+
+inline void BuildMaskInto(const cv::Mat& hsv, const ColorMaskConfig& cfg, cv::Mat& out, DetectionWorkspace& ws) {
+    cfg.hues.BuildMaskInto(
+        hsv,
+        cfg.satRange.minValue,
+        cfg.satRange.maxValue,
+        cfg.valRange.minValue,
+        cfg.valRange.maxValue,
+        out,
+        ws.maskScratchA,
+        ws.maskScratchB);
+}
+
+inline cv::Mat BuildExcludeMask(
+    const cv::Mat& hsv,
+    const HueRangeSet& ranges,
+    const ChannelRange& satRange,
+    const ChannelRange& valRange) {
+    return ranges.BuildMask(hsv, satRange.minValue, satRange.maxValue, valRange.minValue, valRange.maxValue);
+}
+
+// `borderType` may include cv::BORDER_ISOLATED so a ROI header is filtered as if it
+// were a separate image.
+inline void ApplyMorphology(cv::Mat& mask, const MorphologyConfig& cfg, int borderType = cv::BORDER_CONSTANT) {
+    if (mask.empty()) {
+        return;
+    }
+    const cv::Mat k3 = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(3, 3));
+    if (cfg.openIterations > 0) {
+        cv::morphologyEx(mask, mask, cv::MORPH_OPEN, k3, cv::Point(-1, -1), cfg.openIterations, borderType);
+    }
+    if (cfg.closeIterations > 0) {
+        cv::morphologyEx(mask, mask, cv::MORPH_CLOSE, k3, cv::Point(-1, -1), cfg.closeIterations, borderType);
+    }
+    if (cfg.dilateIterations > 0) {
+        cv::dilate(mask, mask, k3, cv::Point(-1, -1), cfg.dilateIterations, borderType);
+    }
+}
+
+inline float ComputeCircularity(const std::vector<cv::Point>& contour) {
+    const float area = static_cast<float>(cv::contourArea(contour));
+    const float perimeter = static_cast<float>(cv::arcLength(contour, true));
+    if (area <= 0.0F || perimeter <= 0.0F) {
+        return 0.0F;
+    }
+    return static_cast<float>((4.0 * CV_PI * area) / (perimeter * perimeter));
+}
+
+// Unit vectors of the 180 OpenCV hues, for circular hue means.
+inline const std::array<cv::Point2f, 180>& HueUnitVectors() {
+    static const std::array<cv::Point2f, 180> table = [] {
+        std::array<cv::Point2f, 180> t{};
+        for (int h = 0; h < 180; ++h) {
+            const double angle = static_cast<double>(h) * CV_PI / 90.0;
+            t[static_cast<size_t>(h)] = cv::Point2f(static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)));
+        }
+        return t;
+    }();
+    return table;
+}
+
+// Accumulates the blob's color in one pass over its bounding box: the contour is filled
+// into `blobMask` (box-sized scratch) and only pixels set in both it and the center
+// mask are read, so holes and neighbouring blobs inside the box are left out.
+inline void MeasureBlobColor(
+    const cv::Mat& hsv,
+    const cv::Mat& centerMask,
+    const std::vector<cv::Point>& contour,
+    const cv::Rect& box,
+    cv::Mat& blobMask,
+    BlobColorStats& out) {
+    out = {};
+    blobMask.create(box.size(), CV_8U);
+    blobMask.setTo(cv::Scalar::all(0));
+    const cv::Point* points = contour.data();
+    const int pointCount = static_cast<int>(contour.size());
+    cv::fillPoly(blobMask, &points, &pointCount, 1, cv::Scalar(255), cv::LINE_8, 0, cv::Point(-box.x, -box.y));
+
+    const std::array<cv::Point2f, 180>& unit = HueUnitVectors();
+    double sumX = 0.0;
+    double sumY = 0.0;
+    int64_t sumSat = 0;
+    int64_t sumVal = 0;
+    int brightest = -1;
+    for (int y = 0; y < box.height; ++y) {
+        const uint8_t* blob = blobMask.ptr<uint8_t>(y);
+        const uint8_t* mask = centerMask.ptr<uint8_t>(box.y + y) + box.x;
+        const uint8_t* px = hsv.ptr<uint8_t>(box.y + y) + static_cast<size_t>(box.x) * 3;
+        for (int x = 0; x < box.width; ++x, px += 3) {
+            if ((blob[x] & mask[x]) == 0) {
+                continue;
+            }
+            const int hue = std::min<int>(px[0], 179);
+            sumX += unit[static_cast<size_t>(hue)].x;
+            sumY += unit[static_cast<size_t>(hue)].y;
+            sumSat += px[1];
+            sumVal += px[2];
+            out.hueHistogram[static_cast<size_t>(hue / 10)] += 1;
+            out.pixelCount += 1;
+            if (px[2] > brightest) {
+                brightest = px[2];
+                out.brightestPx = cv::Point(box.x + x, box.y + y);
+                out.brightestHsv = cv::Vec3b(px[0], px[1], px[2]);
+            }
+        }
+    }
+    if (out.pixelCount == 0) {
+        return;
+    }
+
+    const double count = static_cast<double>(out.pixelCount);
+    double meanHue = std::atan2(sumY, sumX) * 90.0 / CV_PI;
+    if (meanHue < 0.0) {
+        meanHue += 180.0;
+    }
+    out.meanHue = (meanHue >= 180.0) ? 0.0F : static_cast<float>(meanHue);
+    out.meanSat = static_cast<float>(static_cast<double>(sumSat) / count);
+    out.meanVal = static_cast<float>(static_cast<double>(sumVal) / count);
+}
+
+// Sorts detections (accepted first, then by score) and fills the accepted outputs.
+inline void RankDetections(ColorPatternRunResult& result) {
+    std::sort(result.detections.begin(), result.detections.end(),
+        [](const ColorPatternDetection& a, const ColorPatternDetection& b) {
+            if (a.metrics.accepted != b.metrics.accepted) {
+                return a.metrics.accepted > b.metrics.accepted;
+            }
+            return a.metrics.score > b.metrics.score;
+        });
+
+    for (const ColorPatternDetection& det : result.detections) {
+        if (det.metrics.accepted) {
+            result.acceptedCentersPx.push_back(det.centerPx);
+            result.acceptedBoxesPx.push_back(det.boxPx);
+            result.acceptedCount += 1;
+            result.score = std::max(result.score, det.metrics.score);
+        }
+    }
+    result.acceptedRatio = SafeDiv(static_cast<float>(result.acceptedCount), static_cast<float>(std::max(1, result.rawCandidateCount)));
+}
+
+// Returns a 3-channel view of image. 3-channel inputs are returned as-is (Find never
+// writes to the scene); other layouts are converted into `converted`.
+inline const cv::Mat& EnsureColorInto(const cv::Mat& image, cv::Mat& converted) {
+    if (image.channels() == 3) {
+        return image;
+    }
+    if (image.channels() == 1) {
+        cv::cvtColor(image, converted, cv::COLOR_GRAY2BGR);
+    } else {
+        cv::cvtColor(image, converted, cv::COLOR_BGRA2BGR);
+    }
+    return converted;
+}
+
+inline void DrawLabel(
+    cv::Mat& image,
+    const std::string& text,
+    const cv::Point& anchor,
+    const DebugDrawConfig& dbg) {
+    if (image.empty() || text.empty() || !dbg.drawLabels) {
+        return;
+    }
+    int baseline = 0;
+    const cv::Size textSize = cv::getTextSize(text, cv::FONT_HERSHEY_SIMPLEX, dbg.fontScale, dbg.lineThickness, &baseline);
+
+    int x = std::max(0, anchor.x);
+    int y = std::max(textSize.height + 1, anchor.y);
+    if (x + textSize.width + 2 >= image.cols) {
+        x = std::max(0, image.cols - textSize.width - 2);
+    }
+    if (y >= image.rows) {
+        y = std::max(textSize.height + 1, image.rows - 2);
+    }
+
+    if (dbg.drawLabelBackground) {
+        const cv::Point tl(std::max(0, x - dbg.labelPaddingPx), std::max(0, y - textSize.height - dbg.labelPaddingPx));
+        const cv::Point br(std::min(image.cols - 1, x + textSize.width + dbg.labelPaddingPx), std::min(image.rows - 1, y + baseline + dbg.labelPaddingPx));
+        cv::rectangle(image, tl, br, dbg.labelBgColor, cv::FILLED);
+    }
+    cv::putText(image, text, cv::Point(x, y), cv::FONT_HERSHEY_SIMPLEX, dbg.fontScale, dbg.textColor, dbg.lineThickness, cv::LINE_AA);
+}
+
+constexpr size_t kMetricLabelChars = 80;  // three AppendFixed2 values of up to 20 chars, plus text
+
+// Appends `v` with two decimals ("-12.34"); values are rounded half away from zero.
+inline char* AppendFixed2(char* out, float v) {
+    if (!(v == v)) {
+        *out++ = 'n';
+        *out++ = 'a';
+        *out++ = 'n';
+        return out;
+    }
+    if (v < 0.0F) {
+        *out++ = '-';
+        v = -v;
+    }
+    const uint64_t hundredths = static_cast<uint64_t>(std::min(static_cast<double>(v), 1.0e15) * 100.0 + 0.5);
+    uint64_t whole = hundredths / 100;
+    char digits[20];
+    int n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + (whole % 10));
+        whole /= 10;
+    } while (whole > 0);
+    while (n > 0) {
+        *out++ = digits[--n];
+    }
+    *out++ = '.';
+    *out++ = static_cast<char>('0' + (hundredths / 10) % 10);
+    *out++ = static_cast<char>('0' + hundredths % 10);
+    return out;
+}
+
+// Formats the candidate label ("A rr=0.42 c=0.88 f=0.91") into `out` without
+// allocating and returns its length.
+inline size_t FormatMetricLabel(const DetectionMetrics& m, char (&out)[kMetricLabelChars]) {
+    char* p = out;
+    auto append = [&p](const char* text) {
+        while (*text != '\0') {
+            *p++ = *text++;
+        }
+    };
+    *p++ = m.accepted ? 'A' : 'R';
+    append(" rr=");
+    p = AppendFixed2(p, m.ringSupportRatio);
+    append(" c=");
+    p = AppendFixed2(p, m.circularity);
+    append(" f=");
+    p = AppendFixed2(p, m.centerFillRatio);
+    *p = '\0';
+    return static_cast<size_t>(p - out);
+}
+
+inline std::string BuildMetricLabel(const DetectionMetrics& m) {
+    char label[kMetricLabelChars];
+    const size_t length = FormatMetricLabel(m, label);
+    return std::string(label, length);
+}
+
+// Anti-aliased Hershey glyphs for the characters of metric labels, rasterized once
+// per font scale and thickness as 8-bit coverage. Labels are composed by placing
+// glyph cells at their advances and blended in the label color, which replaces a
+// getTextSize + putText per label and panel. Atlases are cached process-wide.
+class GlyphAtlas {
+public:
+    static constexpr const char* kCharset = " .-0123456789=ARacfnr";
+
+    GlyphAtlas(double fontScale, int thickness)
+        : fontScale_(fontScale), thickness_(thickness), pad_(thickness + 1) {
+        glyphIndex_.fill(-1);
+        const std::string charset(kCharset);
+        int cellsWidth = 0;
+        for (const char c : charset) {
+            const std::string glyph(1, c);
+            int glyphBaseline = 0;
+            const cv::Size size = cv::getTextSize(glyph, cv::FONT_HERSHEY_SIMPLEX, fontScale, thickness, &glyphBaseline);
+            // getTextSize adds the thickness once per call; at scale 1 and thickness 1
+            // what remains is the glyph's advance in font units.
+            const int units = cv::getTextSize(glyph, cv::FONT_HERSHEY_SIMPLEX, 1.0, 1, nullptr).width - 1;
+            ascent_ = std::max(ascent_, size.height);
+            baseline_ = std::max(baseline_, glyphBaseline);
+            glyphIndex_[static_cast<unsigned char>(c)] = static_cast<int16_t>(glyphs_.size());
+            glyphs_.push_back(Glyph{ cellsWidth, units, size.width });
+            cellsWidth += size.width + 2 * pad_;
+        }
+        cellHeight_ = ascent_ + baseline_ + 2 * pad_;
+
+        atlas_ = cv::Mat(cellHeight_, std::max(1, cellsWidth), CV_8U, cv::Scalar(0));
+        for (size_t i = 0; i < charset.size(); ++i) {
+            const Glyph& g = glyphs_[i];
+            cv::Mat cell = atlas_(cv::Rect(g.cellX, 0, g.width + 2 * pad_, cellHeight_));
+            cv::putText(cell, std::string(1, charset[i]), cv::Point(pad_, pad_ + ascent_),
+                cv::FONT_HERSHEY_SIMPLEX, fontScale, cv::Scalar(255), thickness, cv::LINE_AA);
+        }
+    }
+
+    // Shared atlas for a font scale and thickness; built on first use.
+    static std::shared_ptr<const GlyphAtlas> Get(double fontScale, int thickness) {
+        static std::mutex mutex;
+        static std::vector<std::shared_ptr<const GlyphAtlas>> cache;
+        constexpr size_t kMaxCached = 8;
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& atlas : cache) {
+            if (atlas->fontScale_ == fontScale && atlas->thickness_ == thickness) {
+                return atlas;
+            }
+        }
+        if (cache.size() >= kMaxCached) {
+            cache.erase(cache.begin());
+        }
+        cache.push_back(std::make_shared<const GlyphAtlas>(fontScale, thickness));
+        return cache.back();
+    }
+
+    bool Covers(const char* text, size_t length) const {
+        for (size_t i = 0; i < length; ++i) {
+            if (glyphIndex_[static_cast<unsigned char>(text[i])] < 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Width of the whole of `text`, computed the way getTextSize does: the scaled sum of
+    // the advances plus the thickness once.
+    int TextWidth(const char* text, size_t length) const {
+        int units = 0;
+        for (size_t i = 0; i < length; ++i) {
+            units += glyphs_[static_cast<size_t>(glyphIndex_[static_cast<unsigned char>(text[i])])].units;
+        }
+        return static_cast<int>(std::lrint(static_cast<double>(units) * fontScale_ + thickness_));
+    }
+
+    int Ascent() const { return ascent_; }
+    int Baseline() const { return baseline_; }
+    int Pad() const { return pad_; }
+
+    // Writes the coverage of `text` into `alpha` (CV_8U, grown as needed) and returns
+    // the view holding it. The baseline origin is at (Pad(), Pad() + Ascent()).
+    cv::Mat Compose(const char* text, size_t length, cv::Mat& alpha) const {
+        const cv::Size size(TextWidth(text, length) + 2 * pad_, cellHeight_);
+        cv::Mat view = GrowView(alpha, size, CV_8U);
+        view.setTo(cv::Scalar(0));
+        int units = 0;
+        for (size_t i = 0; i < length; ++i) {
+            const Glyph& g = glyphs_[static_cast<size_t>(glyphIndex_[static_cast<unsigned char>(text[i])])];
+            // Pen positions follow putText: the scaled advance sum, rounded per glyph.
+            const int penX = static_cast<int>(std::lrint(static_cast<double>(units) * fontScale_));
+            const int cellWidth = std::min(g.width + 2 * pad_, view.cols - penX);
+            for (int y = 0; y < cellHeight_; ++y) {
+                const uint8_t* src = atlas_.ptr<uint8_t>(y) + g.cellX;
+                uint8_t* dst = view.ptr<uint8_t>(y) + penX;
+                for (int x = 0; x < cellWidth; ++x) {
+                    dst[x] = std::max(dst[x], src[x]);
+                }
+            }
+            units += g.units;
+        }
+        return view;
+    }
+
+private:
+    struct Glyph {
+        int cellX = 0;
+        int units = 0;   // advance in font units at scale 1
+        int width = 0;   // getTextSize width of the glyph alone (ink plus thickness)
+    };
+
+    double fontScale_;
+    int thickness_;
+    int pad_;
+    int ascent_ = 0;
+    int baseline_ = 0;
+    int cellHeight_ = 0;
+    std::array<int16_t, 256> glyphIndex_{};
+    std::vector<Glyph> glyphs_;
+    cv::Mat atlas_;
+};
+
+// Blends `color` into the BGR `image` with per-pixel `alpha` coverage, placing alpha's
+// top-left at `tl` and clipping to the image. Integer arithmetic without branches in
+// the inner loop, so the compiler vectorizes it.
+inline void BlendCoverage(cv::Mat& image, const cv::Mat& alpha, const cv::Point& tl, const cv::Scalar& color) {
+    const cv::Rect dstRect = cv::Rect(tl, alpha.size()) & cv::Rect(0, 0, image.cols, image.rows);
+    if (dstRect.empty()) {
+        return;
+    }
+    const int b = static_cast<int>(std::clamp(color[0], 0.0, 255.0));
+    const int g = static_cast<int>(std::clamp(color[1], 0.0, 255.0));
+    const int r = static_cast<int>(std::clamp(color[2], 0.0, 255.0));
+    for (int y = 0; y < dstRect.height; ++y) {
+        const uint8_t* a = alpha.ptr<uint8_t>(dstRect.y - tl.y + y) + (dstRect.x - tl.x);
+        uint8_t* px = image.ptr<uint8_t>(dstRect.y + y) + static_cast<size_t>(dstRect.x) * 3;
+        for (int x = 0; x < dstRect.width; ++x, px += 3) {
+            const int w = a[x];
+            // (d * (255 - w) + c * w) / 255, rounded.
+            auto mix = [w](int d, int c) {
+                const int v = d * (255 - w) + c * w + 128;
+                return static_cast<uint8_t>((v + (v >> 8)) >> 8);
+            };
+            px[0] = mix(px[0], b);
+            px[1] = mix(px[1], g);
+            px[2] = mix(px[2], r);
+        }
+    }
+}
+
+// Draws a metric label at `anchor` into each of `images` (BGR panels of one size),
+// placed like DrawLabel. The label is formatted and composed from `atlas` once, then
+// blended into every panel; text outside the atlas charset falls back to DrawLabel.
+inline void DrawMetricLabel(
+    std::initializer_list<cv::Mat*> images,
+    const DetectionMetrics& m,
+    const cv::Point& anchor,
+    const DebugDrawConfig& dbg,
+    const GlyphAtlas& atlas,
+    cv::Mat& alphaScratch) {
+    if (!dbg.drawLabels) {
+        return;
+    }
+    char label[kMetricLabelChars];
+    const size_t length = FormatMetricLabel(m, label);
+    if (!atlas.Covers(label, length)) {
+        for (cv::Mat* image : images) {
+            DrawLabel(*image, std::string(label, length), anchor, dbg);
+        }
+        return;
+    }
+
+    const cv::Mat alpha = atlas.Compose(label, length, alphaScratch);
+    const int textWidth = alpha.cols - 2 * atlas.Pad();
+    for (cv::Mat* image : images) {
+        if (image->empty()) {
+            continue;
+        }
+        int x = std::max(0, anchor.x);
+        int y = std::max(atlas.Ascent() + 1, anchor.y);
+        if (x + textWidth + 2 >= image->cols) {
+            x = std::max(0, image->cols - textWidth - 2);
+        }
+        if (y >= image->rows) {
+            y = std::max(atlas.Ascent() + 1, image->rows - 2);
+        }
+
+        if (dbg.drawLabelBackground) {
+            const cv::Point tl(std::max(0, x - dbg.labelPaddingPx), std::max(0, y - atlas.Ascent() - dbg.labelPaddingPx));
+            const cv::Point br(std::min(image->cols - 1, x + textWidth + dbg.labelPaddingPx), std::min(image->rows - 1, y + atlas.Baseline() + dbg.labelPaddingPx));
+            if (br.x >= tl.x && br.y >= tl.y) {
+                (*image)(cv::Rect(tl, cv::Point(br.x + 1, br.y + 1))).setTo(dbg.labelBgColor);
+            }
+        }
+        BlendCoverage(*image, alpha, cv::Point(x - atlas.Pad(), y - atlas.Ascent() - atlas.Pad()), dbg.textColor);
+    }
+}
+
+}
+
+class RegionPatternFinder;
+
+class ColorPatternFinder {
+public:
+    explicit ColorPatternFinder(ColorPatternConfig config = {}, const PlanHints& hints = {})
+        : config_(std::move(config)), plan_(CompilePlan(config_, hints)) {}
+
+    // Reuses `compiled`, a CompileConfig plan of `config` (e.g. kept with a config
+    // snapshot), so only the call-site hints are applied.
+    ColorPatternFinder(ColorPatternConfig config, const PipelinePlan& compiled, const PlanHints& hints)
+        : config_(std::move(config)), plan_(compiled) {
+        ApplyHints(plan_, hints);
+    }
+
+    // Chooses a kernel for each stage from the config and call-site hints.
+    static PipelinePlan CompilePlan(const ColorPatternConfig& cfg, const PlanHints& hints = {}) {
+        PipelinePlan plan = CompileConfig(cfg);
+        ApplyHints(plan, hints);
+        return plan;
+    }
+
+    // The part of the plan that depends only on the config: classifier and ring
+    // kernels and the class LUT. Context mask and fusion choices are left to ApplyHints.
+    static PipelinePlan CompileConfig(const ColorPatternConfig& cfg) {
+        PipelinePlan plan;
+        plan.drawRejected = cfg.debug.drawRejected;
+        plan.verdictKey = detail::VerdictConfigKey(cfg);
+
+        plan.centerArithmeticPasses = detail::ArithmeticPasses(cfg.centerColor.hues);
+        plan.morphologyIterations = cfg.centerMorph.openIterations + cfg.centerMorph.closeIterations + cfg.centerMorph.dilateIterations;
+        plan.morphology = plan.morphologyIterations > 0;
+
+        if (cfg.context.enabled) {
+            const ColorMaskConfig& support = cfg.context.supportColor;
+            const bool supportAcceptsAll = CoversAllHues(support.hues)
+                && support.satRange.minValue <= 0 && support.satRange.maxValue >= 255
+                && support.valRange.minValue <= 0 && support.valRange.maxValue >= 255;
+            plan.classifySupport = !supportAcceptsAll;
+            plan.classifyExclude = !cfg.context.excludeHues.Empty();
+
+            if (plan.classifySupport) {
+                plan.ring = RingKernel::Classified;
+            } else {
+                plan.ring = plan.classifyExclude ? RingKernel::ExcludeOnly : RingKernel::GeometryOnly;
+            }
+
+            if (plan.classifySupport || plan.classifyExclude) {
+                plan.contextArithmeticPasses = (plan.classifySupport ? detail::ArithmeticPasses(support.hues) : 0)
+                    + (plan.classifyExclude ? detail::ArithmeticPasses(cfg.context.excludeHues) : 0);
+                plan.contextClassifier = plan.contextArithmeticPasses > PipelinePlan::kMaxArithmeticPasses
+                    ? ClassifierKernel::Lut
+                    : ClassifierKernel::Arithmetic;
+            }
+        }
+
+        // The center table is built for every kernel: duplicate-tile classification
+        // (TileDedupState) always classifies through it.
+        plan.lut.Add(ClassLut::kCenter, cfg.centerColor.hues,
+            cfg.centerColor.satRange.minValue, cfg.centerColor.satRange.maxValue,
+            cfg.centerColor.valRange.minValue, cfg.centerColor.valRange.maxValue);
+        if (plan.contextClassifier == ClassifierKernel::Lut) {
+            if (plan.classifySupport) {
+                const ColorMaskConfig& support = cfg.context.supportColor;
+                plan.lut.Add(ClassLut::kSupport, support.hues,
+                    support.satRange.minValue, support.satRange.maxValue,
+                    support.valRange.minValue, support.valRange.maxValue);
+            }
+            if (plan.classifyExclude) {
+                plan.lut.Add(ClassLut::kExclude, cfg.context.excludeHues,
+                    cfg.context.excludeSatRange.minValue, cfg.context.excludeSatRange.maxValue,
+                    cfg.context.excludeValRange.minValue, cfg.context.excludeValRange.maxValue);
+            }
+        }
+        return plan;
+    }
+
+    // Sets the call-site choices on a CompileConfig plan: debug output, blob stats and
+    // lazy or dense context masks (with LUT fusion) from the expected ring coverage.
+    static void ApplyHints(PipelinePlan& plan, const PlanHints& hints) {
+        plan.renderDebug = hints.renderDebug;
+        plan.debugOutput = hints.debugOutput;
+        plan.expectedRingCoverage = hints.expectedRingCoverage;
+        plan.blobStats = hints.blobStats;
+
+        plan.contextMasks = ContextMaskKernel::Disabled;
+        if (plan.classifySupport || plan.classifyExclude) {
+            plan.contextMasks = (hints.expectedRingCoverage >= PipelinePlan::kDenseContextCoverage)
+                ? ContextMaskKernel::Dense
+                : ContextMaskKernel::LazyTiles;
+        }
+        plan.centerClassifier = plan.centerArithmeticPasses > PipelinePlan::kMaxArithmeticPasses
+            ? ClassifierKernel::Lut
+            : ClassifierKernel::Arithmetic;
+        plan.fusedDenseClassify = false;
+        if (plan.contextMasks == ContextMaskKernel::Dense && plan.contextClassifier == ClassifierKernel::Lut) {
+            // One LUT pass produces all three masks; cheaper than any split.
+            plan.centerClassifier = ClassifierKernel::Lut;
+            plan.fusedDenseClassify = true;
+        }
+    }
+
+    const PipelinePlan& Plan() const {
+        return plan_;
+    }
+
+    // Class coverage per grid cell without contour or candidate work. Center, support
+    // and exclude pixels are classified with one LUT and counted in a single pass over
+    // the scene. With applyMorphology (and a config that has morphology), the center
+    // mask is built and cleaned first, and center coverage is counted on the cleaned
+    // mask in the same counting pass. Support/exclude follow the context colors even
+    // when the context ring is disabled.
+    CoverageGrid MeasureCoverage(const cv::Mat& sceneBgr, DetectionWorkspace& ws, int cols, int rows, bool applyMorphology) const {
+        if (sceneBgr.empty()) {
+            throw std::invalid_argument("MeasureCoverage received empty scene image.");
+        }
+        if (cols < 1 || rows < 1 || cols > sceneBgr.cols || rows > sceneBgr.rows) {
+            throw std::invalid_argument("Coverage grid must have 1..width columns and 1..height rows.");
+        }
+
+        CoverageGrid grid;
+        grid.cols = cols;
+        grid.rows = rows;
+        detail::StageClock clock(grid.timings);
+
+        ClassLut lut;
+        lut.Add(ClassLut::kCenter, config_.centerColor.hues,
+            config_.centerColor.satRange.minValue, config_.centerColor.satRange.maxValue,
+            config_.centerColor.valRange.minValue, config_.centerColor.valRange.maxValue);
+        const ColorMaskConfig& support = config_.context.supportColor;
+        lut.Add(ClassLut::kSupport, support.hues,
+            support.satRange.minValue, support.satRange.maxValue,
+            support.valRange.minValue, support.valRange.maxValue);
+        if (!config_.context.excludeHues.Empty()) {
+            lut.Add(ClassLut::kExclude, config_.context.excludeHues,
+                config_.context.excludeSatRange.minValue, config_.context.excludeSatRange.maxValue,
+                config_.context.excludeValRange.minValue, config_.context.excludeValRange.maxValue);
+        }
+
+        std::vector<uint64_t> counts;
+        if (applyMorphology && plan_.morphology) {
+            cv::cvtColor(sceneBgr.channels() == 1 ? detail::EnsureColorInto(sceneBgr, ws.sceneBgr) : sceneBgr, ws.hsv, cv::COLOR_BGR2HSV);
+            clock.Mark(PipelineStage::Convert);
+            ws.centerMask.create(ws.hsv.size(), CV_8U);
+            detail::ClassifyWithLut(ws.hsv, lut, &ws.centerMask, nullptr, nullptr);
+            clock.Mark(PipelineStage::ClassifyCenter);
+            detail::ApplyMorphology(ws.centerMask, config_.centerMorph);
+            clock.Mark(PipelineStage::Morphology);
+            detail::AccumulateCoverage(ws.hsv, &ws.hsv, &ws.centerMask, lut, cols, rows, counts);
+            clock.Mark(PipelineStage::ClassifyContext);
+        } else {
+            detail::AccumulateCoverage(sceneBgr.channels() == 1 ? detail::EnsureColorInto(sceneBgr, ws.sceneBgr) : sceneBgr,
+                nullptr, nullptr, lut, cols, rows, counts);
+            clock.Mark(PipelineStage::ClassifyCenter);
+        }
+
+        const int width = sceneBgr.cols;
+        const int height = sceneBgr.rows;
+        grid.cells.resize(static_cast<size_t>(cols) * static_cast<size_t>(rows));
+        for (int r = 0; r < rows; ++r) {
+            const int64_t cellH = static_cast<int64_t>(r + 1) * height / rows - static_cast<int64_t>(r) * height / rows;
+            for (int c = 0; c < cols; ++c) {
+                const int64_t cellW = static_cast<int64_t>(c + 1) * width / cols - static_cast<int64_t>(c) * width / cols;
+                const size_t i = static_cast<size_t>(r) * cols + c;
+                const float px = static_cast<float>(cellW * cellH);
+                grid.cells[i].center = detail::SafeDiv(static_cast<float>(counts[i * 3]), px);
+                grid.cells[i].support = detail::SafeDiv(static_cast<float>(counts[i * 3 + 1]), px);
+                grid.cells[i].exclude = detail::SafeDiv(static_cast<float>(counts[i * 3 + 2]), px);
+            }
+        }
+        clock.Finish();
+        return grid;
+    }
+
+    static bool ValidateConfig(const ColorPatternConfig& cfg, std::string* errorOut = nullptr) {
+        auto setError = [&](const std::string& msg) {
+            if (errorOut != nullptr) {
+                *errorOut = msg;
+            }
+            return false;
+        };
+        auto validateRange = [&](const ChannelRange& range, const std::string& name) {
+            if (range.minValue < 0 || range.minValue > 255 || range.maxValue < 0 || range.maxValue > 255) {
+                return setError(name + " must be within [0,255].");
+            }
+            if (range.minValue > range.maxValue) {
+                return setError(name + " must satisfy minValue <= maxValue.");
+            }
+            return true;
+        };
+
+        if (cfg.centerColor.hues.Empty()) {
+            return setError("centerColor.hues is empty.");
+        }
+        if (!validateRange(cfg.centerColor.satRange, "centerColor.satRange")) {
+            return false;
+        }
+        if (!validateRange(cfg.centerColor.valRange, "centerColor.valRange")) {
+            return false;
+        }
+        if (cfg.shape.minArea < 1) {
+            return setError("shape.minArea must be >= 1.");
+        }
+        if (cfg.shape.maxArea < cfg.shape.minArea) {
+            return setError("shape.maxArea must be >= shape.minArea.");
+        }
+        if (cfg.shape.minCircularity < 0.0F || cfg.shape.minCircularity > 1.0F) {
+            return setError("shape.minCircularity must be in [0,1].");
+        }
+        if (cfg.shape.minFillRatio < 0.0F || cfg.shape.minFillRatio > 1.0F) {
+            return setError("shape.minFillRatio must be in [0,1].");
+        }
+        if (cfg.context.enabled) {
+            if (cfg.context.innerRadiusPercent < 1 || cfg.context.outerRadiusPercent <= cfg.context.innerRadiusPercent) {
+                return setError("context ring radius percents must satisfy: 1 <= inner < outer.");
+            }
+            if (cfg.context.minSupportRatio < 0.0F || cfg.context.minSupportRatio > 1.0F) {
+                return setError("context.minSupportRatio must be in [0,1].");
+            }
+            if (!validateRange(cfg.context.supportColor.satRange, "context.supportColor.satRange")) {
+                return false;
+            }
+            if (!validateRange(cfg.context.supportColor.valRange, "context.supportColor.valRange")) {
+                return false;
+            }
+            if (!validateRange(cfg.context.excludeSatRange, "context.excludeSatRange")) {
+                return false;
+            }
+            if (!validateRange(cfg.context.excludeValRange, "context.excludeValRange")) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    ColorPatternRunResult LoadAndFind(const std::string& scenePath) const {
+        const cv::Mat scene = cv::imread(scenePath, cv::IMREAD_COLOR);
+        if (scene.empty()) {
+            throw std::runtime_error("Failed to load scene image: " + scenePath);
+        }
+        return Find(scene);
+    }
+
+    ColorPatternRunResult Find(const cv::Mat& sceneBgr) const {
+        DetectionWorkspace workspace;
+        return Find(sceneBgr, workspace);
+    }
+
+    // Workspace-backed variant: intermediate buffers come from `ws` and are kept
+    // for the next call. Output images in the result never alias the workspace.
+    ColorPatternRunResult Find(const cv::Mat& sceneBgr, DetectionWorkspace& ws) const {
+        if (sceneBgr.empty()) {
+            throw std::invalid_argument("Find received empty scene image.");
+        }
+
+        ColorPatternRunResult result;
+        detail::StageClock clock(result.timings);
+
+        const cv::Mat& scene = detail::EnsureColorInto(sceneBgr, ws.sceneBgr);
+        cv::cvtColor(scene, ws.hsv, cv::COLOR_BGR2HSV);
+        clock.Mark(PipelineStage::Convert);
+
+        DetectFromHsv(ws, result, clock);
+        if (plan_.renderDebug) {
+            RenderDebug(scene, ws.centerMask, result);
+        }
+        clock.Mark(PipelineStage::DebugRender);
+        clock.Finish();
+        return result;
+    }
+
+    // HDR variant: classifies straight from a high-precision frame (see HdrFormat).
+    // HSV is computed from the source values and quantized once, so the range rules
+    // apply to the full input precision and no 8-bit BGR copy of the frame is made.
+    // Debug panels show the frame reconstructed from HSV.
+    ColorPatternRunResult FindHdr(const cv::Mat& source, HdrFormat format, DetectionWorkspace& ws) const {
+        if (source.empty()) {
+            throw std::invalid_argument("FindHdr received empty scene image.");
+        }
+
+        ColorPatternRunResult result;
+        detail::StageClock clock(result.timings);
+
+        detail::ConvertHdrToHsv(source, format, ws.hsv);
+        clock.Mark(PipelineStage::Convert);
+
+        DetectFromHsv(ws, result, clock);
+        if (plan_.renderDebug) {
+            cv::cvtColor(ws.hsv, ws.sceneBgr, cv::COLOR_HSV2BGR);
+            RenderDebug(ws.sceneBgr, ws.centerMask, result);
+        }
+        clock.Mark(PipelineStage::DebugRender);
+        clock.Finish();
+        return result;
+    }
+
+    static constexpr int kNearestTileSize = 64;   // half-size of the first window
+
+    // Accepted target nearest to `focus` (ties: smaller y, then smaller x). Square windows
+    // centred on the focus are detected with growing half-size, starting at
+    // kNearestTileSize and at least doubling, until no target outside the window can be
+    // closer than the best one inside. Each window is padded by NearestHalo() and only
+    // targets centred in the unpadded window count, so every verdict equals a full-frame
+    // Find. Configs whose shape limits do not bound an accepted blob's size run one
+    // full-frame pass.
+    NearestTargetResult FindNearest(const cv::Mat& sceneBgr, const cv::Point& focus, DetectionWorkspace& ws) const {
+        if (sceneBgr.empty()) {
+            throw std::invalid_argument("FindNearest received empty scene image.");
+        }
+        const cv::Rect frame(0, 0, sceneBgr.cols, sceneBgr.rows);
+        if (!frame.contains(focus)) {
+            throw std::invalid_argument("FindNearest focus is outside the frame.");
+        }
+
+        NearestTargetResult nearest;
+        int64_t bestDistSq = std::numeric_limits<int64_t>::max();
+        int64_t processedPx = 0;
+        const int halo = NearestHalo();
+        int half = (halo < 0) ? std::max(frame.width, frame.height) : kNearestTileSize;
+        for (;;) {
+            const cv::Rect window = cv::Rect(focus.x - half, focus.y - half, 2 * half + 1, 2 * half + 1) & frame;
+            const int pad = std::max(halo, 0);
+            const cv::Rect padded = cv::Rect(window.x - pad, window.y - pad, window.width + 2 * pad, window.height + 2 * pad) & frame;
+            ColorPatternRunResult run = Find(sceneBgr(padded), ws);
+            nearest.rounds += 1;
+            processedPx += static_cast<int64_t>(padded.area());
+            for (int s = 0; s < kPipelineStageCount; ++s) {
+                nearest.timings.ms[static_cast<size_t>(s)] += run.timings.ms[static_cast<size_t>(s)];
+            }
+
+            for (ColorPatternDetection& det : run.detections) {
+                const cv::Point center = det.centerPx + padded.tl();
+                if (!det.metrics.accepted || !window.contains(center)) {
+                    continue;
+                }
+                const int64_t dx = center.x - focus.x;
+                const int64_t dy = center.y - focus.y;
+                const int64_t distSq = dx * dx + dy * dy;
+                const bool closer = distSq < bestDistSq
+                    || (distSq == bestDistSq && (center.y < nearest.detection.centerPx.y
+                        || (center.y == nearest.detection.centerPx.y && center.x < nearest.detection.centerPx.x)));
+                if (!closer) {
+                    continue;
+                }
+                bestDistSq = distSq;
+                nearest.found = true;
+                nearest.detection = std::move(det);
+                nearest.detection.centerPx = center;
+                nearest.detection.boxPx.x += padded.x;
+                nearest.detection.boxPx.y += padded.y;
+                for (cv::Point& p : nearest.detection.contour) {
+                    p += padded.tl();
+                }
+                if (nearest.detection.colorStats.pixelCount > 0) {
+                    nearest.detection.colorStats.brightestPx += padded.tl();
+                }
+            }
+
+            // A target outside the window is more than `half` away on an unclipped side,
+            // and clipped sides end at the frame border.
+            const bool covered = (window == frame);
+            if (covered || (nearest.found && bestDistSq <= static_cast<int64_t>(half) * half)) {
+                break;
+            }
+            const int bestDist = nearest.found ? static_cast<int>(std::ceil(std::sqrt(static_cast<double>(bestDistSq)))) : 0;
+            half = std::max(half * 2, bestDist);
+        }
+
+        nearest.distancePx = nearest.found ? static_cast<float>(std::sqrt(static_cast<double>(bestDistSq))) : 0.0F;
+        nearest.processedFraction = detail::SafeDiv(static_cast<float>(processedPx), static_cast<float>(frame.area()));
+        return nearest;
+    }
+
+    // Padding that keeps verdicts exact for targets centred in a window: the largest
+    // accepted blob (radius bounded by maxArea with minFillRatio or minCircularity) plus
+    // the morphology reach, or its context ring, whichever extends further. -1 when the
+    // shape limits do not bound an accepted blob.
+    int NearestHalo() const {
+        const ShapeFilterConfig& shape = config_.shape;
+        const double maxArea = static_cast<double>(std::max(shape.maxArea, 1));
+        double maxRadius = -1.0;
+        if (shape.minFillRatio > 0.0F) {
+            maxRadius = std::sqrt(maxArea / (CV_PI * static_cast<double>(shape.minFillRatio)));
+        }
+        if (shape.minCircularity > 0.0F) {
+            // circularity = 4*pi*A/P^2 bounds the perimeter; a closed curve fits in a
+            // circle of radius P/2.
+            const double perimeter = std::sqrt(4.0 * CV_PI * maxArea / static_cast<double>(shape.minCircularity));
+            maxRadius = (maxRadius < 0.0) ? perimeter / 2.0 : std::min(maxRadius, perimeter / 2.0);
+        }
+        if (maxRadius < 0.0) {
+            return -1;
+        }
+
+        const MorphologyConfig& morph = config_.centerMorph;
+        const int morphReach = 2 * (std::max(morph.openIterations, 0) + std::max(morph.closeIterations, 0)) + std::max(morph.dilateIterations, 0);
+        const int blobReach = static_cast<int>(std::ceil(maxRadius)) + 2;
+        int ringReach = 0;
+        if (config_.context.enabled) {
+            const float radius = static_cast<float>(maxRadius);
+            const int inner = std::max(1, static_cast<int>(std::lround(radius * (static_cast<float>(config_.context.innerRadiusPercent) / 100.0F))));
+            ringReach = std::max(inner + 1, static_cast<int>(std::lround(radius * (static_cast<float>(config_.context.outerRadiusPercent) / 100.0F)))) + 2;
+        }
+        return std::max(blobReach + morphReach + 1, ringReach);
+    }
+
+private:
+    // Every stage after the HSV conversion, up to (not including) debug rendering.
+    void DetectFromHsv(DetectionWorkspace& ws, ColorPatternRunResult& result, detail::StageClock& clock) const {
+        const cv::Mat& hsv = ws.hsv;
+        cv::Mat& centerMask = ws.centerMask;
+        BeginContextFrame(ws);
+        if (ws.tileDedup.BeginFrame()) {
+            centerMask.create(hsv.size(), CV_8U);
+            result.tileDedup = detail::ClassifyTilesDeduped(
+                hsv,
+                plan_.lut,
+                centerMask,
+                plan_.fusedDenseClassify && plan_.classifySupport ? &ws.supportMask : nullptr,
+                plan_.fusedDenseClassify && plan_.classifyExclude ? &ws.excludeMask : nullptr,
+                ws.tileDedup);
+        } else if (plan_.centerClassifier == ClassifierKernel::Lut) {
+            centerMask.create(hsv.size(), CV_8U);
+            detail::ClassifyWithLut(
+                hsv,
+                plan_.lut,
+                &centerMask,
+                plan_.fusedDenseClassify && plan_.classifySupport ? &ws.supportMask : nullptr,
+                plan_.fusedDenseClassify && plan_.classifyExclude ? &ws.excludeMask : nullptr);
+        } else {
+            detail::BuildMaskInto(hsv, config_.centerColor, centerMask, ws);
+        }
+        clock.Mark(PipelineStage::ClassifyCenter);
+        if (plan_.morphology) {
+            detail::ApplyMorphology(centerMask, config_.centerMorph);
+        }
+        clock.Mark(PipelineStage::Morphology);
+
+        // Lazy context masks are classified on demand while scoring rings (see
+        // EnsureContextRegion), so only pixels near surviving candidates are touched.
+        if (plan_.contextMasks == ContextMaskKernel::Dense && !plan_.fusedDenseClassify) {
+            ClassifyContextRect(cv::Rect(0, 0, hsv.cols, hsv.rows), ws);
+        }
+        clock.Mark(PipelineStage::ClassifyContext);
+
+        std::vector<std::vector<cv::Point>>& contours = ws.contours;
+        contours.clear();
+        centerMask.copyTo(ws.contourInput);
+        cv::findContours(ws.contourInput, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+
+        result.rawCandidateCount = static_cast<int>(contours.size());
+        result.sceneMaskCoverage = detail::SafeDiv(
+            static_cast<float>(cv::countNonZero(centerMask)),
+            static_cast<float>(centerMask.rows * centerMask.cols));
+        clock.Mark(PipelineStage::Contours);
+
+        const bool shortCircuit = ws.cascade.ShortCircuitThisFrame() && !config_.debug.drawRejected;
+        result.detections.reserve(contours.size());
+        for (std::vector<cv::Point>& contour : contours) {
+            const float area = static_cast<float>(cv::contourArea(contour));
+            if (area <= 0.0F) {
+                continue;
+            }
+
+            ColorPatternDetection det;
+            det.contour = std::move(contour);
+            det.boxPx = cv::boundingRect(det.contour);
+            det.metrics.areaPx = area;
+            result.detections.push_back(std::move(det));
+        }
+        EvaluateCandidates(result.detections, ws, shortCircuit, cv::Rect(0, 0, hsv.cols, hsv.rows));
+        ws.cascade.candidates += static_cast<uint64_t>(result.detections.size());
+        ws.cascade.EndFrame();
+        ws.verdictCache.EndFrame();
+        result.contextMaskCoverage = detail::SafeDiv(
+            static_cast<float>(ws.contextClassifiedPx),
+            static_cast<float>(hsv.rows * hsv.cols));
+
+        detail::RankDetections(result);
+        clock.Mark(PipelineStage::Candidates);
+
+        // Context classification ran inside the candidate loop; report it under its own
+        // stage. With parallel workers the sum is CPU time, so cap it at the stage time.
+        const double contextMs = std::min(detail::TicksToMs(ws.contextClassifyTicks), result.timings[PipelineStage::Candidates]);
+        result.timings[PipelineStage::Candidates] -= contextMs;
+        result.timings[PipelineStage::ClassifyContext] += contextMs;
+    }
+
+    void RenderDebug(const cv::Mat& scene, const cv::Mat& centerMask, ColorPatternRunResult& result) const {
+        // Render at the output scale: downscale the panel sources, then draw at scaled
+        // coordinates, so cost and size follow the requested output.
+        const DebugRenderOptions& output = plan_.debugOutput;
+        const bool wantOverlay = output.panels != DebugPanels::Mask;
+        const bool wantMask = output.panels != DebugPanels::Overlay;
+        const int panelCount = (wantOverlay ? 1 : 0) + (wantMask ? 1 : 0);
+        double scale = 1.0;
+        if (output.maxSize.width > 0) {
+            scale = std::min(scale, static_cast<double>(output.maxSize.width) / static_cast<double>(scene.cols * panelCount));
+        }
+        if (output.maxSize.height > 0) {
+            scale = std::min(scale, static_cast<double>(output.maxSize.height) / static_cast<double>(scene.rows));
+        }
+        const cv::Size panelSize(
+            std::max(1, static_cast<int>(std::floor(scene.cols * scale))),
+            std::max(1, static_cast<int>(std::floor(scene.rows * scale))));
+        const bool scaled = panelSize != scene.size();
+        const float sx = static_cast<float>(panelSize.width) / static_cast<float>(scene.cols);
+        const float sy = static_cast<float>(panelSize.height) / static_cast<float>(scene.rows);
+
+        cv::Mat overlay;
+        cv::Mat maskDebug;
+        if (wantOverlay) {
+            if (scaled) {
+                cv::resize(scene, overlay, panelSize, 0.0, 0.0, cv::INTER_AREA);
+            } else {
+                overlay = scene.clone();
+            }
+        }
+        if (wantMask) {
+            if (scaled) {
+                cv::Mat smallMask;
+                cv::resize(centerMask, smallMask, panelSize, 0.0, 0.0, cv::INTER_AREA);
+                cv::cvtColor(smallMask, maskDebug, cv::COLOR_GRAY2BGR);
+            } else {
+                cv::cvtColor(centerMask, maskDebug, cv::COLOR_GRAY2BGR);
+            }
+        }
+
+        const std::shared_ptr<const detail::GlyphAtlas> atlas = detail::GlyphAtlas::Get(config_.debug.fontScale, config_.debug.lineThickness);
+        cv::Mat labelAlpha;
+        for (const ColorPatternDetection& det : result.detections) {
             if (det.metrics.accepted || config_.debug.drawRejected) {
                 const cv::Scalar stroke = det.metrics.accepted ? config_.debug.acceptedColor : config_.debug.rejectedColor;
-                cv::rectangle(overlay, det.boxPx, stroke, 2, cv::LINE_AA);
-                cv::circle(overlay, det.centerPx, std::max(2, static_cast<int>(std::lround(det.radiusPx))), stroke, 1, cv::LINE_AA);
-
-                cv::rectangle(maskDebug, det.boxPx, stroke, 2, cv::LINE_AA);
-                cv::circle(maskDebug, det.centerPx, std::max(2, static_cast<int>(std::lround(det.radiusPx))), stroke, 1, cv::LINE_AA);
+                const cv::Rect box(
+                    static_cast<int>(std::lround(det.boxPx.x * sx)),
+                    static_cast<int>(std::lround(det.boxPx.y * sy)),
+                    std::max(1, static_cast<int>(std::lround(det.boxPx.width * sx))),
+                    std::max(1, static_cast<int>(std::lround(det.boxPx.height * sy))));
+                const cv::Point center(
+                    static_cast<int>(std::lround(det.centerPx.x * sx)),
+                    static_cast<int>(std::lround(det.centerPx.y * sy)));
+                const int radius = std::max(2, static_cast<int>(std::lround(det.radiusPx * 0.5F * (sx + sy))));
+                for (cv::Mat* panel : { &overlay, &maskDebug }) {
+                    if (!panel->empty()) {
+                        cv::rectangle(*panel, box, stroke, 2, cv::LINE_AA);
+                        cv::circle(*panel, center, radius, stroke, 1, cv::LINE_AA);
+                    }
+                }
 
-                const std::string label = detail::BuildMetricLabel(det.metrics);
-                const cv::Point labelPoint(det.boxPx.x, std::max(12, det.boxPx.y - 4));
-                detail::DrawLabel(overlay, label, labelPoint, config_.debug);
-                detail::DrawLabel(maskDebug, label, labelPoint, config_.debug);
+                const cv::Point labelPoint(box.x, std::max(12, box.y - 4));
+                detail::DrawMetricLabel({ &overlay, &maskDebug }, det.metrics, labelPoint, config_.debug, *atlas, labelAlpha);
             }
         }
 
-        result.acceptedRatio = detail::SafeDiv(static_cast<float>(result.acceptedCount), static_cast<float>(std::max(1, result.rawCandidateCount)));
         result.debugOverlay = overlay;
         result.debugMask = maskDebug;
-        result.sideBySideDebug = detail::BuildSideBySide(result.debugOverlay, result.debugMask);
+        if (wantOverlay && wantMask) {
+            cv::hconcat(overlay, maskDebug, result.sideBySideDebug);
+        } else {
+            result.sideBySideDebug = wantOverlay ? overlay : maskDebug;
+        }
+    }
+
+    static constexpr int kParallelCandidateMin = 64;  // fewer candidates are evaluated serially
+    static constexpr int kCandidatesPerChunk = 16;
+
+    // Evaluates `detections` in place. Large candidate sets are split into contiguous
+    // chunks run on OpenCV's worker pool, each with its own CandidateScratch. Every
+    // detection is written to its own slot and counters are merged in chunk order,
+    // so results are identical for any thread count. Context rings are clipped to `bounds`.
+    // With the workspace verdict cache enabled, workers only read the cache; new
+    // verdicts are stored after the parallel pass.
+    void EvaluateCandidates(std::vector<ColorPatternDetection>& detections, DetectionWorkspace& ws, bool shortCircuit, const cv::Rect& bounds) const {
+        const int count = static_cast<int>(detections.size());
+        VerdictCache& cache = ws.verdictCache;
+        if (cache.enabled) {
+            cache.signatures.assign(static_cast<size_t>(count), 0);
+            cache.hit.assign(static_cast<size_t>(count), 0);
+        }
+        const int threads = std::max(1, cv::getNumThreads());
+        int chunks = 1;
+        if (count >= kParallelCandidateMin && threads > 1) {
+            chunks = std::min(threads * 4, (count + kCandidatesPerChunk - 1) / kCandidatesPerChunk);
+        }
+
+        ws.EnsureCandidateScratch(static_cast<size_t>(chunks));
+        for (int c = 0; c < chunks; ++c) {
+            CandidateScratch& scratch = ws.candidateScratch[static_cast<size_t>(c)];
+            scratch.tally.ClearCounters();
+            scratch.contextClassifyTicks = 0;
+            scratch.contextClassifiedPx = 0;
+        }
+
+        auto evaluateChunk = [&](int chunk) {
+            CandidateScratch& scratch = ws.candidateScratch[static_cast<size_t>(chunk)];
+            const int begin = static_cast<int>((static_cast<int64_t>(count) * chunk) / chunks);
+            const int end = static_cast<int>((static_cast<int64_t>(count) * (chunk + 1)) / chunks);
+            for (int i = begin; i < end; ++i) {
+                ColorPatternDetection& det = detections[static_cast<size_t>(i)];
+                if (cache.enabled && LookupVerdict(det, ws, scratch, bounds, i)) {
+                    continue;
+                }
+                const bool timeTests = ws.cascade.adaptive && (i % CandidateCascade::kCostSampleStride) == 0;
+                EvaluateCandidate(det, ws, scratch, shortCircuit, timeTests, bounds);
+            }
+        };
+        if (chunks == 1) {
+            evaluateChunk(0);
+        } else {
+            cv::parallel_for_(cv::Range(0, chunks), [&](const cv::Range& range) {
+                for (int c = range.start; c < range.end; ++c) {
+                    evaluateChunk(c);
+                }
+            }, static_cast<double>(chunks));
+        }
+
+        for (int c = 0; c < chunks; ++c) {
+            const CandidateScratch& scratch = ws.candidateScratch[static_cast<size_t>(c)];
+            ws.cascade.Accumulate(scratch.tally);
+            ws.contextClassifyTicks += scratch.contextClassifyTicks;
+            ws.contextClassifiedPx += scratch.contextClassifiedPx;
+        }
+        if (cache.enabled) {
+            StoreVerdicts(detections, cache);
+        }
+    }
+
+    // Computes the candidate's verdict-cache signature and, on a match, copies the
+    // cached metrics and circle into `det`. Returns true when `det` is complete.
+    bool LookupVerdict(ColorPatternDetection& det, DetectionWorkspace& ws, CandidateScratch& scratch, const cv::Rect& bounds, int index) const {
+        const float area = det.metrics.areaPx;
+        if (area < static_cast<float>(config_.shape.minArea) || area > static_cast<float>(config_.shape.maxArea)) {
+            return false;
+        }
+
+        cv::Point2f centerFloat;
+        cv::minEnclosingCircle(det.contour, centerFloat, det.radiusPx);
+        det.centerPx = cv::Point(static_cast<int>(std::lround(centerFloat.x)), static_cast<int>(std::lround(centerFloat.y)));
+
+        uint32_t areaBits = 0;
+        std::memcpy(&areaBits, &area, sizeof(areaBits));
+        uint64_t signature = detail::HashCombine(plan_.verdictKey, areaBits);
+        signature = detail::HashCombine(signature, (static_cast<uint64_t>(static_cast<uint32_t>(bounds.x)) << 32) | static_cast<uint32_t>(bounds.y));
+        signature = detail::HashCombine(signature, (static_cast<uint64_t>(static_cast<uint32_t>(bounds.width)) << 32) | static_cast<uint32_t>(bounds.height));
+        signature = detail::HashCombine(signature, (static_cast<uint64_t>(static_cast<uint32_t>(det.boxPx.x)) << 32) | static_cast<uint32_t>(det.boxPx.y));
+        signature = detail::HashCombine(signature, detail::HashTile(ws.centerMask, det.boxPx));
+        if (config_.context.enabled) {
+            const cv::Rect ringBox = RingBox(det.centerPx, det.radiusPx, bounds);
+            if (!ringBox.empty()) {
+                signature = detail::HashCombine(signature, detail::HashTile(ws.hsv, ringBox));
+            }
+        }
+        signature = std::max<uint64_t>(signature, 1);  // 0 marks an uncached candidate
+        ws.verdictCache.signatures[static_cast<size_t>(index)] = signature;
+
+        const VerdictCache::Entry* entry = ws.verdictCache.Find(signature, det.boxPx);
+        if (entry == nullptr) {
+            return false;
+        }
+        det.metrics = entry->metrics;
+        det.centerPx = entry->centerPx;
+        det.radiusPx = entry->radiusPx;
+        ws.verdictCache.hit[static_cast<size_t>(index)] = 1;
+        if (det.metrics.accepted && plan_.blobStats) {
+            detail::MeasureBlobColor(ws.hsv, ws.centerMask, det.contour, det.boxPx, scratch.blobMask, det.colorStats);
+        }
+        return true;
+    }
+
+    // Serial half of the verdict cache: refreshes matched entries and stores the
+    // verdicts computed this call.
+    static void StoreVerdicts(const std::vector<ColorPatternDetection>& detections, VerdictCache& cache) {
+        for (size_t i = 0; i < detections.size(); ++i) {
+            const uint64_t signature = cache.signatures[i];
+            if (signature == 0) {
+                continue;
+            }
+            cache.lookups += 1;
+            cache.frameLookups += 1;
+            if (cache.hit[i] != 0) {
+                cache.hits += 1;
+                cache.frameHits += 1;
+                cache.entries[signature].lastFrame = cache.frames;
+                continue;
+            }
+            const auto it = cache.entries.find(signature);
+            if (it == cache.entries.end() && cache.entries.size() >= VerdictCache::kMaxEntries) {
+                continue;
+            }
+            VerdictCache::Entry& entry = (it != cache.entries.end()) ? it->second : cache.entries[signature];
+            const ColorPatternDetection& det = detections[i];
+            entry.boxPx = det.boxPx;
+            entry.centerPx = det.centerPx;
+            entry.radiusPx = det.radiusPx;
+            entry.metrics = det.metrics;
+            entry.lastFrame = cache.frames;
+            cache.inserts += 1;
+        }
+    }
+
+    // Runs the candidate tests in the workspace cascade order. With shortCircuit the
+    // first failing test ends evaluation; otherwise every metric is filled in, except
+    // that the context ring is not scored for candidates that already failed a shape
+    // test unless rejected candidates are drawn or the cascade is measuring rates.
+    // timeTests adds each test's duration to the cascade's cost samples.
+    void EvaluateCandidate(ColorPatternDetection& det, DetectionWorkspace& ws, CandidateScratch& scratch, bool shortCircuit, bool timeTests, const cv::Rect& bounds) const {
+        DetectionMetrics& m = det.metrics;
+        const std::vector<cv::Point>& contour = det.contour;
+        const bool exploring = !shortCircuit;
+        const bool tracking = ws.cascade.adaptive;
+        const bool fullMetrics = config_.debug.drawRejected || (tracking && exploring);
+
+        bool haveCircle = det.radiusPx > 0.0F;  // LookupVerdict may have fitted it already
+        auto ensureCircle = [&]() {
+            if (haveCircle) {
+                return;
+            }
+            cv::Point2f centerFloat;
+            cv::minEnclosingCircle(contour, centerFloat, det.radiusPx);
+            det.centerPx = cv::Point(static_cast<int>(std::lround(centerFloat.x)), static_cast<int>(std::lround(centerFloat.y)));
+            haveCircle = true;
+        };
+
+        bool rejected = false;
+        bool failedShape = false;
+        for (const CandidateTest test : ws.cascade.order) {
+            if (test == CandidateTest::ContextRing && failedShape && !fullMetrics && config_.context.enabled) {
+                m.passesContext = false;
+                continue;
+            }
+            const int64_t t0 = timeTests ? cv::getTickCount() : 0;
+            bool passed = true;
+            switch (test) {
+            case CandidateTest::Area:
+                m.passesArea = (m.areaPx >= static_cast<float>(config_.shape.minArea) && m.areaPx <= static_cast<float>(config_.shape.maxArea));
+                passed = m.passesArea;
+                break;
+            case CandidateTest::Circularity:
+                m.circularity = detail::Clamp01(detail::ComputeCircularity(contour));
+                m.passesCircularity = (m.circularity >= config_.shape.minCircularity);
+                passed = m.passesCircularity;
+                break;
+            case CandidateTest::CenterFill: {
+                ensureCircle();
+                const float circleArea = std::max(1.0F, static_cast<float>(CV_PI) * det.radiusPx * det.radiusPx);
+                m.centerFillRatio = detail::Clamp01(detail::SafeDiv(m.areaPx, circleArea));
+                m.passesCenterFill = (m.centerFillRatio >= config_.shape.minFillRatio);
+                passed = m.passesCenterFill;
+                break;
+            }
+            case CandidateTest::ContextRing:
+                if (config_.context.enabled) {
+                    ensureCircle();
+                    m.ringSupportRatio = ScoreContextRing(det.centerPx, det.radiusPx, bounds, ws, scratch);
+                    m.passesContext = (m.ringSupportRatio >= config_.context.minSupportRatio);
+                } else {
+                    m.ringSupportRatio = 1.0F;
+                    m.passesContext = true;
+                }
+                passed = m.passesContext;
+                break;
+            }
+            if (tracking) {
+                scratch.tally.Record(test, passed, exploring);
+            }
+            if (timeTests) {
+                scratch.tally.RecordCost(test, cv::getTickCount() - t0);
+            }
+            failedShape = failedShape || (!passed && test != CandidateTest::ContextRing);
+            if (!passed && shortCircuit) {
+                rejected = true;
+                break;
+            }
+        }
+
+        if (!haveCircle) {
+            if (rejected) {
+                // Short-circuited before the circle was needed; fall back to the box.
+                det.centerPx = cv::Point(det.boxPx.x + det.boxPx.width / 2, det.boxPx.y + det.boxPx.height / 2);
+            } else {
+                ensureCircle();
+            }
+        }
+
+        const float shapeScore = (m.circularity * 0.55F) + (m.centerFillRatio * 0.45F);
+        if (config_.context.enabled) {
+            m.score = detail::Clamp01((shapeScore * 0.60F) + (m.ringSupportRatio * 0.40F));
+        } else {
+            m.score = detail::Clamp01(shapeScore);
+        }
+
+        m.accepted = !rejected && (m.passesArea && m.passesCircularity && m.passesCenterFill && m.passesContext);
+        if (m.accepted && plan_.blobStats) {
+            detail::MeasureBlobColor(ws.hsv, ws.centerMask, det.contour, det.boxPx, scratch.blobMask, det.colorStats);
+        }
+    }
+
+    // Sizes the frame-sized context buffers the plan needs and marks every context
+    // tile as unclassified. With dense context masks the tiles only track coverage.
+    void BeginContextFrame(DetectionWorkspace& ws) const {
+        ws.contextClassifyTicks = 0;
+        ws.contextClassifiedPx = 0;
+        if (plan_.contextMasks == ContextMaskKernel::Disabled) {
+            ws.supportMask.release();
+            ws.excludeMask.release();
+            ws.contextTiles.clear();
+            return;
+        }
+
+        const cv::Size size = ws.hsv.size();
+        if (plan_.classifySupport) {
+            ws.supportMask.create(size, CV_8U);
+        } else {
+            ws.supportMask.release();
+        }
+        if (plan_.classifyExclude) {
+            ws.excludeMask.create(size, CV_8U);
+        } else {
+            ws.excludeMask.release();
+        }
+        ws.maskScratchA.create(size, CV_8U);
+        ws.maskScratchB.create(size, CV_8U);
+
+        const int tile = DetectionWorkspace::kContextTileSize;
+        ws.contextTileCols = (size.width + tile - 1) / tile;
+        const int tileRows = (size.height + tile - 1) / tile;
+        const size_t tileCount = static_cast<size_t>(ws.contextTileCols) * static_cast<size_t>(tileRows);
+        if (ws.contextTiles.size() != tileCount) {
+            ws.contextTiles = std::vector<std::atomic<uint8_t>>(tileCount);
+        }
+        for (std::atomic<uint8_t>& state : ws.contextTiles) {
+            state.store(DetectionWorkspace::kTilePending, std::memory_order_relaxed);
+        }
+    }
+
+    // Classifies support/exclude pixels for every not-yet-classified tile that
+    // intersects `region`. Runs of adjacent tiles in a tile row are classified in one
+    // call; tiles shared by overlapping rings are classified once per frame. Tiles are
+    // claimed with a compare-exchange, and tiles claimed by another worker are waited
+    // for (that worker is classifying them and never waits while holding a claim).
+    void EnsureContextRegion(const cv::Rect& region, DetectionWorkspace& ws, CandidateScratch& scratch) const {
+        const int64_t t0 = cv::getTickCount();
+        const int tile = DetectionWorkspace::kContextTileSize;
+        const cv::Rect frame(0, 0, ws.hsv.cols, ws.hsv.rows);
+        const int tx0 = region.x / tile;
+        const int tx1 = (region.x + region.width - 1) / tile;
+        const int ty0 = region.y / tile;
+        const int ty1 = (region.y + region.height - 1) / tile;
+
+        auto tileState = [&](int tx, int ty) -> std::atomic<uint8_t>& {
+            return ws.contextTiles[static_cast<size_t>(ty) * static_cast<size_t>(ws.contextTileCols) + static_cast<size_t>(tx)];
+        };
+        auto claim = [&](int tx, int ty) {
+            uint8_t expected = DetectionWorkspace::kTilePending;
+            return tileState(tx, ty).compare_exchange_strong(
+                expected, DetectionWorkspace::kTileClaimed, std::memory_order_acquire, std::memory_order_acquire);
+        };
+
+        bool mustWait = false;
+        for (int ty = ty0; ty <= ty1; ++ty) {
+            int tx = tx0;
+            while (tx <= tx1) {
+                const int runStart = tx;
+                while (tx <= tx1 && claim(tx, ty)) {
+                    ++tx;
+                }
+                if (tx == runStart) {
+                    mustWait = mustWait || tileState(tx, ty).load(std::memory_order_acquire) != DetectionWorkspace::kTileReady;
+                    ++tx;
+                    continue;
+                }
+                const cv::Rect run = cv::Rect(runStart * tile, ty * tile, (tx - runStart) * tile, tile) & frame;
+                if (plan_.contextMasks == ContextMaskKernel::LazyTiles) {
+                    ClassifyContextRect(run, ws);
+                }
+                scratch.contextClassifiedPx += static_cast<int64_t>(run.area());
+                for (int i = runStart; i < tx; ++i) {
+                    tileState(i, ty).store(DetectionWorkspace::kTileReady, std::memory_order_release);
+                }
+            }
+        }
+
+        if (mustWait) {
+            for (int ty = ty0; ty <= ty1; ++ty) {
+                for (int tx = tx0; tx <= tx1; ++tx) {
+                    while (tileState(tx, ty).load(std::memory_order_acquire) != DetectionWorkspace::kTileReady) {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+        }
+        scratch.contextClassifyTicks += cv::getTickCount() - t0;
+    }
+
+    // Writes support/exclude classification for `rect` into the frame-sized masks with
+    // the planned classifier. Masks and scratch are written through ROI headers, so
+    // nothing is reallocated.
+    void ClassifyContextRect(const cv::Rect& rect, DetectionWorkspace& ws) const {
+        const cv::Mat hsvRoi = ws.hsv(rect);
+        cv::Mat supportRoi = plan_.classifySupport ? ws.supportMask(rect) : cv::Mat();
+        cv::Mat excludeRoi = plan_.classifyExclude ? ws.excludeMask(rect) : cv::Mat();
+
+        if (plan_.contextClassifier == ClassifierKernel::Lut) {
+            detail::ClassifyWithLut(
+                hsvRoi,
+                plan_.lut,
+                nullptr,
+                plan_.classifySupport ? &supportRoi : nullptr,
+                plan_.classifyExclude ? &excludeRoi : nullptr);
+            return;
+        }
+
+        cv::Mat partA = ws.maskScratchA(rect);
+        cv::Mat partB = ws.maskScratchB(rect);
+        if (plan_.classifySupport) {
+            const ColorMaskConfig& support = config_.context.supportColor;
+            support.hues.BuildMaskInto(
+                hsvRoi,
+                support.satRange.minValue,
+                support.satRange.maxValue,
+                support.valRange.minValue,
+                support.valRange.maxValue,
+                supportRoi,
+                partA,
+                partB);
+        }
+        if (plan_.classifyExclude) {
+            config_.context.excludeHues.BuildMaskInto(
+                hsvRoi,
+                config_.context.excludeSatRange.minValue,
+                config_.context.excludeSatRange.maxValue,
+                config_.context.excludeValRange.minValue,
+                config_.context.excludeValRange.maxValue,
+                excludeRoi,
+                partA,
+                partB);
+        }
+    }
+
+    static bool CoversAllHues(const HueRangeSet& hues) {
+        std::array<bool, 180> covered{};
+        for (const HueRange& r : hues.Ranges()) {
+            for (int h = 0; h < 180; ++h) {
+                const bool inRange = (r.minHue <= r.maxHue) ? (h >= r.minHue && h <= r.maxHue) : (h <= r.maxHue || h >= r.minHue);
+                covered[static_cast<size_t>(h)] = covered[static_cast<size_t>(h)] || inRange;
+            }
+        }
+        return std::all_of(covered.begin(), covered.end(), [](bool c) { return c; });
+    }
+
+    // Ring support ratio, computed on the ring's bounding box only. Circles are drawn
+    // relative to the box origin, which rasterizes the same pixels as drawing them on
+    // the full frame, so the ratio matches a full-frame evaluation exactly. Ring pixels
+    // outside `bounds` (the frame, or a region) are ignored.
+    float ScoreContextRing(const cv::Point& center, float radius, const cv::Rect& bounds, DetectionWorkspace& ws, CandidateScratch& scratch) const {
+        const auto [inner, outer] = RingRadii(radius);
+        const cv::Rect box = RingBox(center, radius, bounds);
+        if (box.empty()) {
+            return 0.0F;
+        }
+        if (plan_.contextMasks != ContextMaskKernel::Disabled) {
+            EnsureContextRegion(box, ws, scratch);
+        }
+
+        const cv::Point local = center - box.tl();
+        cv::Mat ringMask = detail::GrowView(scratch.ringMask, box.size(), CV_8U);
+        ringMask.setTo(cv::Scalar(0));
+        cv::circle(ringMask, local, outer, cv::Scalar(255), cv::FILLED);
+        cv::circle(ringMask, local, inner, cv::Scalar(0), cv::FILLED);
+
+        cv::Mat validRingMask = detail::GrowView(scratch.validRingMask, box.size(), CV_8U);
+        cv::Mat inRing = detail::GrowView(scratch.ringScratch, box.size(), CV_8U);
+        ringMask.copyTo(validRingMask);
+        if (plan_.classifyExclude) {
+            cv::bitwise_and(ringMask, ws.excludeMask(box), inRing);
+            cv::bitwise_xor(validRingMask, inRing, validRingMask);
+        }
+
+        const float validPx = static_cast<float>(cv::countNonZero(validRingMask));
+        if (!plan_.classifySupport) {
+            // Every valid ring pixel supports (RingKernel::ExcludeOnly / GeometryOnly).
+            return validPx > 0.0F ? 1.0F : 0.0F;
+        }
+        cv::bitwise_and(ws.supportMask(box), validRingMask, inRing);
+        const float supportPx = static_cast<float>(cv::countNonZero(inRing));
+        return detail::Clamp01(detail::SafeDiv(supportPx, validPx));
+    }
+
+    std::pair<int, int> RingRadii(float radius) const {
+        const int inner = std::max(1, static_cast<int>(std::lround(radius * (static_cast<float>(config_.context.innerRadiusPercent) / 100.0F))));
+        const int outer = std::max(inner + 1, static_cast<int>(std::lround(radius * (static_cast<float>(config_.context.outerRadiusPercent) / 100.0F))));
+        return { inner, outer };
+    }
+
+    cv::Rect RingBox(const cv::Point& center, float radius, const cv::Rect& bounds) const {
+        const int outer = RingRadii(radius).second;
+        return cv::Rect(center.x - outer, center.y - outer, 2 * outer + 1, 2 * outer + 1) & bounds;
+    }
+
+    friend class RegionPatternFinder;
+
+    ColorPatternConfig config_;
+    PipelinePlan plan_;
+};
+
+// One rectangle of a region map and the config its pixels are detected with.
+struct PatternRegion {
+    cv::Rect rectPx;
+    ColorPatternConfig config;
+};
+
+// Detects with a different config per frame region in a single pass. Each pixel
+// inside a region is converted and classified once, with that region's center,
+// support and exclude rules; center masks are cleaned with the region's morphology,
+// and candidates are extracted and evaluated with the region's shape and context
+// thresholds. Detections are in frame coordinates and carry their region index.
+//
+// Regions must not overlap. A region's detections equal those of cropping the region
+// and running its config alone: contours, morphology and context rings stop at the
+// region border. Regions are clipped to the frame, pixels outside every region are
+// not processed, and no debug panels are rendered.
+class RegionPatternFinder {
+public:
+    explicit RegionPatternFinder(std::vector<PatternRegion> regions) {
+        if (regions.empty()) {
+            throw std::invalid_argument("Region map has no regions.");
+        }
+
+        // Context masks are classified up front together with the center mask.
+        PlanHints hints;
+        hints.renderDebug = false;
+        hints.expectedRingCoverage = 1.0F;
+
+        finders_.reserve(regions.size());
+        for (size_t i = 0; i < regions.size(); ++i) {
+            const cv::Rect& rect = regions[i].rectPx;
+            const std::string name = "region " + std::to_string(i);
+            if (rect.x < 0 || rect.y < 0 || rect.width <= 0 || rect.height <= 0) {
+                throw std::invalid_argument(name + " must have x, y >= 0 and a positive size.");
+            }
+            for (size_t j = 0; j < i; ++j) {
+                if ((rects_[j] & rect).area() > 0) {
+                    throw std::invalid_argument(name + " overlaps region " + std::to_string(j) + ".");
+                }
+            }
+            std::string error;
+            if (!ColorPatternFinder::ValidateConfig(regions[i].config, &error)) {
+                throw std::invalid_argument(name + ": " + error);
+            }
+
+            rects_.push_back(rect);
+            finders_.emplace_back(std::move(regions[i].config), hints);
+            luts_.push_back(BuildRegionLut(finders_.back()));
+        }
+    }
+
+    size_t RegionCount() const {
+        return finders_.size();
+    }
+
+    const cv::Rect& RegionRect(size_t index) const {
+        return rects_[index];
+    }
+
+    const ColorPatternFinder& RegionFinder(size_t index) const {
+        return finders_[index];
+    }
+
+    ColorPatternRunResult Find(const cv::Mat& sceneBgr) const {
+        DetectionWorkspace workspace;
+        return Find(sceneBgr, workspace);
+    }
+
+    // Same workspace contract as ColorPatternFinder::Find. Timings use the same
+    // stages; the fused classification pass is charged to ClassifyCenter.
+    ColorPatternRunResult Find(const cv::Mat& sceneBgr, DetectionWorkspace& ws) const {
+        if (sceneBgr.empty()) {
+            throw std::invalid_argument("Find received empty scene image.");
+        }
+
+        ColorPatternRunResult result;
+        detail::StageClock clock(result.timings);
+
+        const cv::Mat& scene = detail::EnsureColorInto(sceneBgr, ws.sceneBgr);
+        const cv::Rect frame(0, 0, scene.cols, scene.rows);
+        std::vector<cv::Rect> rects(rects_.size());
+        bool needSupport = false;
+        bool needExclude = false;
+        int64_t contextPx = 0;
+        for (size_t i = 0; i < rects_.size(); ++i) {
+            rects[i] = rects_[i] & frame;
+            if (rects[i].empty()) {
+                continue;
+            }
+            const PipelinePlan& plan = finders_[i].plan_;
+            needSupport = needSupport || plan.classifySupport;
+            needExclude = needExclude || plan.classifyExclude;
+            if (plan.contextMasks != ContextMaskKernel::Disabled) {
+                contextPx += static_cast<int64_t>(rects[i].area());
+            }
+        }
+
+        ws.hsv.create(scene.size(), CV_8UC3);
+        for (const cv::Rect& rect : rects) {
+            if (!rect.empty()) {
+                cv::Mat hsvRoi = ws.hsv(rect);
+                cv::cvtColor(scene(rect), hsvRoi, cv::COLOR_BGR2HSV);
+            }
+        }
+        clock.Mark(PipelineStage::Convert);
+
+        ws.centerMask.create(scene.size(), CV_8U);
+        if (needSupport) {
+            ws.supportMask.create(scene.size(), CV_8U);
+        } else {
+            ws.supportMask.release();
+        }
+        if (needExclude) {
+            ws.excludeMask.create(scene.size(), CV_8U);
+        } else {
+            ws.excludeMask.release();
+        }
+        detail::ClassifyRectsWithLut(
+            ws.hsv,
+            rects,
+            luts_,
+            ws.centerMask,
+            needSupport ? &ws.supportMask : nullptr,
+            needExclude ? &ws.excludeMask : nullptr);
+        clock.Mark(PipelineStage::ClassifyCenter);
+
+        for (size_t i = 0; i < rects.size(); ++i) {
+            if (!rects[i].empty() && finders_[i].plan_.morphology) {
+                cv::Mat centerRoi = ws.centerMask(rects[i]);
+                detail::ApplyMorphology(centerRoi, finders_[i].config_.centerMorph, cv::BORDER_CONSTANT | cv::BORDER_ISOLATED);
+            }
+        }
+        clock.Mark(PipelineStage::Morphology);
+
+        // The context masks are already complete, so ring scoring finds every tile ready.
+        MarkContextReady(ws, scene.size());
+        clock.Mark(PipelineStage::ClassifyContext);
+
+        std::vector<std::vector<ColorPatternDetection>> regionDetections(rects.size());
+        ws.contourInput.create(scene.size(), CV_8U);
+        int64_t centerPx = 0;
+        for (size_t i = 0; i < rects.size(); ++i) {
+            if (rects[i].empty()) {
+                continue;
+            }
+            const cv::Mat centerRoi = ws.centerMask(rects[i]);
+            cv::Mat inputRoi = ws.contourInput(rects[i]);
+            centerRoi.copyTo(inputRoi);
+            centerPx += cv::countNonZero(centerRoi);
+
+            std::vector<std::vector<cv::Point>>& contours = ws.contours;
+            contours.clear();
+            cv::findContours(inputRoi, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE, rects[i].tl());
+            result.rawCandidateCount += static_cast<int>(contours.size());
+
+            std::vector<ColorPatternDetection>& dets = regionDetections[i];
+            dets.reserve(contours.size());
+            for (std::vector<cv::Point>& contour : contours) {
+                const float area = static_cast<float>(cv::contourArea(contour));
+                if (area <= 0.0F) {
+                    continue;
+                }
+                ColorPatternDetection det;
+                det.contour = std::move(contour);
+                det.boxPx = cv::boundingRect(det.contour);
+                det.metrics.areaPx = area;
+                det.region = static_cast<int>(i);
+                dets.push_back(std::move(det));
+            }
+        }
+        result.sceneMaskCoverage = detail::SafeDiv(static_cast<float>(centerPx), static_cast<float>(frame.area()));
+        clock.Mark(PipelineStage::Contours);
+
+        const bool cascadeShortCircuit = ws.cascade.ShortCircuitThisFrame();
+        result.detections.reserve(static_cast<size_t>(result.rawCandidateCount));
+        for (size_t i = 0; i < rects.size(); ++i) {
+            std::vector<ColorPatternDetection>& dets = regionDetections[i];
+            if (dets.empty()) {
+                continue;
+            }
+            const ColorPatternFinder& finder = finders_[i];
+            finder.EvaluateCandidates(dets, ws, cascadeShortCircuit && !finder.config_.debug.drawRejected, rects[i]);
+            ws.cascade.candidates += static_cast<uint64_t>(dets.size());
+            std::move(dets.begin(), dets.end(), std::back_inserter(result.detections));
+        }
+        ws.cascade.EndFrame();
+        ws.verdictCache.EndFrame();
+        result.contextMaskCoverage = detail::SafeDiv(static_cast<float>(contextPx), static_cast<float>(frame.area()));
+        detail::RankDetections(result);
+        clock.Mark(PipelineStage::Candidates);
+
+        clock.Mark(PipelineStage::DebugRender);
+        clock.Finish();
         return result;
     }
 
 private:
-    ColorPatternConfig config_;
+    // Center, plus the context classes the region's plan reads when scoring rings.
+    static ClassLut BuildRegionLut(const ColorPatternFinder& finder) {
+        const ColorPatternConfig& cfg = finder.config_;
+        const PipelinePlan& plan = finder.plan_;
+        ClassLut lut;
+        lut.Add(ClassLut::kCenter, cfg.centerColor.hues,
+            cfg.centerColor.satRange.minValue, cfg.centerColor.satRange.maxValue,
+            cfg.centerColor.valRange.minValue, cfg.centerColor.valRange.maxValue);
+        if (plan.classifySupport) {
+            const ColorMaskConfig& support = cfg.context.supportColor;
+            lut.Add(ClassLut::kSupport, support.hues,
+                support.satRange.minValue, support.satRange.maxValue,
+                support.valRange.minValue, support.valRange.maxValue);
+        }
+        if (plan.classifyExclude) {
+            lut.Add(ClassLut::kExclude, cfg.context.excludeHues,
+                cfg.context.excludeSatRange.minValue, cfg.context.excludeSatRange.maxValue,
+                cfg.context.excludeValRange.minValue, cfg.context.excludeValRange.maxValue);
+        }
+        return lut;
+    }
+
+    static void MarkContextReady(DetectionWorkspace& ws, const cv::Size& size) {
+        ws.contextClassifyTicks = 0;
+        ws.contextClassifiedPx = 0;
+        const int tile = DetectionWorkspace::kContextTileSize;
+        ws.contextTileCols = (size.width + tile - 1) / tile;
+        const size_t tileCount = static_cast<size_t>(ws.contextTileCols) * static_cast<size_t>((size.height + tile - 1) / tile);
+        if (ws.contextTiles.size() != tileCount) {
+            ws.contextTiles = std::vector<std::atomic<uint8_t>>(tileCount);
+        }
+        for (std::atomic<uint8_t>& state : ws.contextTiles) {
+            state.store(DetectionWorkspace::kTileReady, std::memory_order_relaxed);
+        }
+    }
+
+    std::vector<cv::Rect> rects_;
+    std::vector<ColorPatternFinder> finders_;
+    std::vector<ClassLut> luts_;
+};
+
+// Input layout of a detection call, for the cost model.
+enum class CostInput : int {
+    Bgr = 0,       // BGR/BGRA, converted to HSV by Find
+    Nv12 = 1,      // NV12 -> BGR by the caller, then Find
+    Rgb10A2 = 2,   // FindHdr
+    Rgba16F = 3,
+};
+constexpr int kCostInputCount = 4;
+
+// Recent per-frame load of a stream (or of all calls): candidates per megapixel and
+// the fraction of the frame classified for context rings, as moving averages.
+struct RecentLoad {
+    static constexpr double kAlpha = 0.2;
+
+    double candidatesPerMpx = -1.0;  // < 0 = no frame seen
+    double contextCoverage = -1.0;
+
+    void Update(const ColorPatternRunResult& result, const cv::Size& size) {
+        const double mpx = static_cast<double>(size.area()) / 1.0e6;
+        const double candidates = mpx > 0.0 ? static_cast<double>(result.rawCandidateCount) / mpx : 0.0;
+        const double coverage = static_cast<double>(result.contextMaskCoverage);
+        candidatesPerMpx = candidatesPerMpx < 0.0 ? candidates : candidatesPerMpx + kAlpha * (candidates - candidatesPerMpx);
+        contextCoverage = contextCoverage < 0.0 ? coverage : contextCoverage + kAlpha * (coverage - contextCoverage);
+    }
+};
+
+// Predicted cost of one detection call (see LatencyCostModel).
+struct CostEstimate {
+    PipelineTimings stages;          // Total = sum of the stages plus the per-call overhead
+    double candidates = 0.0;
+    double contextCoverage = 0.0;
+    double modelError = 0.0;         // mean |measured - predicted| / measured, recent calls
+    uint64_t samples = 0;
+    bool calibrated = false;         // every term the plan uses has been measured
+};
+
+// Online cost model for detection calls. Each stage's time is a coefficient times the
+// work the compiled plan implies for the frame:
+// - convert: pixels, per input layout (NV12 includes the caller's BGR conversion)
+// - classify-center: pixels x inRange passes, or pixels for the LUT (fused or not)
+// - morphology: pixels x iterations
+// - classify-context: pixels when dense, classified pixels (coverage x pixels) when lazy
+// - contours: pixels
+// - candidates: raw candidates, with and without a context ring
+// plus a per-call overhead. Coefficients start at rough priors and follow measured
+// stage timings as moving averages (the first samples of a term weigh more). The load
+// terms (candidates, context coverage) come from a RecentLoad. Debug rendering is not
+// modeled. Thread-safe; a call that finds the model busy skips its observation.
+class LatencyCostModel {
+public:
+    LatencyCostModel() {
+        Reset();
+    }
+
+    void Reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        terms_ = {};
+        static constexpr std::array<double, kCostInputCount> kConvertPrior{ 1.5, 3.0, 4.0, 5.0 };
+        for (int i = 0; i < kCostInputCount; ++i) {
+            terms_[static_cast<size_t>(Term::ConvertBgr) + static_cast<size_t>(i)].nsPerUnit = kConvertPrior[static_cast<size_t>(i)];
+        }
+        Prior(Term::CenterPass, 0.6);
+        Prior(Term::CenterLut, 1.2);
+        Prior(Term::CenterLutFused, 1.6);
+        Prior(Term::Morphology, 0.8);
+        Prior(Term::ContextDense, 1.2);
+        Prior(Term::ContextLazy, 2.0);
+        Prior(Term::Contours, 0.8);
+        Prior(Term::Candidate, 1500.0);
+        Prior(Term::CandidateRing, 6000.0);
+        Prior(Term::Overhead, 20000.0);
+        global_ = {};
+        samples_ = 0;
+        modelError_ = 0.0;
+    }
+
+    // Feeds one finished call. `extraConvertMs` is conversion done before Find (NV12).
+    void Observe(const PipelinePlan& plan, const cv::Size& size, CostInput input, double extraConvertMs, const ColorPatternRunResult& result) {
+        std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            return;
+        }
+        const Work work = WorkFor(plan, size, input, static_cast<double>(result.rawCandidateCount), static_cast<double>(result.contextMaskCoverage));
+        const PipelineTimings& t = result.timings;
+
+        double predictedMs = 0.0;
+        for (const auto& [term, units] : work.terms) {
+            predictedMs += Get(term).nsPerUnit * units / 1.0e6;
+        }
+        const double measuredMs = t[PipelineStage::Total] - t[PipelineStage::DebugRender] + extraConvertMs;
+        if (measuredMs > 0.0) {
+            const double error = std::abs(measuredMs - predictedMs) / measuredMs;
+            modelError_ = samples_ == 0 ? error : modelError_ + kErrorAlpha * (error - modelError_);
+        }
+        samples_ += 1;
+
+        double stagesMs = 0.0;
+        for (int s = 0; s < static_cast<int>(PipelineStage::DebugRender); ++s) {
+            stagesMs += t.ms[static_cast<size_t>(s)];
+        }
+        Learn(work.convert, t[PipelineStage::Convert] + extraConvertMs, work.pixels);
+        Learn(work.center, t[PipelineStage::ClassifyCenter], work.centerUnits);
+        Learn(Term::Morphology, t[PipelineStage::Morphology], work.morphologyUnits);
+        Learn(work.context, t[PipelineStage::ClassifyContext], work.contextUnits);
+        Learn(Term::Contours, t[PipelineStage::Contours], work.pixels);
+        Learn(work.candidate, t[PipelineStage::Candidates], work.candidates);
+        Learn(Term::Overhead, std::max(0.0, t[PipelineStage::Total] - t[PipelineStage::DebugRender] - stagesMs), 1.0);
+        global_.Update(result, size);
+    }
+
+    // Predicts a call on a `size` frame with `plan`. `load` supplies the candidate and
+    // coverage terms; null (or a load with no frames) uses the mean over all calls.
+    CostEstimate Estimate(const PipelinePlan& plan, const cv::Size& size, CostInput input, const RecentLoad* load) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const RecentLoad& recent = (load != nullptr && load->candidatesPerMpx >= 0.0) ? *load : global_;
+        const double mpx = static_cast<double>(size.area()) / 1.0e6;
+        CostEstimate estimate;
+        estimate.candidates = std::max(0.0, recent.candidatesPerMpx) * mpx;
+        estimate.contextCoverage = recent.contextCoverage >= 0.0 ? recent.contextCoverage : 0.0;
+        const Work work = WorkFor(plan, size, input, estimate.candidates, estimate.contextCoverage);
+
+        auto ms = [&](Term term, double units) { return Get(term).nsPerUnit * units / 1.0e6; };
+        PipelineTimings& st = estimate.stages;
+        st[PipelineStage::Convert] = ms(work.convert, work.pixels);
+        st[PipelineStage::ClassifyCenter] = ms(work.center, work.centerUnits);
+        st[PipelineStage::Morphology] = ms(Term::Morphology, work.morphologyUnits);
+        st[PipelineStage::ClassifyContext] = ms(work.context, work.contextUnits);
+        st[PipelineStage::Contours] = ms(Term::Contours, work.pixels);
+        st[PipelineStage::Candidates] = ms(work.candidate, work.candidates);
+        double total = ms(Term::Overhead, 1.0);
+        for (int s = 0; s < static_cast<int>(PipelineStage::Total); ++s) {
+            total += st.ms[static_cast<size_t>(s)];
+        }
+        st[PipelineStage::Total] = total;
+
+        estimate.calibrated = samples_ > 0;
+        for (const auto& [term, units] : work.terms) {
+            estimate.calibrated = estimate.calibrated && (units <= 0.0 || Get(term).samples > 0);
+        }
+        estimate.modelError = modelError_;
+        estimate.samples = samples_;
+        return estimate;
+    }
+
+private:
+    static constexpr double kAlpha = 0.05;
+    static constexpr double kErrorAlpha = 0.05;
+
+    enum class Term : int {
+        ConvertBgr = 0,  // one entry per CostInput
+        CenterPass = kCostInputCount,
+        CenterLut,
+        CenterLutFused,
+        Morphology,
+        ContextDense,
+        ContextLazy,
+        Contours,
+        Candidate,
+        CandidateRing,
+        Overhead,
+        Count
+    };
+
+    struct Coefficient {
+        double nsPerUnit = 0.0;
+        uint64_t samples = 0;
+    };
+
+    struct Work {
+        double pixels = 0.0;
+        Term convert = Term::ConvertBgr;
+        Term center = Term::CenterLut;
+        double centerUnits = 0.0;
+        double morphologyUnits = 0.0;
+        Term context = Term::ContextDense;
+        double contextUnits = 0.0;
+        Term candidate = Term::Candidate;
+        double candidates = 0.0;
+        std::array<std::pair<Term, double>, 7> terms{};
+    };
+
+    static Work WorkFor(const PipelinePlan& plan, const cv::Size& size, CostInput input, double candidates, double contextCoverage) {
+        Work w;
+        w.pixels = static_cast<double>(size.area());
+        w.convert = static_cast<Term>(static_cast<int>(Term::ConvertBgr) + static_cast<int>(input));
+        if (plan.centerClassifier == ClassifierKernel::Lut) {
+            w.center = plan.fusedDenseClassify ? Term::CenterLutFused : Term::CenterLut;
+            w.centerUnits = w.pixels;
+        } else {
+            w.center = Term::CenterPass;
+            w.centerUnits = w.pixels * static_cast<double>(plan.centerArithmeticPasses);
+        }
+        w.morphologyUnits = w.pixels * static_cast<double>(plan.morphologyIterations);
+        if (plan.contextMasks == ContextMaskKernel::Dense) {
+            w.context = Term::ContextDense;
+            w.contextUnits = plan.fusedDenseClassify ? 0.0 : w.pixels;
+        } else if (plan.contextMasks != ContextMaskKernel::Disabled) {
+            w.context = Term::ContextLazy;
+            w.contextUnits = w.pixels * std::clamp(contextCoverage, 0.0, 1.0);
+        }
+        w.candidate = plan.ring != RingKernel::Disabled ? Term::CandidateRing : Term::Candidate;
+        w.candidates = candidates;
+        w.terms = { {
+            { w.convert, w.pixels },
+            { w.center, w.centerUnits },
+            { Term::Morphology, w.morphologyUnits },
+            { w.context, w.contextUnits },
+            { Term::Contours, w.pixels },
+            { w.candidate, w.candidates },
+            { Term::Overhead, 1.0 },
+        } };
+        return w;
+    }
+
+    void Prior(Term term, double nsPerUnit) {
+        terms_[static_cast<size_t>(term)].nsPerUnit = nsPerUnit;
+    }
+
+    const Coefficient& Get(Term term) const {
+        return terms_[static_cast<size_t>(term)];
+    }
+
+    void Learn(Term term, double ms, double units) {
+        if (units <= 0.0) {
+            return;
+        }
+        Coefficient& c = terms_[static_cast<size_t>(term)];
+        const double observed = ms * 1.0e6 / units;
+        c.samples += 1;
+        const double alpha = std::max(kAlpha, 1.0 / static_cast<double>(c.samples));
+        c.nsPerUnit += alpha * (observed - c.nsPerUnit);
+    }
+
+    mutable std::mutex mutex_;
+    std::array<Coefficient, static_cast<size_t>(Term::Count)> terms_{};
+    RecentLoad global_;
+    uint64_t samples_ = 0;
+    double modelError_ = 0.0;
 };
 
 }
@@ -0,0 +1,24 @@
+#include "gstchromadetect.h"
+#include "gstchromameta.h"
+
+#include <gst/gst.h>
+
+namespace {
+
+gboolean PluginInit(GstPlugin* plugin) {
+    gst_chroma_detection_meta_get_info();
+    return gst_element_register(plugin, "chromadetect", GST_RANK_NONE, GST_TYPE_CHROMA_DETECT);
+}
+
+} // namespace
+
+GST_PLUGIN_DEFINE(
+    GST_VERSION_MAJOR,
+    GST_VERSION_MINOR,
+    chroma,
+    "HSV color-pattern detection (Chroma Core)",
+    PluginInit,
+    VERSION,
+    "MIT/X11",
+    PACKAGE,
+    GST_PACKAGE_ORIGIN)
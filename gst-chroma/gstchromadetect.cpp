@@ -0,0 +1,499 @@
+#include "gstchromadetect.h"
+#include "gstchromameta.h"
+
+#include "ChromaApi.h"
+
+#include <gst/video/video.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+GST_DEBUG_CATEGORY_STATIC(gst_chroma_detect_debug);
+#define GST_CAT_DEFAULT gst_chroma_detect_debug
+
+namespace {
+
+constexpr guint kDefaultWorkers = 1;
+constexpr guint kMaxWorkers = 64;
+constexpr guint kDefaultMaxDetections = 256;
+constexpr guint kMaxDetectionsLimit = 65536;
+constexpr int32_t kErrorChars = 256;
+
+enum {
+    PROP_0,
+    PROP_WORKERS,
+    PROP_MAX_DETECTIONS,
+    PROP_ADAPTIVE_CASCADE,
+    PROP_FRAMES_ANALYZED,
+    PROP_FRAMES_DROPPED
+};
+
+// Chroma error text is ASCII; GStreamer's logger has no reliable %ls.
+std::string NarrowError(const wchar_t* text) {
+    std::string out;
+    for (; text != nullptr && *text != L'\0'; ++text) {
+        out.push_back(*text < 0x80 ? static_cast<char>(*text) : '?');
+    }
+    return out;
+}
+
+struct DetectionResult {
+    bool valid = false;
+    guint64 frameNumber = 0;
+    GstClockTime framePts = GST_CLOCK_TIME_NONE;
+    GstClockTime latency = GST_CLOCK_TIME_NONE;
+    int32_t status = CHROMA_STATUS_OK;
+    int32_t totalFound = 0;
+    std::vector<ChromaPoint> points;
+};
+
+struct FrameJob {
+    GstBuffer* buffer = nullptr;   // reference held until the worker is done with it
+    GstVideoInfo info;
+    guint64 frameNumber = 0;
+};
+
+// Maps `buffer` read-only, runs one detection on `stream` and unmaps. The pixels are
+// read in place; nothing is copied on the element side.
+void DetectFrame(
+    ChromaStream* stream,
+    GstBuffer* buffer,
+    GstVideoInfo& info,
+    guint64 frameNumber,
+    guint maxDetections,
+    DetectionResult& out) {
+    out.valid = true;
+    out.frameNumber = frameNumber;
+    out.framePts = GST_BUFFER_PTS(buffer);
+    out.latency = GST_CLOCK_TIME_NONE;
+    out.totalFound = 0;
+    out.points.resize(maxDetections);
+
+    GstVideoFrame frame;
+    if (!gst_video_frame_map(&frame, &info, buffer, GST_MAP_READ)) {
+        out.status = CHROMA_STATUS_INVALID_ARGUMENT;
+        out.points.clear();
+        GST_WARNING("failed to map frame %" G_GUINT64_FORMAT, frameNumber);
+        return;
+    }
+
+    ChromaFrameV1 desc{};
+    desc.structSize = static_cast<int32_t>(sizeof(ChromaFrameV1));
+    desc.width = GST_VIDEO_FRAME_WIDTH(&frame);
+    desc.height = GST_VIDEO_FRAME_HEIGHT(&frame);
+    desc.planes[0] = GST_VIDEO_FRAME_PLANE_DATA(&frame, 0);
+    desc.strideBytes[0] = GST_VIDEO_FRAME_PLANE_STRIDE(&frame, 0);
+    if (GST_VIDEO_FRAME_FORMAT(&frame) == GST_VIDEO_FORMAT_NV12) {
+        desc.pixelFormat = CHROMA_PIXEL_FORMAT_NV12;
+        desc.planes[1] = GST_VIDEO_FRAME_PLANE_DATA(&frame, 1);
+        desc.strideBytes[1] = GST_VIDEO_FRAME_PLANE_STRIDE(&frame, 1);
+    }
+    else {
+        desc.pixelFormat = CHROMA_PIXEL_FORMAT_BGRA8;
+    }
+
+    wchar_t error[kErrorChars] = {};
+    int32_t written = 0;
+    const auto begin = std::chrono::steady_clock::now();
+    out.status = Chroma_LocateStreamFrame(
+        stream,
+        &desc,
+        out.points.data(),
+        static_cast<int32_t>(out.points.size()),
+        &out.totalFound,
+        &written,
+        error,
+        kErrorChars);
+    out.latency = static_cast<GstClockTime>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - begin).count());
+    gst_video_frame_unmap(&frame);
+
+    out.points.resize(static_cast<size_t>(written));
+    if (out.status != CHROMA_STATUS_OK && out.status != CHROMA_STATUS_BUFFER_TOO_SMALL) {
+        GST_WARNING("detection failed on frame %" G_GUINT64_FORMAT " (status %d): %s",
+            frameNumber, out.status, NarrowError(error).c_str());
+    }
+}
+
+// Detection threads, one ChromaStream each. Frames are handed over through a single
+// pending slot: a frame that is still waiting when the next one arrives is dropped
+// (latest frame wins), so a slow detector never backs up the pipeline. With zero
+// workers the pool only owns the stream used by DetectInline.
+class DetectorPool {
+public:
+    DetectorPool(guint workers, guint maxDetections, bool adaptiveCascade) : maxDetections_(maxDetections) {
+        const guint streamCount = workers == 0 ? 1 : workers;
+        for (guint i = 0; i < streamCount; ++i) {
+            ChromaStream* stream = nullptr;
+            wchar_t error[kErrorChars] = {};
+            if (Chroma_CreateStream(&stream, adaptiveCascade ? 1 : 0, error, kErrorChars) != CHROMA_STATUS_OK) {
+                GST_ERROR("Chroma_CreateStream failed: %s", NarrowError(error).c_str());
+                continue;
+            }
+            streams_.push_back(stream);
+        }
+        if (workers == 0) {
+            return;
+        }
+        for (size_t i = 0; i < streams_.size(); ++i) {
+            threads_.emplace_back([this, i]() { WorkerLoop(streams_[i]); });
+        }
+    }
+
+    ~DetectorPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& t : threads_) {
+            t.join();
+        }
+        if (pending_.buffer != nullptr) {
+            gst_buffer_unref(pending_.buffer);
+        }
+        for (ChromaStream* stream : streams_) {
+            Chroma_DestroyStream(stream);
+        }
+    }
+
+    DetectorPool(const DetectorPool&) = delete;
+    DetectorPool& operator=(const DetectorPool&) = delete;
+
+    bool Ready() const {
+        return !streams_.empty();
+    }
+
+    // Runs detection on the calling thread (workers = 0).
+    void DetectInline(GstBuffer* buffer, GstVideoInfo& info, guint64 frameNumber, DetectionResult& out) {
+        DetectFrame(streams_.front(), buffer, info, frameNumber, maxDetections_, out);
+        analyzed_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Queues `buffer` for the next idle worker, replacing a frame that is still waiting.
+    void Submit(GstBuffer* buffer, const GstVideoInfo& info, guint64 frameNumber) {
+        GstBuffer* replaced = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            replaced = pending_.buffer;
+            pending_.buffer = gst_buffer_ref(buffer);
+            pending_.info = info;
+            pending_.frameNumber = frameNumber;
+        }
+        wake_.notify_one();
+        if (replaced != nullptr) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            gst_buffer_unref(replaced);
+        }
+    }
+
+    // Copies the newest finished result into `out`; false until the first one.
+    bool Latest(DetectionResult& out) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!latest_.valid) {
+            return false;
+        }
+        out = latest_;
+        return true;
+    }
+
+    guint64 Analyzed() const {
+        return analyzed_.load(std::memory_order_relaxed);
+    }
+
+    guint64 Dropped() const {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+private:
+    void WorkerLoop(ChromaStream* stream) {
+        DetectionResult result;
+        for (;;) {
+            FrameJob job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [this]() { return stopping_ || pending_.buffer != nullptr; });
+                if (stopping_) {
+                    return;
+                }
+                job = pending_;
+                pending_.buffer = nullptr;
+            }
+
+            DetectFrame(stream, job.buffer, job.info, job.frameNumber, maxDetections_, result);
+            gst_buffer_unref(job.buffer);
+            analyzed_.fetch_add(1, std::memory_order_relaxed);
+
+            // Workers can finish out of order; only a newer frame replaces the result.
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!latest_.valid || result.frameNumber > latest_.frameNumber) {
+                std::swap(latest_, result);
+            }
+        }
+    }
+
+    const guint maxDetections_;
+    std::vector<ChromaStream*> streams_;
+    std::vector<std::thread> threads_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    FrameJob pending_;
+    DetectionResult latest_;
+    bool stopping_ = false;
+    std::atomic<guint64> analyzed_{ 0 };
+    std::atomic<guint64> dropped_{ 0 };
+};
+
+} // namespace
+
+struct _GstChromaDetect {
+    GstVideoFilter parent;
+
+    // Properties, guarded by the object lock. Pool settings apply at the next start.
+    guint workers;
+    guint maxDetections;
+    gboolean adaptiveCascade;
+
+    // Streaming state, created in start() and destroyed in stop().
+    DetectorPool* pool;
+    gboolean inlineDetect;
+    DetectionResult* result;
+    guint64 frameNumber;
+
+    // Counters of the last run, kept after stop() for the read-only properties.
+    guint64 framesAnalyzed;
+    guint64 framesDropped;
+};
+
+G_DEFINE_TYPE(GstChromaDetect, gst_chroma_detect, GST_TYPE_VIDEO_FILTER)
+
+namespace {
+
+GstStaticPadTemplate gSinkTemplate = GST_STATIC_PAD_TEMPLATE(
+    "sink", GST_PAD_SINK, GST_PAD_ALWAYS, GST_STATIC_CAPS(GST_VIDEO_CAPS_MAKE("{ BGRx, BGRA, NV12 }")));
+GstStaticPadTemplate gSrcTemplate = GST_STATIC_PAD_TEMPLATE(
+    "src", GST_PAD_SRC, GST_PAD_ALWAYS, GST_STATIC_CAPS(GST_VIDEO_CAPS_MAKE("{ BGRx, BGRA, NV12 }")));
+
+void SetProperty(GObject* object, guint propId, const GValue* value, GParamSpec* pspec) {
+    GstChromaDetect* self = GST_CHROMA_DETECT(object);
+    GST_OBJECT_LOCK(self);
+    switch (propId) {
+    case PROP_WORKERS:
+        self->workers = g_value_get_uint(value);
+        break;
+    case PROP_MAX_DETECTIONS:
+        self->maxDetections = g_value_get_uint(value);
+        break;
+    case PROP_ADAPTIVE_CASCADE:
+        self->adaptiveCascade = g_value_get_boolean(value);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, propId, pspec);
+        break;
+    }
+    GST_OBJECT_UNLOCK(self);
+}
+
+void GetProperty(GObject* object, guint propId, GValue* value, GParamSpec* pspec) {
+    GstChromaDetect* self = GST_CHROMA_DETECT(object);
+    GST_OBJECT_LOCK(self);
+    switch (propId) {
+    case PROP_WORKERS:
+        g_value_set_uint(value, self->workers);
+        break;
+    case PROP_MAX_DETECTIONS:
+        g_value_set_uint(value, self->maxDetections);
+        break;
+    case PROP_ADAPTIVE_CASCADE:
+        g_value_set_boolean(value, self->adaptiveCascade);
+        break;
+    case PROP_FRAMES_ANALYZED:
+        g_value_set_uint64(value, self->pool != nullptr ? self->pool->Analyzed() : self->framesAnalyzed);
+        break;
+    case PROP_FRAMES_DROPPED:
+        g_value_set_uint64(value, self->pool != nullptr ? self->pool->Dropped() : self->framesDropped);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, propId, pspec);
+        break;
+    }
+    GST_OBJECT_UNLOCK(self);
+}
+
+gboolean Start(GstBaseTransform* trans) {
+    GstChromaDetect* self = GST_CHROMA_DETECT(trans);
+    GST_OBJECT_LOCK(self);
+    const guint workers = self->workers;
+    const guint maxDetections = self->maxDetections;
+    const bool adaptive = self->adaptiveCascade != FALSE;
+    GST_OBJECT_UNLOCK(self);
+
+    auto* pool = new DetectorPool(workers, maxDetections, adaptive);
+    if (!pool->Ready()) {
+        delete pool;
+        GST_ELEMENT_ERROR(self, LIBRARY, INIT, ("Could not create a Chroma detection stream."), (nullptr));
+        return FALSE;
+    }
+
+    GST_OBJECT_LOCK(self);
+    self->pool = pool;
+    self->inlineDetect = workers == 0;
+    self->result = new DetectionResult();
+    self->frameNumber = 0;
+    self->framesAnalyzed = 0;
+    self->framesDropped = 0;
+    GST_OBJECT_UNLOCK(self);
+    GST_DEBUG_OBJECT(self, "started with %u worker(s)", workers);
+    return TRUE;
+}
+
+gboolean Stop(GstBaseTransform* trans) {
+    GstChromaDetect* self = GST_CHROMA_DETECT(trans);
+    GST_OBJECT_LOCK(self);
+    DetectorPool* pool = self->pool;
+    DetectionResult* result = self->result;
+    self->pool = nullptr;
+    self->result = nullptr;
+    if (pool != nullptr) {
+        self->framesAnalyzed = pool->Analyzed();
+        self->framesDropped = pool->Dropped();
+    }
+    GST_OBJECT_UNLOCK(self);
+
+    // Joins the workers, so it runs outside the object lock.
+    delete pool;
+    delete result;
+    return TRUE;
+}
+
+gboolean SetInfo(
+    GstVideoFilter* filter,
+    GstCaps* /*incaps*/,
+    GstVideoInfo* inInfo,
+    GstCaps* /*outcaps*/,
+    GstVideoInfo* /*outInfo*/) {
+    if (GST_VIDEO_INFO_FORMAT(inInfo) == GST_VIDEO_FORMAT_NV12 &&
+        ((GST_VIDEO_INFO_WIDTH(inInfo) % 2) != 0 || (GST_VIDEO_INFO_HEIGHT(inInfo) % 2) != 0)) {
+        GST_ELEMENT_ERROR(filter, STREAM, FORMAT, ("NV12 input needs an even width and height."), (nullptr));
+        return FALSE;
+    }
+    return TRUE;
+}
+
+// In place and read-only: the buffer is only made writable for the meta (base
+// transform shares the memory on copy), the pixels are mapped with GST_MAP_READ.
+GstFlowReturn TransformIp(GstBaseTransform* trans, GstBuffer* buffer) {
+    GstChromaDetect* self = GST_CHROMA_DETECT(trans);
+    GstVideoFilter* filter = GST_VIDEO_FILTER(trans);
+    DetectorPool* pool = self->pool;
+    DetectionResult& result = *self->result;
+    const guint64 frameNumber = self->frameNumber++;
+
+    const bool inlineDetect = self->inlineDetect != FALSE;
+    if (inlineDetect) {
+        pool->DetectInline(buffer, filter->in_info, frameNumber, result);
+    }
+    else if (!pool->Latest(result)) {
+        result.valid = false;
+    }
+
+    if (result.valid) {
+        gst_buffer_add_chroma_detection_meta(
+            buffer,
+            result.frameNumber,
+            result.framePts,
+            result.latency,
+            result.status,
+            static_cast<guint>(result.totalFound),
+            result.points.data(),
+            static_cast<guint>(result.points.size()));
+        GST_LOG_OBJECT(self, "frame %" G_GUINT64_FORMAT ": %d detection(s) from frame %" G_GUINT64_FORMAT,
+            frameNumber, result.totalFound, result.frameNumber);
+    }
+
+    // Submitted after the meta is attached: the worker's reference makes the buffer
+    // non-writable until detection finishes.
+    if (!inlineDetect) {
+        pool->Submit(buffer, filter->in_info, frameNumber);
+    }
+    return GST_FLOW_OK;
+}
+
+} // namespace
+
+static void gst_chroma_detect_class_init(GstChromaDetectClass* klass) {
+    GObjectClass* objectClass = G_OBJECT_CLASS(klass);
+    GstElementClass* elementClass = GST_ELEMENT_CLASS(klass);
+    GstBaseTransformClass* transClass = GST_BASE_TRANSFORM_CLASS(klass);
+    GstVideoFilterClass* filterClass = GST_VIDEO_FILTER_CLASS(klass);
+
+    GST_DEBUG_CATEGORY_INIT(gst_chroma_detect_debug, "chromadetect", 0, "Chroma color-pattern detection");
+
+    objectClass->set_property = SetProperty;
+    objectClass->get_property = GetProperty;
+
+    g_object_class_install_property(objectClass, PROP_WORKERS,
+        g_param_spec_uint("workers", "Workers",
+            "Detection threads (applies at the next start). 0 detects on the streaming thread and "
+            "attaches each frame's own result; otherwise frames that arrive while all workers are busy "
+            "replace the waiting frame and buffers carry the newest finished result",
+            0, kMaxWorkers, kDefaultWorkers,
+            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(objectClass, PROP_MAX_DETECTIONS,
+        g_param_spec_uint("max-detections", "Max detections",
+            "Centers stored per result (applies at the next start)",
+            1, kMaxDetectionsLimit, kDefaultMaxDetections,
+            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(objectClass, PROP_ADAPTIVE_CASCADE,
+        g_param_spec_boolean("adaptive-cascade", "Adaptive cascade",
+            "Reorder candidate tests by observed rejection rate per cost (applies at the next start)",
+            FALSE,
+            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(objectClass, PROP_FRAMES_ANALYZED,
+        g_param_spec_uint64("frames-analyzed", "Frames analyzed",
+            "Frames that ran detection since start",
+            0, G_MAXUINT64, 0,
+            static_cast<GParamFlags>(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(objectClass, PROP_FRAMES_DROPPED,
+        g_param_spec_uint64("frames-dropped", "Frames dropped",
+            "Frames replaced by a newer frame before a worker picked them up (still passed downstream)",
+            0, G_MAXUINT64, 0,
+            static_cast<GParamFlags>(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+
+    gst_element_class_set_static_metadata(elementClass,
+        "Chroma color-pattern detector",
+        "Filter/Analyzer/Video",
+        "Detects HSV color patterns with the active Chroma config and attaches GstChromaDetectionMeta",
+        "Chroma Core");
+    gst_element_class_add_static_pad_template(elementClass, &gSinkTemplate);
+    gst_element_class_add_static_pad_template(elementClass, &gSrcTemplate);
+
+    transClass->start = Start;
+    transClass->stop = Stop;
+    // Only the in-place path is provided, which keeps the element zero-copy.
+    transClass->transform = nullptr;
+    transClass->transform_ip = TransformIp;
+    transClass->transform_ip_on_passthrough = FALSE;
+    filterClass->set_info = SetInfo;
+    filterClass->transform_frame = nullptr;
+    filterClass->transform_frame_ip = nullptr;
+}
+
+static void gst_chroma_detect_init(GstChromaDetect* self) {
+    self->workers = kDefaultWorkers;
+    self->maxDetections = kDefaultMaxDetections;
+    self->adaptiveCascade = FALSE;
+    self->pool = nullptr;
+    self->inlineDetect = FALSE;
+    self->result = nullptr;
+    self->frameNumber = 0;
+    self->framesAnalyzed = 0;
+    self->framesDropped = 0;
+    gst_base_transform_set_in_place(GST_BASE_TRANSFORM(self), TRUE);
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <gst/video/gstvideofilter.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_CHROMA_DETECT (gst_chroma_detect_get_type())
+G_DECLARE_FINAL_TYPE(GstChromaDetect, gst_chroma_detect, GST, CHROMA_DETECT, GstVideoFilter)
+
+G_END_DECLS
@@ -0,0 +1,124 @@
+#include "gstchromameta.h"
+
+#include <gst/video/video.h>
+
+#include <cstring>
+
+namespace {
+
+gboolean ChromaDetectionMetaInit(GstMeta* meta, gpointer /*params*/, GstBuffer* /*buffer*/) {
+    auto* m = reinterpret_cast<GstChromaDetectionMeta*>(meta);
+    m->frame_number = 0;
+    m->frame_pts = GST_CLOCK_TIME_NONE;
+    m->latency = GST_CLOCK_TIME_NONE;
+    m->status = CHROMA_STATUS_OK;
+    m->total_found = 0;
+    m->n_points = 0;
+    m->points = nullptr;
+    return TRUE;
+}
+
+void ChromaDetectionMetaFree(GstMeta* meta, GstBuffer* /*buffer*/) {
+    auto* m = reinterpret_cast<GstChromaDetectionMeta*>(meta);
+    g_free(m->points);
+    m->points = nullptr;
+    m->n_points = 0;
+}
+
+// Copies survive buffer copies; scaling maps the centers into the new frame size.
+// Other video transforms (crop, flip, ...) drop the meta through its tags.
+gboolean ChromaDetectionMetaTransform(
+    GstBuffer* dest,
+    GstMeta* meta,
+    GstBuffer* /*buffer*/,
+    GQuark type,
+    gpointer data) {
+    const auto* src = reinterpret_cast<const GstChromaDetectionMeta*>(meta);
+    double sx = 1.0;
+    double sy = 1.0;
+    if (GST_META_TRANSFORM_IS_COPY(type)) {
+        // unchanged coordinates
+    }
+    else if (GST_VIDEO_META_TRANSFORM_IS_SCALE(type)) {
+        const auto* scale = static_cast<const GstVideoMetaTransform*>(data);
+        const int inW = GST_VIDEO_INFO_WIDTH(scale->in_info);
+        const int inH = GST_VIDEO_INFO_HEIGHT(scale->in_info);
+        if (inW <= 0 || inH <= 0) {
+            return FALSE;
+        }
+        sx = static_cast<double>(GST_VIDEO_INFO_WIDTH(scale->out_info)) / inW;
+        sy = static_cast<double>(GST_VIDEO_INFO_HEIGHT(scale->out_info)) / inH;
+    }
+    else {
+        return FALSE;
+    }
+
+    GstChromaDetectionMeta* dst = gst_buffer_add_chroma_detection_meta(
+        dest, src->frame_number, src->frame_pts, src->latency, src->status, src->total_found, src->points, src->n_points);
+    if (dst == nullptr) {
+        return FALSE;
+    }
+    for (guint i = 0; i < dst->n_points; ++i) {
+        dst->points[i].x = static_cast<int32_t>(dst->points[i].x * sx + 0.5);
+        dst->points[i].y = static_cast<int32_t>(dst->points[i].y * sy + 0.5);
+    }
+    return TRUE;
+}
+
+} // namespace
+
+GType gst_chroma_detection_meta_api_get_type(void) {
+    static gsize type = 0;
+    static const gchar* tags[] = {
+        GST_META_TAG_VIDEO_STR, GST_META_TAG_VIDEO_SIZE_STR, GST_META_TAG_VIDEO_ORIENTATION_STR, nullptr };
+    if (g_once_init_enter(&type)) {
+        const GType api = gst_meta_api_type_register("GstChromaDetectionMetaAPI", tags);
+        g_once_init_leave(&type, api);
+    }
+    return static_cast<GType>(type);
+}
+
+const GstMetaInfo* gst_chroma_detection_meta_get_info(void) {
+    static GstMetaInfo* info = nullptr;
+    if (g_once_init_enter(&info)) {
+        const GstMetaInfo* registered = gst_meta_register(
+            GST_CHROMA_DETECTION_META_API_TYPE,
+            "GstChromaDetectionMeta",
+            sizeof(GstChromaDetectionMeta),
+            ChromaDetectionMetaInit,
+            ChromaDetectionMetaFree,
+            ChromaDetectionMetaTransform);
+        g_once_init_leave(&info, const_cast<GstMetaInfo*>(registered));
+    }
+    return info;
+}
+
+GstChromaDetectionMeta* gst_buffer_add_chroma_detection_meta(
+    GstBuffer* buffer,
+    guint64 frame_number,
+    GstClockTime frame_pts,
+    GstClockTime latency,
+    gint32 status,
+    guint total_found,
+    const ChromaPoint* points,
+    guint n_points) {
+    g_return_val_if_fail(GST_IS_BUFFER(buffer), nullptr);
+    g_return_val_if_fail(n_points == 0 || points != nullptr, nullptr);
+
+    auto* meta = reinterpret_cast<GstChromaDetectionMeta*>(
+        gst_buffer_add_meta(buffer, GST_CHROMA_DETECTION_META_INFO, nullptr));
+    if (meta == nullptr) {
+        return nullptr;
+    }
+    meta->frame_number = frame_number;
+    meta->frame_pts = frame_pts;
+    meta->latency = latency;
+    meta->status = status;
+    meta->total_found = total_found;
+    if (n_points > 0) {
+        meta->points = g_new(ChromaPoint, n_points);
+        std::memcpy(meta->points, points, sizeof(ChromaPoint) * n_points);
+        meta->n_points = n_points;
+    }
+    return meta;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <gst/gst.h>
+
+#include "ChromaApi.h"
+
+G_BEGIN_DECLS
+
+// Detection result attached to buffers by chromadetect. With a worker pool the result
+// belongs to an earlier frame (frame_number / frame_pts identify it); with workers=0
+// it belongs to the buffer it is attached to.
+typedef struct _GstChromaDetectionMeta {
+    GstMeta meta;
+
+    guint64 frame_number;     // sequence number of the analyzed frame since element start
+    GstClockTime frame_pts;   // PTS of the analyzed frame
+    GstClockTime latency;     // wall time of the detection call
+    gint32 status;            // ChromaStatusCode of the detection call
+    guint total_found;        // accepted detections (may exceed n_points)
+    guint n_points;
+    ChromaPoint* points;      // accepted centers in pixels of the analyzed frame
+} GstChromaDetectionMeta;
+
+#define GST_CHROMA_DETECTION_META_API_TYPE (gst_chroma_detection_meta_api_get_type())
+#define GST_CHROMA_DETECTION_META_INFO (gst_chroma_detection_meta_get_info())
+#define gst_buffer_get_chroma_detection_meta(b) \
+    ((GstChromaDetectionMeta*)gst_buffer_get_meta((b), GST_CHROMA_DETECTION_META_API_TYPE))
+
+GType gst_chroma_detection_meta_api_get_type(void);
+const GstMetaInfo* gst_chroma_detection_meta_get_info(void);
+
+GstChromaDetectionMeta* gst_buffer_add_chroma_detection_meta(
+    GstBuffer* buffer,
+    guint64 frame_number,
+    GstClockTime frame_pts,
+    GstClockTime latency,
+    gint32 status,
+    guint total_found,
+    const ChromaPoint* points,
+    guint n_points);
+
+// For applications that load the plugin instead of linking it: looks the API type up by
+// name, so only this header is needed to read the meta.
+static inline GstChromaDetectionMeta* gst_buffer_find_chroma_detection_meta(GstBuffer* buffer) {
+    const GType api = g_type_from_name("GstChromaDetectionMetaAPI");
+    return api == 0 ? NULL : (GstChromaDetectionMeta*)gst_buffer_get_meta(buffer, api);
+}
+
+G_END_DECLS
@@ -0,0 +1,115 @@
+#!/usr/bin/env bash
+# Profile-guided Linux build of libChroma.so.
+#
+#   1. plain:        -O3 build (the reference)
+#   2. instrumented: -O3 with profile instrumentation
+#   3. training:     ChromaBench corpus run (default, clutter and context profiles)
+#                    over synthetic frames plus an optional recorded PPM corpus
+#   4. pgo:          -O3 + LTO rebuilt with the collected profile
+#   5. report:       plain vs pgo timings and detection checksums
+#
+# Usage: scripts/build-pgo-linux.sh [recorded-corpus-dir]
+# Env:   CXX (g++ or clang++), OUT (default artifacts/linux-pgo), FRAMES (default 120),
+#        REPEAT (training passes, default 2), JOBS
+set -euo pipefail
+
+ROOT="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+OUT="${OUT:-$ROOT/artifacts/linux-pgo}"
+CXX="${CXX:-g++}"
+FRAMES="${FRAMES:-120}"
+REPEAT="${REPEAT:-2}"
+CORPUS="${1:-}"
+
+OPENCV_CFLAGS="$(pkg-config --cflags opencv4)"
+OPENCV_LIBS="$(pkg-config --libs opencv4)"
+COMMON_FLAGS=(-std=c++20 -O3 -DNDEBUG -fPIC -fvisibility=hidden)
+PROFILE_DIR="$OUT/profile"
+
+case "$("$CXX" --version | head -n1)" in
+    *clang*) TOOLCHAIN=clang ;;
+    *) TOOLCHAIN=gcc ;;
+esac
+
+corpus_args=()
+if [[ -n "$CORPUS" ]]; then
+    corpus_args=(--corpus "$CORPUS")
+fi
+
+# build <variant> <extra flags...>: libChroma.so and ChromaBench into $OUT/<variant>.
+# Objects of the instrumented and pgo variants share a directory so the profile
+# data (keyed by object path) is found by the profile-use build.
+build() {
+    local variant="$1"
+    shift
+    local bin="$OUT/$variant"
+    local obj="$OUT/obj-$variant"
+    case "$variant" in
+        instrumented | pgo) obj="$OUT/obj-profiled" ;;
+    esac
+    mkdir -p "$bin" "$obj"
+
+    echo "== building $variant"
+    # shellcheck disable=SC2086
+    "$CXX" "${COMMON_FLAGS[@]}" "$@" $OPENCV_CFLAGS -c "$ROOT/chroma-core/ChromaCore.cpp" -o "$obj/ChromaCore.o"
+    # shellcheck disable=SC2086
+    "$CXX" "${COMMON_FLAGS[@]}" "$@" -shared -o "$bin/libChroma.so" "$obj/ChromaCore.o" $OPENCV_LIBS -pthread
+
+    # The harness only talks to the C ABI, so it is built without profile flags.
+    "$CXX" -std=c++20 -O2 -I"$ROOT/chroma-core" \
+        "$ROOT/chroma-bench/ChromaBench.cpp" "$ROOT/chroma-bench/ContentionBench.cpp" \
+        "$ROOT/chroma-bench/CorpusBench.cpp" "$ROOT/chroma-bench/SoakBench.cpp" \
+        "$ROOT/chroma-bench/BatchBench.cpp" \
+        -o "$bin/ChromaBench" -L"$bin" -lChroma -Wl,-rpath,'$ORIGIN' -pthread
+}
+
+run_corpus() {
+    local variant="$1"
+    shift
+    "$OUT/$variant/ChromaBench" corpus --frames "$FRAMES" "${corpus_args[@]}" "$@"
+}
+
+rm -rf "$PROFILE_DIR" "$OUT/obj-profiled"
+mkdir -p "$PROFILE_DIR"
+
+build plain
+
+if [[ "$TOOLCHAIN" == clang ]]; then
+    build instrumented -fprofile-instr-generate="$PROFILE_DIR/chroma-%p.profraw"
+else
+    build instrumented -fprofile-generate="$PROFILE_DIR" -fprofile-update=atomic
+fi
+
+echo "== training"
+run_corpus instrumented --repeat "$REPEAT" > "$OUT/training.txt"
+
+if [[ "$TOOLCHAIN" == clang ]]; then
+    llvm-profdata merge -output="$PROFILE_DIR/chroma.profdata" "$PROFILE_DIR"/*.profraw
+    build pgo -flto=thin -fprofile-instr-use="$PROFILE_DIR/chroma.profdata"
+else
+    build pgo -flto=auto -fprofile-use="$PROFILE_DIR" -fprofile-partial-training -Wno-missing-profile
+fi
+
+echo "== measuring"
+run_corpus plain --repeat 3 --csv "$OUT/plain.csv" > /dev/null
+run_corpus pgo --repeat 3 --csv "$OUT/pgo.csv" > /dev/null
+
+REPORT="$OUT/report.txt"
+{
+    echo "PGO comparison ($TOOLCHAIN, $FRAMES synthetic frames per profile${CORPUS:+, corpus $CORPUS})"
+    echo
+    awk -F, '
+        FNR == 1 { next }
+        NR == FNR { mean[$1] = $3; p99[$1] = $5; sum[$1] = $7; next }
+        {
+            status = (sum[$1] == $7) ? "identical" : "DIFFERENT"
+            printf "%-10s mean %8.3f -> %8.3f ms (%+6.1f%%)   p99 %8.3f -> %8.3f ms (%+6.1f%%)   detections %s\n",
+                $1, mean[$1], $3, 100 * ($3 - mean[$1]) / mean[$1], p99[$1], $5, 100 * ($5 - p99[$1]) / p99[$1], status
+            if (status != "identical") { bad = 1 }
+        }
+        END { exit bad }
+    ' "$OUT/plain.csv" "$OUT/pgo.csv"
+} | tee "$REPORT"
+
+echo
+echo "pgo build: $OUT/pgo/libChroma.so"
+echo "report:    $REPORT"